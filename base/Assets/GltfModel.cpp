@@ -117,8 +117,14 @@ namespace Assets {
 
 	void GltfModel::loadTextures(tinygltf::Model& gltfModel)
 	{
+		// Count how many textures share each image, the last one can take the decoded pixels without a copy.
+		std::vector<uint32_t> imageUses(gltfModel.images.size(), 0);
+		for (const tinygltf::Texture& tex : gltfModel.textures) {
+			imageUses[tex.source]++;
+		}
+
 		for (tinygltf::Texture& tex : gltfModel.textures) {
-			tinygltf::Image image = gltfModel.images[tex.source];
+			tinygltf::Image& image = gltfModel.images[tex.source];
 			vk::SamplerConfig textureSampler;
 			if (tex.sampler == -1) {
 				textureSampler.MagFilter = VK_FILTER_LINEAR;
@@ -130,7 +136,16 @@ namespace Assets {
 			else {
 				textureSampler = textureSamplers_[tex.sampler];
 			}
-			textures_.push_back(Assets::GltfTexture::LoadTexture(image));
+			textures_.push_back(--imageUses[tex.source] == 0
+				? Assets::GltfTexture::LoadTexture(std::move(image))
+				: Assets::GltfTexture::LoadTexture(image));
+		}
+	}
+
+	void GltfModel::ReleaseTexturePixels()
+	{
+		for (auto& texture : textures_) {
+			texture.ReleasePixels();
 		}
 	}
 
@@ -228,7 +243,7 @@ namespace Assets {
 		// Node contains mesh data
 		if (node.mesh > -1) {
 			const tinygltf::Mesh mesh = model.meshes[node.mesh];
-			Mesh* newMesh = new Mesh(Device(), newNode->matrix);
+			Mesh* newMesh = new Mesh(newNode->matrix);
 			for (size_t j = 0; j < mesh.primitives.size(); j++) {
 				const tinygltf::Primitive& primitive = mesh.primitives[j];
 				uint32_t vertexStart = static_cast<uint32_t>(vertices_.size());
@@ -696,16 +711,12 @@ namespace Assets {
 	}
 
 	// Mesh
-	Mesh::Mesh(const vk::Device& device, glm::mat4 matrix) : 
-		device_(device) 
+	Mesh::Mesh(glm::mat4 matrix)
 	{
 		uniformBlock.matrix = matrix;
-		ubo_.reset(new Assets::UniformBuffer(device, uniformBlock));
-		ubo_->SetValue(uniformBlock);
 	}
 
 	Mesh::~Mesh() {
-		ubo_.reset();
 		for (Primitive* p : primitives)
 			delete p;
 	}
@@ -788,12 +799,9 @@ namespace Assets {
 					mesh->uniformBlock.jointMatrix[i] = jointMat;
 				}
 				mesh->uniformBlock.jointcount = (float)numJoints;
-				mesh->UniformBuffer().SetValue(mesh->uniformBlock);
-				//memcpy(mesh->uniformBuffer.mapped, &mesh->uniformBlock, sizeof(mesh->uniformBlock));
 			}
 			else {
-				mesh->UniformBuffer().SetValue(m);
-				//memcpy(mesh->uniformBuffer.mapped, &m, sizeof(glm::mat4));
+				mesh->uniformBlock.matrix = m;
 			}
 		}
 
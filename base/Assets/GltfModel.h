@@ -7,7 +7,6 @@
 #include "Assets/Vertex.h"
 #include "Assets/Texture.h"
 #include "Assets/TextureImage.h"
-#include "Assets/UniformBuffer.h"
 #include "Vulkan/Device.h"
 #include "Vulkan/Sampler.h"
 
@@ -91,14 +90,10 @@ namespace Assets
 			float jointcount{ 0 };
 		} uniformBlock;
 
-		Mesh(const vk::Device& device, glm::mat4 matrix);
+		explicit Mesh(glm::mat4 matrix);
 		~Mesh();
 
 		void setBoundingBox(glm::vec3 min, glm::vec3 max);
-		Assets::UniformBuffer& UniformBuffer() { return *ubo_; }
-
-		const vk::Device& device_;
-		std::unique_ptr<Assets::UniformBuffer> ubo_;
 	};
 
 	struct Skin {
@@ -180,6 +175,8 @@ namespace Assets
 		uint32_t NumberOfVertices() const { return static_cast<uint32_t>(vertices_.size()); }
 		uint32_t NumberOfIndices() const { return static_cast<uint32_t>(indices_.size()); }
 
+		void ReleaseTexturePixels();
+
 	private:
 		void loadTextureSamplers(tinygltf::Model& gltfModel);
 		void loadTextures(tinygltf::Model& gltfModel);
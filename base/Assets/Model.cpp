@@ -8,6 +8,7 @@
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
 #include <chrono>
+#include <cmath>
 #include <filesystem>
 #include <iostream>
 #include <unordered_map>
@@ -151,6 +152,32 @@ namespace Assets {
 		}
 	}
 
+	vec4 Model::BoundingSphere() const
+	{
+		return Assets::BoundingSphere(vertices_);
+	}
+
+	float Model::WorldUnitsPerUv() const
+	{
+		double worldArea = 0;
+		double uvArea = 0;
+
+		for (size_t i = 0; i + 2 < indices_.size(); i += 3)
+		{
+			const auto& v0 = vertices_[indices_[i + 0]];
+			const auto& v1 = vertices_[indices_[i + 1]];
+			const auto& v2 = vertices_[indices_[i + 2]];
+
+			worldArea += 0.5 * length(cross(v1.Position - v0.Position, v2.Position - v0.Position));
+
+			const vec2 e1 = v1.TexCoord - v0.TexCoord;
+			const vec2 e2 = v2.TexCoord - v0.TexCoord;
+			uvArea += 0.5 * std::abs(e1.x * e2.y - e1.y * e2.x);
+		}
+
+		return uvArea > 0 ? static_cast<float>(std::sqrt(worldArea / uvArea)) : 1.0f;
+	}
+
 	Model::Model(std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices) :
 		vertices_(std::move(vertices)),
 		indices_(std::move(indices))
@@ -25,6 +25,13 @@ namespace Assets
 		const std::vector<uint32_t>& Indices() const { return indices_; }
 
 
+		// Bounding sphere of the vertices (xyz = center, w = radius).
+		glm::vec4 BoundingSphere() const;
+
+		// Average world-space length covered by one unit of texture coordinates, used to estimate
+		// how many texels land on a pixel when streaming texture mips.
+		float WorldUnitsPerUv() const;
+
 		uint32_t NumberOfVertices() const { return static_cast<uint32_t>(vertices_.size()); }
 		uint32_t NumberOfIndices() const { return static_cast<uint32_t>(indices_.size()); }
 
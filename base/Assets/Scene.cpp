@@ -1,97 +1,180 @@
 #include "Assets/Scene.h"
 #include "Assets/Model.h"
 #include "Assets/GltfModel.h"
+#include "Assets/StreamingTextureImage.h"
 #include "Assets/Texture.h"
+#include "Assets/TextureCache.h"
 #include "Assets/TextureImage.h"
+#include "Assets/TexturePacker.h"
+#include "Assets/TextureStreamer.h"
 #include "Vulkan/BufferUtil.h"
 #include "Vulkan/ImageView.h"
 #include "Vulkan/Sampler.h"
+#include "Vulkan/SamplerCache.h"
 #include "Vulkan/SingleTimeCommands.h"
+#include "Vulkan/UploadManager.h"
 #include <stdexcept>
-
-
+#include <type_traits>
 
 namespace Assets {
 
-	Scene::Scene(vk::CommandPool& commandPool, std::vector<Model>&& models, std::vector<Texture>&& textures) :
-		models_(std::move(models)),
-		textures_(std::move(textures))
+	namespace
 	{
-		// Concatenate all the models
-		std::vector<Vertex> vertices;
-		std::vector<uint32_t> indices;
-		std::vector<glm::uvec2> offsets;
+		float WorldUnitsPerUv(const Model& model)
+		{
+			return model.WorldUnitsPerUv();
+		}
 
-		for (const auto& model : models_)
+		float WorldUnitsPerUv(const GltfModel&)
 		{
-			// Remember the index, vertex offsets.
-			const auto indexOffset = static_cast<uint32_t>(indices.size());
-			const auto vertexOffset = static_cast<uint32_t>(vertices.size());
+			return 0;
+		}
+	}
 
-			offsets.emplace_back(indexOffset, vertexOffset);
+	Scene::Scene(vk::CommandPool& commandPool, std::vector<Model>&& models, std::vector<Texture>&& textures, TextureStreamer* streamer)
+	{
+		// Released when the constructor returns, everything needed later lives on the device or in the draw ranges.
+		const auto consumedModels = std::move(models);
+		const auto consumedTextures = std::move(textures);
 
-			// Copy model data one after the other.
-			vertices.insert(vertices.end(), model.Vertices().begin(), model.Vertices().end());
-			indices.insert(indices.end(), model.Indices().begin(), model.Indices().end());
+		UploadGeometry(commandPool, consumedModels);
 
-		}
+		// Upload all textures, streamed ones start with their mip tail only.
+		textureImageViewHandles_.resize(consumedTextures.size());
+		textureSamplerHandles_.resize(consumedTextures.size());
 
-		//constexpr auto flags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+		if (streamer != nullptr)
+		{
+			streamingTextures_.reserve(consumedTextures.size());
 
-		vk::BufferUtil::CreateDeviceBuffer(commandPool, "Vertices", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR , vertices, vertexBuffer_, vertexBufferMemory_);
-		vk::BufferUtil::CreateDeviceBuffer(commandPool, "Indices", VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR , indices, indexBuffer_, indexBufferMemory_);
+			for (size_t i = 0; i != consumedTextures.size(); ++i)
+			{
+				streamingTextures_.emplace_back(new StreamingTextureImage(commandPool, consumedTextures[i]));
+				streamer->Register(*streamingTextures_[i]);
+				textureSamplerHandles_[i] = streamingTextures_[i]->Sampler().Handle();
+			}
 
-		// Upload all textures
-		textureImages_.reserve(textures_.size());
-		textureImageViewHandles_.resize(textures_.size());
-		textureSamplerHandles_.resize(textures_.size());
+			UpdateTextureImageViews();
+			commandPool.Device().UploadManager().Submit();
+			return;
+		}
+
+		textureImages_.reserve(consumedTextures.size());
 
-		for (size_t i = 0; i != textures_.size(); ++i)
+		for (size_t i = 0; i != consumedTextures.size(); ++i)
 		{
-			textureImages_.emplace_back(new TextureImage(commandPool, textures_[i]));
+			textureImages_.push_back(TextureCache::Acquire(commandPool, consumedTextures[i]));
 			textureImageViewHandles_[i] = textureImages_[i]->ImageView().Handle();
 			textureSamplerHandles_[i] = textureImages_[i]->Sampler().Handle();
 		}
+
+		// Every buffer and texture above was recorded into the same upload batch, submit it in one go.
+		// Later submissions on the queue see the data, nothing needs to wait for it here.
+		commandPool.Device().UploadManager().Submit();
 	}
 
-	Scene::Scene(vk::CommandPool& commandPool, std::vector<GltfModel>&& models)
+	Scene::Scene(vk::CommandPool& commandPool, std::vector<Model>&& models, std::vector<Texture>&& textures, const TexturePacking& packing) :
+		Scene(commandPool, std::move(models), std::vector<Texture>())
 	{
-		// Concatenate all the models
-		std::vector<GltfVertex> vertices;
-		std::vector<uint32_t> indices;
-		std::vector<glm::uvec2> offsets;
+		// Upload each packed group as one array image, the slots tell the shaders where every texture went.
+		const auto consumedTextures = std::move(textures);
+		const TexturePacker packer(consumedTextures, packing);
 
-		for (const auto& model : models)
+		textureArrays_.reserve(packer.Images().size());
+		textureImageViewHandles_.resize(packer.Images().size());
+		textureSamplerHandles_.resize(packer.Images().size());
+
+		for (size_t i = 0; i != packer.Images().size(); ++i)
+		{
+			const auto& image = packer.Images()[i];
+
+			textureArrays_.emplace_back(new TextureArrayImage(commandPool, image.Width, image.Height, image.Layers));
+			textureImageViewHandles_[i] = textureArrays_[i]->ImageView().Handle();
+			textureSamplerHandles_[i] = textureArrays_[i]->Sampler().Handle();
+		}
+
+		textureSlots_ = packer.Slots();
+		vk::BufferUtil::CreateDeviceBuffer(commandPool, "TextureSlots", VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, textureSlots_, textureSlotBuffer_, textureSlotBufferMemory_);
+		commandPool.Device().UploadManager().Submit();
+	}
+
+	void Scene::UpdateTextureImageViews()
+	{
+		for (size_t i = 0; i != streamingTextures_.size(); ++i)
 		{
-			// Remember the index, vertex offsets.
-			const auto indexOffset = static_cast<uint32_t>(indices.size());
-			const auto vertexOffset = static_cast<uint32_t>(vertices.size());
+			textureImageViewHandles_[i] = streamingTextures_[i]->ImageView().Handle();
+		}
+	}
 
-			offsets.emplace_back(indexOffset, vertexOffset);
+	Scene::Scene(vk::CommandPool& commandPool, std::vector<GltfModel>&& models)
+	{
+		auto consumedModels = std::move(models);
 
-			// Copy model data one after the other.
-			vertices.insert(vertices.end(), model.Vertices().begin(), model.Vertices().end());
-			indices.insert(indices.end(), model.Indices().begin(), model.Indices().end());
+		UploadGeometry(commandPool, consumedModels);
 
-			// Upload all textures
+		for (auto& model : consumedModels)
+		{
+			// Upload all textures, identical images and samplers are shared across scenes.
 			textureImages_.reserve(model.Textures().size());
+			textureSamplers_.push_back(vk::SamplerCache::Acquire(commandPool.Device(), model.Sampler()[0]));
 			textureImageViewHandles_.resize(model.Textures().size());
 			textureSamplerHandles_.resize(model.Textures().size());
 
 			for (size_t i = 0; i != model.Textures().size(); ++i)
 			{
-				textureImages_.emplace_back(new TextureImage(commandPool, model.Textures()[i], model.Sampler()[0]));
+				textureImages_.push_back(TextureCache::Acquire(commandPool, model.Textures()[i]));
 				textureImageViewHandles_[i] = textureImages_[i]->ImageView().Handle();
-				textureSamplerHandles_[i] = textureImages_[i]->Sampler().Handle();
+				textureSamplerHandles_[i] = textureSamplers_.back()->Handle();
 			}
+
+			// The pixels now live on the device.
+			model.ReleaseTexturePixels();
+		}
+
+		commandPool.Device().UploadManager().Submit();
+	}
+
+	template <class TModel>
+	void Scene::UploadGeometry(vk::CommandPool& commandPool, const std::vector<TModel>& models)
+	{
+		using TVertex = typename std::decay<decltype(models.front().Vertices().front())>::type;
+
+		VkDeviceSize vertexCount = 0;
+		VkDeviceSize indexCount = 0;
+
+		drawRanges_.reserve(models.size());
+
+		for (const auto& model : models)
+		{
+			DrawRange range = {};
+			range.FirstIndex = static_cast<uint32_t>(indexCount);
+			range.IndexCount = model.NumberOfIndices();
+			range.VertexOffset = static_cast<int32_t>(vertexCount);
+			range.Bounds = BoundingSphere(model.Vertices());
+			range.WorldUnitsPerUv = WorldUnitsPerUv(model);
+
+			drawRanges_.push_back(range);
+
+			vertexCount += model.NumberOfVertices();
+			indexCount += model.NumberOfIndices();
 		}
 
 		//constexpr auto flags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
 
-		vk::BufferUtil::CreateDeviceBuffer(commandPool, "Vertices", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, vertices, vertexBuffer_, vertexBufferMemory_);
-		vk::BufferUtil::CreateDeviceBuffer(commandPool, "Indices", VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, indices, indexBuffer_, indexBufferMemory_);
+		vk::BufferUtil::CreateDeviceBuffer(commandPool, "Vertices", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, vertexCount * sizeof(TVertex), vertexBuffer_, vertexBufferMemory_);
+		vk::BufferUtil::CreateDeviceBuffer(commandPool, "Indices", VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, indexCount * sizeof(uint32_t), indexBuffer_, indexBufferMemory_);
 
+		// Each model is copied from its own arrays straight into the staging ring, no concatenated host copy.
+		auto& uploadManager = commandPool.Device().UploadManager();
 
+		for (size_t i = 0; i != models.size(); ++i)
+		{
+			const auto& model = models[i];
+			const auto& range = drawRanges_[i];
+
+			uploadManager.CopyToBuffer(*vertexBuffer_, model.Vertices().data(), model.NumberOfVertices() * sizeof(TVertex), range.VertexOffset * sizeof(TVertex));
+			uploadManager.CopyToBuffer(*indexBuffer_, model.Indices().data(), model.NumberOfIndices() * sizeof(uint32_t), range.FirstIndex * sizeof(uint32_t));
+		}
 	}
 
 	Scene::~Scene()
@@ -99,6 +182,11 @@ namespace Assets {
 		textureSamplerHandles_.clear();
 		textureImageViewHandles_.clear();
 		textureImages_.clear();
+		textureSamplers_.clear();
+		streamingTextures_.clear();
+		textureArrays_.clear();
+		textureSlotBuffer_.reset();
+		textureSlotBufferMemory_.reset();
 		indexBuffer_.reset();
 		indexBufferMemory_.reset(); // release memory after bound buffer has been destroyed
 		vertexBuffer_.reset();
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Vulkan/VkConfig.h"
+#include "Assets/TexturePacker.h"
+#include "Utilities/Glm.h"
 #include <memory>
 #include <vector>
 
@@ -10,15 +12,31 @@ namespace vk
 	class CommandPool;
 	class DeviceMemory;
 	class Image;
+	class Sampler;
 }
 
 namespace Assets
 {
 	class Model;
 	class GltfModel;
+	class StreamingTextureImage;
 	class Texture;
+	class TextureArrayImage;
 	class TextureImage;
+	class TextureStreamer;
 
+	// Where one model lives in the scene's vertex and index buffers.
+	struct DrawRange final
+	{
+		uint32_t FirstIndex;
+		uint32_t IndexCount;
+		int32_t VertexOffset;
+		glm::vec4 Bounds; // Bounding sphere, xyz = center, w = radius.
+		float WorldUnitsPerUv; // See Model::WorldUnitsPerUv(), 0 when unknown.
+	};
+
+	// Vertices, indices and pixels are only kept on the device: the models and textures passed in are
+	// consumed by the constructor and released once staged, DrawRanges() is all that stays on the host.
 	class Scene final
 	{
 	public:
@@ -28,20 +46,32 @@ namespace Assets
 		Scene& operator = (const Scene&) = delete;
 		Scene& operator = (Scene&&) = delete;
 
-		Scene(vk::CommandPool& commandPool, std::vector<Model>&& models, std::vector<Texture>&& textures);
+		// With a streamer the textures are uploaded as streaming mip chains and registered with it.
+		Scene(vk::CommandPool& commandPool, std::vector<Model>&& models, std::vector<Texture>&& textures, TextureStreamer* streamer = nullptr);
+		// Packs the textures into array images and atlases; TextureImageViews() then holds 2D array views
+		// and TextureSlots()/TextureSlotBuffer() map each original texture index to image, layer and UVs.
+		Scene(vk::CommandPool& commandPool, std::vector<Model>&& models, std::vector<Texture>&& textures, const TexturePacking& packing);
 		Scene(vk::CommandPool& commandPool, std::vector<GltfModel>&& models);
 		~Scene();
 
-		const std::vector<Model>& Models() const { return models_; }
+		const std::vector<DrawRange>& DrawRanges() const { return drawRanges_; }
 		const vk::Buffer& VertexBuffer() const { return *vertexBuffer_; }
 		const vk::Buffer& IndexBuffer() const { return *indexBuffer_; }
 		const std::vector<VkImageView> TextureImageViews() const { return textureImageViewHandles_; }
 		const std::vector<VkSampler> TextureSamplers() const { return textureSamplerHandles_; }
+		const std::vector<TextureSlot>& TextureSlots() const { return textureSlots_; }
+		const vk::Buffer& TextureSlotBuffer() const { return *textureSlotBuffer_; }
+		const std::vector<std::unique_ptr<StreamingTextureImage>>& StreamingTextures() const { return streamingTextures_; }
+
+		// Refreshes TextureImageViews() after the streamer recreated some images.
+		void UpdateTextureImageViews();
 
 	private:
 
-		const std::vector<Model> models_;
-		const std::vector<Texture> textures_;
+		template <class TModel>
+		void UploadGeometry(vk::CommandPool& commandPool, const std::vector<TModel>& models);
+
+		std::vector<DrawRange> drawRanges_;
 
 		std::unique_ptr<vk::Buffer> vertexBuffer_;
 		std::unique_ptr<vk::DeviceMemory> vertexBufferMemory_;
@@ -49,7 +79,13 @@ namespace Assets
 		std::unique_ptr<vk::Buffer> indexBuffer_;
 		std::unique_ptr<vk::DeviceMemory> indexBufferMemory_;
 
-		std::vector<std::unique_ptr<TextureImage>> textureImages_;
+		std::vector<std::shared_ptr<TextureImage>> textureImages_;
+		std::vector<std::shared_ptr<vk::Sampler>> textureSamplers_;
+		std::vector<std::unique_ptr<StreamingTextureImage>> streamingTextures_;
+		std::vector<std::unique_ptr<TextureArrayImage>> textureArrays_;
+		std::vector<TextureSlot> textureSlots_;
+		std::unique_ptr<vk::Buffer> textureSlotBuffer_;
+		std::unique_ptr<vk::DeviceMemory> textureSlotBufferMemory_;
 		std::vector<VkImageView> textureImageViewHandles_;
 		std::vector<VkSampler> textureSamplerHandles_;
 	};
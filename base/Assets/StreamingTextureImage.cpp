@@ -0,0 +1,396 @@
+#include "Assets/StreamingTextureImage.h"
+#include "Assets/Texture.h"
+#include "Vulkan/CommandPool.h"
+#include "Vulkan/DeletionQueue.h"
+#include "Vulkan/Device.h"
+#include "Vulkan/DeviceMemory.h"
+#include "Vulkan/Image.h"
+#include "Vulkan/ImageView.h"
+#include "Vulkan/SamplerCache.h"
+#include "Vulkan/UploadManager.h"
+#include "Utilities/Pixels.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace Assets {
+
+	namespace
+	{
+		uint32_t LevelExtent(const uint32_t extent, const uint32_t level)
+		{
+			return std::max(1u, extent >> level);
+		}
+	}
+
+	class StreamingTextureImage::SpillFile final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(SpillFile)
+
+		SpillFile(const unsigned char* const data, const size_t size) :
+			size_(size),
+			file_(std::tmpfile())
+		{
+			if (file_ == nullptr || std::fwrite(data, 1, size, file_) != size || std::fflush(file_) != 0)
+			{
+				std::cerr << "WARNING: failed to page out a streamed texture, keeping it in memory" << std::endl;
+
+				if (file_ != nullptr)
+				{
+					std::fclose(file_);
+					file_ = nullptr;
+				}
+
+				memory_.assign(data, data + size);
+			}
+		}
+
+		~SpillFile()
+		{
+			if (file_ != nullptr)
+			{
+				std::fclose(file_);
+			}
+		}
+
+		std::vector<unsigned char> Read() const
+		{
+			if (file_ == nullptr)
+			{
+				return memory_;
+			}
+
+			std::vector<unsigned char> data(size_);
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			if (std::fseek(file_, 0, SEEK_SET) != 0 || std::fread(data.data(), 1, size_, file_) != size_)
+			{
+				throw std::runtime_error("failed to read back a paged out texture");
+			}
+
+			return data;
+		}
+
+	private:
+
+		const size_t size_;
+		std::FILE* file_;
+		std::vector<unsigned char> memory_; // Only if the file could not be written.
+		mutable std::mutex mutex_;
+	};
+
+	StreamingTextureImage::StreamingTextureImage(vk::CommandPool& commandPool, const Texture& texture, const vk::SamplerConfig& sampler, const uint32_t tailSize) :
+		width_(static_cast<uint32_t>(texture.Width())),
+		height_(static_cast<uint32_t>(texture.Height())),
+		tailLevel_(0),
+		residentLevel_(0)
+	{
+		for (uint32_t level = 0; ; ++level)
+		{
+			const uint32_t width = LevelExtent(width_, level);
+			const uint32_t height = LevelExtent(height_, level);
+
+			levelSizes_.push_back(static_cast<VkDeviceSize>(width) * height * 4);
+
+			if (std::max(width, height) > tailSize)
+			{
+				tailLevel_ = level + 1;
+			}
+
+			if (width == 1 && height == 1)
+			{
+				break;
+			}
+		}
+
+		tailLevel_ = std::min(tailLevel_, MipLevels() - 1);
+
+		levels_ = BuildTail(texture.Pixels(), width_, height_, tailLevel_, MipLevels());
+
+		if (tailLevel_ != 0)
+		{
+			source_ = std::make_shared<const SpillFile>(texture.Pixels(), levelSizes_[0]);
+		}
+
+		// The image is recreated with fewer levels as it streams, LOD clamping is left to the view.
+		vk::SamplerConfig config = sampler;
+		config.MaxLod = static_cast<float>(MipLevels());
+		sampler_ = vk::SamplerCache::Acquire(commandPool.Device(), config);
+
+		Upload(commandPool, tailLevel_);
+	}
+
+	StreamingTextureImage::~StreamingTextureImage()
+	{
+		if (pending_.valid())
+		{
+			pending_.wait();
+		}
+
+		// The copy may still be writing the replacement image.
+		if (uploadImage_)
+		{
+			uploadImage_->Device().UploadManager().Wait(uploadToken_);
+		}
+
+		uploadImageView_.reset();
+		uploadImage_.reset();
+		uploadImageMemory_.reset();
+		sampler_.reset();
+		imageView_.reset();
+		image_.reset();
+		imageMemory_.reset();
+	}
+
+	VkDeviceSize StreamingTextureImage::ResidentBytes(const uint32_t level) const
+	{
+		VkDeviceSize size = 0;
+
+		for (uint32_t i = level; i < MipLevels(); ++i)
+		{
+			size += levelSizes_[i];
+		}
+
+		return size;
+	}
+
+	void StreamingTextureImage::Request(uint32_t level)
+	{
+		level = std::min(level, tailLevel_);
+
+		if (IsLoading() || level >= residentLevel_)
+		{
+			return;
+		}
+
+		Load(level);
+	}
+
+	void StreamingTextureImage::Load(const uint32_t level)
+	{
+		pendingLevel_ = level;
+		pending_ = std::async(std::launch::async,
+			[source = source_, width = width_, height = height_, first = level, last = MipLevels()]()
+			{
+				// The tail is rebuilt as well, replacing the sampled approximation made at load.
+				return BuildLevels(source->Read(), width, height, first, last);
+			});
+	}
+
+	bool StreamingTextureImage::Update(vk::CommandPool& commandPool)
+	{
+		if (uploadImage_)
+		{
+			const auto& device = commandPool.Device();
+
+			if (!device.UploadManager().IsComplete(uploadToken_))
+			{
+				return false;
+			}
+
+			// Frames in flight may still sample the previous image, it is released once they have completed.
+			auto& deletionQueue = device.DeletionQueue();
+			deletionQueue.Retire(std::move(imageView_));
+			deletionQueue.Retire(std::move(image_));
+			deletionQueue.Retire(std::move(imageMemory_));
+
+			imageView_ = std::move(uploadImageView_);
+			image_ = std::move(uploadImage_);
+			imageMemory_ = std::move(uploadImageMemory_);
+			residentLevel_ = uploadLevel_;
+			return true;
+		}
+
+		if (!pending_.valid() || pending_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			return false;
+		}
+
+		auto levels = pending_.get();
+
+		for (uint32_t level = pendingLevel_; level < levels.size(); ++level)
+		{
+			levels_[level] = std::move(levels[level]);
+		}
+
+		Upload(commandPool, pendingLevel_);
+
+		// Copied to staging, levels above the tail are built again from the source when next needed.
+		for (uint32_t level = 0; level < tailLevel_; ++level)
+		{
+			std::vector<unsigned char>().swap(levels_[level]);
+		}
+
+		return false;
+	}
+
+	void StreamingTextureImage::Evict(vk::CommandPool& commandPool, uint32_t level)
+	{
+		level = std::min(level, tailLevel_);
+
+		if (IsLoading() || level <= residentLevel_)
+		{
+			return;
+		}
+
+		if (level == tailLevel_)
+		{
+			Upload(commandPool, level);
+			return;
+		}
+
+		Load(level);
+	}
+
+	StreamingTextureImage::Levels StreamingTextureImage::BuildLevels(std::vector<unsigned char> source, const uint32_t width, const uint32_t height, const uint32_t first, const uint32_t last)
+	{
+		Levels levels(last);
+		std::vector<unsigned char> scratch;
+		const unsigned char* previous = source.data();
+
+		for (uint32_t level = 1; level < last; ++level)
+		{
+			std::vector<unsigned char> pixels(static_cast<size_t>(LevelExtent(width, level)) * LevelExtent(height, level) * 4);
+			Utilities::Pixels::HalveRgba(previous, LevelExtent(width, level - 1), LevelExtent(height, level - 1), pixels.data());
+
+			if (level >= first)
+			{
+				levels[level] = std::move(pixels);
+				previous = levels[level].data();
+			}
+			else
+			{
+				scratch = std::move(pixels);
+				previous = scratch.data();
+			}
+		}
+
+		if (first == 0)
+		{
+			levels[0] = std::move(source);
+		}
+
+		return levels;
+	}
+
+	StreamingTextureImage::Levels StreamingTextureImage::BuildTail(const unsigned char* const source, const uint32_t width, const uint32_t height, const uint32_t tailLevel, const uint32_t levelCount)
+	{
+		const uint32_t MaxSamples = 4; // Per axis.
+
+		Levels levels(levelCount);
+
+		const uint32_t tailWidth = LevelExtent(width, tailLevel);
+		const uint32_t tailHeight = LevelExtent(height, tailLevel);
+		auto& tail = levels[tailLevel];
+		tail.resize(static_cast<size_t>(tailWidth) * tailHeight * 4);
+
+		for (uint32_t y = 0; y != tailHeight; ++y)
+		{
+			// Source texels covered by this one, a stratified grid of them is averaged.
+			const uint32_t y0 = std::min(y << tailLevel, height - 1);
+			const uint32_t footprintY = std::max(1u, std::min(1u << tailLevel, height - y0));
+			const uint32_t samplesY = std::min(MaxSamples, footprintY);
+
+			for (uint32_t x = 0; x != tailWidth; ++x)
+			{
+				const uint32_t x0 = std::min(x << tailLevel, width - 1);
+				const uint32_t footprintX = std::max(1u, std::min(1u << tailLevel, width - x0));
+				const uint32_t samplesX = std::min(MaxSamples, footprintX);
+
+				uint32_t sum[4] = {};
+
+				for (uint32_t sy = 0; sy != samplesY; ++sy)
+				{
+					const size_t row = y0 + (2 * sy + 1) * footprintY / (2 * samplesY);
+
+					for (uint32_t sx = 0; sx != samplesX; ++sx)
+					{
+						const size_t column = x0 + (2 * sx + 1) * footprintX / (2 * samplesX);
+						const unsigned char* texel = source + (row * width + column) * 4;
+
+						for (int c = 0; c != 4; ++c)
+						{
+							sum[c] += texel[c];
+						}
+					}
+				}
+
+				const uint32_t count = samplesX * samplesY;
+				unsigned char* out = tail.data() + (static_cast<size_t>(y) * tailWidth + x) * 4;
+
+				for (int c = 0; c != 4; ++c)
+				{
+					out[c] = static_cast<unsigned char>((sum[c] + count / 2) / count);
+				}
+			}
+		}
+
+		for (uint32_t level = tailLevel + 1; level < levelCount; ++level)
+		{
+			levels[level].resize(static_cast<size_t>(LevelExtent(width, level)) * LevelExtent(height, level) * 4);
+			Utilities::Pixels::HalveRgba(levels[level - 1].data(), LevelExtent(width, level - 1), LevelExtent(height, level - 1), levels[level].data());
+		}
+
+		return levels;
+	}
+
+	void StreamingTextureImage::Upload(vk::CommandPool& commandPool, const uint32_t baseLevel)
+	{
+		const auto& device = commandPool.Device();
+		const uint32_t levelCount = MipLevels() - baseLevel;
+
+		// Every resident level goes into one upload, staged straight from levels_.
+		std::vector<std::pair<const void*, VkDeviceSize>> sources;
+		std::vector<VkBufferImageCopy> regions;
+
+		for (uint32_t level = baseLevel; level != MipLevels(); ++level)
+		{
+			sources.emplace_back(levels_[level].data(), levelSizes_[level]);
+
+			VkBufferImageCopy region = {};
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = level - baseLevel;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount = 1;
+			region.imageExtent = { LevelExtent(width_, level), LevelExtent(height_, level), 1 };
+
+			regions.push_back(region);
+		}
+
+		// Create the device side image, memory and view.
+		auto image = std::make_unique<vk::Image>(device, VkExtent2D{ LevelExtent(width_, baseLevel), LevelExtent(height_, baseLevel) }, VK_FORMAT_R8G8B8A8_UNORM, levelCount, 1);
+		auto imageMemory = std::make_unique<vk::DeviceMemory>(image->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+		auto imageView = std::make_unique<vk::ImageView>(device, image->Handle(), image->Format(), VK_IMAGE_ASPECT_COLOR_BIT, 1, 0, VK_IMAGE_VIEW_TYPE_2D, levelCount);
+
+		auto& uploadManager = device.UploadManager();
+
+		// The first image goes out with the scene's upload batch and is used right away.
+		if (!image_)
+		{
+			uploadManager.CopyToImage(*image, sources, regions, levelCount, 1);
+
+			imageView_ = std::move(imageView);
+			image_ = std::move(image);
+			imageMemory_ = std::move(imageMemory);
+			residentLevel_ = baseLevel;
+			return;
+		}
+
+		// Replacements stream in a batch of their own while rendering carries on with the current image,
+		// earlier uploads are submitted first so they are not held back with it.
+		uploadManager.Submit();
+		uploadManager.CopyToImage(*image, sources, regions, levelCount, 1);
+		uploadToken_ = uploadManager.SubmitAsync();
+
+		uploadImageView_ = std::move(imageView);
+		uploadImage_ = std::move(image);
+		uploadImageMemory_ = std::move(imageMemory);
+		uploadLevel_ = baseLevel;
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Vulkan/VkConfig.h"
+#include "Vulkan/Sampler.h"
+#include "Vulkan/UploadManager.h"
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace vk
+{
+	class CommandPool;
+	class DeviceMemory;
+	class Image;
+	class ImageView;
+}
+
+namespace Assets
+{
+	class Texture;
+
+	// Texture whose finest mip levels are only resident on demand. Construction uploads the mip tail
+	// (levels no larger than tailSize), Request() builds finer levels on a worker thread and Evict() drops
+	// back to a coarser level. Each residency change recreates the image, uploaded asynchronously and
+	// swapped in by Update() once complete, so descriptors referencing ImageView() must be rewritten when
+	// Update() returns true. Only the tail stays in host memory: the full resolution source is paged out to
+	// a temporary file, which the worker reads back whenever finer levels are needed.
+	class StreamingTextureImage final
+	{
+	public:
+
+		StreamingTextureImage(const StreamingTextureImage&) = delete;
+		StreamingTextureImage(StreamingTextureImage&&) = delete;
+		StreamingTextureImage& operator = (const StreamingTextureImage&) = delete;
+		StreamingTextureImage& operator = (StreamingTextureImage&&) = delete;
+
+		StreamingTextureImage(vk::CommandPool& commandPool, const Texture& texture, const vk::SamplerConfig& sampler = vk::SamplerConfig(), uint32_t tailSize = 128);
+		~StreamingTextureImage();
+
+		const vk::ImageView& ImageView() const { return *imageView_; }
+		const vk::Sampler& Sampler() const { return *sampler_; }
+
+		uint32_t Width() const { return width_; }
+		uint32_t Height() const { return height_; }
+		uint32_t MipLevels() const { return static_cast<uint32_t>(levelSizes_.size()); }
+		uint32_t TailLevel() const { return tailLevel_; }
+		uint32_t ResidentLevel() const { return residentLevel_; }
+		bool IsLoading() const { return pending_.valid() || uploadImage_ != nullptr; }
+
+		// Device bytes used when levels [level, MipLevels()) are resident.
+		VkDeviceSize ResidentBytes(uint32_t level) const;
+		VkDeviceSize ResidentBytes() const { return ResidentBytes(residentLevel_); }
+
+		// Starts building the levels finer than the resident ones, down to level. Ignored while a load is in flight.
+		void Request(uint32_t level);
+
+		// Uploads a finished load and swaps in a completed upload, returns true if the image view changed.
+		bool Update(vk::CommandPool& commandPool);
+
+		// Drops the levels finer than level, rebuilding the remaining ones above the tail on a worker thread.
+		// Ignored while a load is in flight.
+		void Evict(vk::CommandPool& commandPool, uint32_t level);
+
+	private:
+
+		using Levels = std::vector<std::vector<unsigned char>>;
+
+		class SpillFile;
+
+		static Levels BuildLevels(std::vector<unsigned char> source, uint32_t width, uint32_t height, uint32_t first, uint32_t last);
+		// Levels [tailLevel, levelCount) from a fixed number of samples per texel, so the cost does not grow with
+		// the source resolution. The first load of finer levels replaces them with properly filtered ones.
+		static Levels BuildTail(const unsigned char* source, uint32_t width, uint32_t height, uint32_t tailLevel, uint32_t levelCount);
+
+		void Load(uint32_t level);
+		void Upload(vk::CommandPool& commandPool, uint32_t baseLevel);
+
+		uint32_t width_;
+		uint32_t height_;
+		uint32_t tailLevel_;
+		uint32_t residentLevel_;
+		std::vector<VkDeviceSize> levelSizes_;
+
+		// Level 0, shared with the worker thread. Null if the whole texture fits in the tail.
+		std::shared_ptr<const SpillFile> source_;
+		// Host copies of the tail levels, the finer ones only between a load and its upload.
+		Levels levels_;
+
+		std::future<Levels> pending_;
+		uint32_t pendingLevel_{};
+
+		std::unique_ptr<vk::Image> image_;
+		std::unique_ptr<vk::DeviceMemory> imageMemory_;
+		std::unique_ptr<vk::ImageView> imageView_;
+		std::shared_ptr<vk::Sampler> sampler_;
+
+		// Replacement image while its upload is in flight.
+		std::unique_ptr<vk::Image> uploadImage_;
+		std::unique_ptr<vk::DeviceMemory> uploadImageMemory_;
+		std::unique_ptr<vk::ImageView> uploadImageView_;
+		vk::UploadManager::Token uploadToken_{};
+		uint32_t uploadLevel_{};
+	};
+}
@@ -1,8 +1,12 @@
 #include "Assets/Texture.h"
+#include "Utilities/Pixels.h"
 #include "Utilities/StbImage.h"
 #include <stdexcept>
+#include <cstdlib>
+#include <new>
 #include <chrono>
 #include <iostream>
+#include <utility>
 
 namespace Assets {
 
@@ -27,40 +31,85 @@ namespace Assets {
 		return Texture(width, height, channels, pixels);
 	}
 
+	Texture Texture::PackOcclusionRoughnessMetalness(const Texture& occlusion, const Texture& roughness, const Texture& metalness)
+	{
+		const int width = occlusion.Width();
+		const int height = occlusion.Height();
+
+		if (roughness.Width() != width || roughness.Height() != height || metalness.Width() != width || metalness.Height() != height)
+		{
+			throw std::invalid_argument("occlusion, roughness and metalness maps must have the same size to be packed");
+		}
+
+		const size_t pixelCount = static_cast<size_t>(width) * height;
+		const auto packed = static_cast<unsigned char*>(std::malloc(pixelCount * 4));
+
+		if (!packed)
+		{
+			throw std::bad_alloc();
+		}
+
+		// All loaded textures are expanded to RGBA, the single-channel value is in R.
+		const unsigned char* ao = occlusion.Pixels();
+		const unsigned char* rough = roughness.Pixels();
+		const unsigned char* metal = metalness.Pixels();
+
+		for (size_t i = 0; i != pixelCount; ++i)
+		{
+			packed[i * 4 + 0] = ao[i * 4];
+			packed[i * 4 + 1] = rough[i * 4];
+			packed[i * 4 + 2] = metal[i * 4];
+			packed[i * 4 + 3] = 0xFF;
+		}
+
+		return Texture(width, height, 3, packed, std::free);
+	}
+
 	Texture::Texture(int width, int height, int channels, unsigned char* const pixels) :
+		Texture(width, height, channels, pixels, stbi_image_free)
+	{
+	}
+
+	Texture::Texture(int width, int height, int channels, unsigned char* const pixels, void (*deleter) (void*)) :
 		width_(width),
 		height_(height),
 		channels_(channels),
-		pixels_(pixels, stbi_image_free)
+		pixels_(pixels, deleter)
 	{
 	}
 
-	GltfTexture GltfTexture::LoadTexture(tinygltf::Image& gltfimage) {
-		unsigned char* buffer;
-		VkDeviceSize bufferSize = gltfimage.width * gltfimage.height * 4;
-		buffer = new unsigned char[bufferSize];
-		unsigned char* rgba = buffer;
-		unsigned char* rgb = &gltfimage.image[0];
-
-		int32_t channel = gltfimage.component;
-		for (int32_t i = 0; i < gltfimage.width * gltfimage.height; ++i) {
-			for (int32_t j = 0; j < channel; ++j) {
-				rgba[j] = rgb[j];
-			}
-			rgba += 4;
-			rgb += channel;
+	GltfTexture GltfTexture::LoadTexture(const tinygltf::Image& gltfimage) {
+		const size_t pixelCount = static_cast<size_t>(gltfimage.width) * gltfimage.height;
+
+		if (gltfimage.component == 4) {
+			return GltfTexture(gltfimage.width, gltfimage.height, 4, std::vector<unsigned char>(gltfimage.image));
+		}
+
+		std::vector<unsigned char> rgba(pixelCount * 4);
+		Utilities::Pixels::ExpandToRgba(gltfimage.image.data(), gltfimage.component, rgba.data(), pixelCount);
+
+		return GltfTexture(gltfimage.width, gltfimage.height, 4, std::move(rgba));
+	}
+
+	GltfTexture GltfTexture::LoadTexture(tinygltf::Image&& gltfimage) {
+		// RGBA images already have the layout we upload, so take over tinygltf's buffer instead of copying it.
+		if (gltfimage.component == 4) {
+			return GltfTexture(gltfimage.width, gltfimage.height, 4, std::move(gltfimage.image));
 		}
-		int width = gltfimage.width;
-		int height = gltfimage.height;
-		int channels = 4;
-		return GltfTexture(width, height, channels, buffer);
+
+		return LoadTexture(static_cast<const tinygltf::Image&>(gltfimage));
 	}
 
-	GltfTexture::GltfTexture(int width, int height, int channels, unsigned char* const pixels) :
+	GltfTexture::GltfTexture(int width, int height, int channels, std::vector<unsigned char>&& pixels) :
 		width_(width),
 		height_(height),
 		channels_(channels),
-		pixels_(pixels)
+		pixels_(std::move(pixels))
+	{
+	}
+
+	void GltfTexture::ReleasePixels()
 	{
+		std::vector<unsigned char>().swap(pixels_);
 	}
 }
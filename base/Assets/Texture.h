@@ -4,6 +4,7 @@
 #include "tiny_gltf.h"
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace Assets
 {
@@ -12,6 +13,10 @@ namespace Assets
 	public:
 
 		static Texture LoadTexture(const std::string& filename, const vk::SamplerConfig& samplerConfig);
+
+		// Packs the red channels of three single-channel maps into one glTF-style ORM texture
+		// (R = occlusion, G = roughness, B = metalness), so the shader needs one fetch instead of three.
+		static Texture PackOcclusionRoughnessMetalness(const Texture& occlusion, const Texture& roughness, const Texture& metalness);
 		Texture& operator = (const Texture&) = delete;
 		Texture& operator = (Texture&&) = delete;
 
@@ -26,6 +31,8 @@ namespace Assets
 		int Height() const { return height_; }
 
 	private:
+		Texture(int width, int height, int channels, unsigned char* pixels, void (*deleter) (void*));
+
 		vk::SamplerConfig samplerConfig_;
 		int width_;
 		int height_;
@@ -37,17 +44,21 @@ namespace Assets
 	{
 	public:
 
-		static GltfTexture LoadTexture(tinygltf::Image& gltfimage);
+		static GltfTexture LoadTexture(const tinygltf::Image& gltfimage);
+		static GltfTexture LoadTexture(tinygltf::Image&& gltfimage);
 		GltfTexture& operator = (const GltfTexture&) = delete;
 		GltfTexture& operator = (GltfTexture&&) = delete;
 
 		GltfTexture() = default;
 		GltfTexture(const GltfTexture&) = default;
 		GltfTexture(GltfTexture&&) = default;
-		GltfTexture(int width, int height, int channels, unsigned char* pixels);
+		GltfTexture(int width, int height, int channels, std::vector<unsigned char>&& pixels);
 		~GltfTexture() = default;
 
-		const unsigned char* Pixels() const { return pixels_; }
+		// Frees the host copy of the pixels once they have been uploaded to the device.
+		void ReleasePixels();
+
+		const unsigned char* Pixels() const { return pixels_.data(); }
 		int Width() const { return width_; }
 		int Height() const { return height_; }
 
@@ -55,7 +66,7 @@ namespace Assets
 		int width_;
 		int height_;
 		int channels_;
-		unsigned char* pixels_;
+		std::vector<unsigned char> pixels_;
 	};
 
 }
@@ -0,0 +1,68 @@
+#include "Assets/TextureCache.h"
+#include "Assets/Texture.h"
+#include "Assets/TextureImage.h"
+#include "Vulkan/CommandPool.h"
+#include "Vulkan/Device.h"
+#include "Utilities/Hash.h"
+#include <cstring>
+
+namespace Assets {
+
+	std::mutex TextureCache::mutex_;
+	std::unordered_multimap<uint64_t, TextureCache::Entry> TextureCache::entries_;
+
+	std::shared_ptr<TextureImage> TextureCache::Acquire(vk::CommandPool& commandPool, const Texture& texture)
+	{
+		return Acquire(commandPool, texture, VK_FORMAT_R8G8B8A8_UNORM);
+	}
+
+	std::shared_ptr<TextureImage> TextureCache::Acquire(vk::CommandPool& commandPool, const GltfTexture& texture)
+	{
+		return Acquire(commandPool, texture, VK_FORMAT_R8G8B8A8_UNORM);
+	}
+
+	template <class TTexture>
+	std::shared_ptr<TextureImage> TextureCache::Acquire(vk::CommandPool& commandPool, const TTexture& texture, const VkFormat format)
+	{
+		const VkDevice device = commandPool.Device().Handle();
+		const auto width = static_cast<uint32_t>(texture.Width());
+		const auto height = static_cast<uint32_t>(texture.Height());
+		const size_t size = static_cast<size_t>(width) * height * 4;
+
+		// A fast hash could collide and hand one texture's image to another, the digest is compared on lookup.
+		const auto digest = Utilities::Sha256::Bytes(texture.Pixels(), size);
+
+		uint64_t hash;
+		std::memcpy(&hash, digest.data(), sizeof(hash));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(format));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(device));
+
+		// Hold the lock across the upload so two threads loading the same image do not both create it.
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		const auto range = entries_.equal_range(hash);
+		for (auto it = range.first; it != range.second; )
+		{
+			auto image = it->second.Instance.lock();
+
+			if (!image)
+			{
+				it = entries_.erase(it);
+				continue;
+			}
+
+			const auto& entry = it->second;
+			if (entry.Device == device && entry.Width == width && entry.Height == height && entry.Format == format && entry.Pixels == digest)
+			{
+				return image;
+			}
+
+			++it;
+		}
+
+		auto image = std::make_shared<TextureImage>(commandPool, texture, vk::SamplerConfig());
+		entries_.emplace(hash, Entry{ device, width, height, format, digest, image });
+
+		return image;
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Vulkan/VkConfig.h"
+#include "Utilities/Sha256.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace vk
+{
+	class CommandPool;
+}
+
+namespace Assets
+{
+	class GltfTexture;
+	class Texture;
+	class TextureImage;
+
+	// Process-wide cache of uploaded textures keyed by a SHA-256 digest of their pixels, extent and format.
+	// Scenes loading the same image share one device copy; entries are weak and the image is
+	// released when the last Scene referencing it is destroyed.
+	class TextureCache final
+	{
+	public:
+
+		static std::shared_ptr<TextureImage> Acquire(vk::CommandPool& commandPool, const Texture& texture);
+		static std::shared_ptr<TextureImage> Acquire(vk::CommandPool& commandPool, const GltfTexture& texture);
+
+	private:
+
+		struct Entry
+		{
+			VkDevice Device;
+			uint32_t Width;
+			uint32_t Height;
+			VkFormat Format;
+			Utilities::Sha256::Digest Pixels;
+			std::weak_ptr<TextureImage> Instance;
+		};
+
+		template <class TTexture>
+		static std::shared_ptr<TextureImage> Acquire(vk::CommandPool& commandPool, const TTexture& texture, VkFormat format);
+
+		static std::mutex mutex_;
+		static std::unordered_multimap<uint64_t, Entry> entries_;
+	};
+}
@@ -8,7 +8,9 @@
 #include "Vulkan/ImageView.h"
 #include "Vulkan/Image.h"
 #include "Vulkan/Sampler.h"
+#include "Vulkan/SamplerCache.h"
 #include <memory>
+#include <vector>
 
 namespace vk
 {
@@ -34,7 +36,7 @@ namespace Assets
 		TextureImage& operator = (const TextureImage&) = delete;
 		TextureImage& operator = (TextureImage&&) = delete;
 
-		TextureImage(vk::CommandPool& commandPool, const Texture& texture);
+		TextureImage(vk::CommandPool& commandPool, const Texture& texture, const vk::SamplerConfig& sampler = vk::SamplerConfig());
 		TextureImage(vk::CommandPool& commandPool, const GltfTexture& texture, const vk::SamplerConfig& sampler);
 		TextureImage(const vk::Device& device, const uint32_t dim, const VkFormat format, const VkImageUsageFlags usage);
 		~TextureImage();
@@ -47,7 +49,7 @@ namespace Assets
 		std::unique_ptr<vk::Image> image_;
 		std::unique_ptr<vk::DeviceMemory> imageMemory_;
 		std::unique_ptr<vk::ImageView> imageView_;
-		std::unique_ptr<vk::Sampler> sampler_;
+		std::shared_ptr<vk::Sampler> sampler_;
 	};
 
 	class TextureCubeImage final
@@ -69,6 +71,28 @@ namespace Assets
 		std::unique_ptr<vk::Image> image_;
 		std::unique_ptr<vk::DeviceMemory> imageMemory_;
 		std::unique_ptr<vk::CubeImageView> imageView_;
-		std::unique_ptr<vk::Sampler> sampler_;
+		std::shared_ptr<vk::Sampler> sampler_;
+	};
+
+	// Same-sized RGBA layers in one image, viewed as a sampler2DArray.
+	class TextureArrayImage final
+	{
+	public:
+		TextureArrayImage(const TextureArrayImage&) = delete;
+		TextureArrayImage(TextureArrayImage&&) = delete;
+		TextureArrayImage& operator = (const TextureArrayImage&) = delete;
+		TextureArrayImage& operator = (TextureArrayImage&&) = delete;
+
+		TextureArrayImage(vk::CommandPool& commandPool, uint32_t width, uint32_t height, const std::vector<const unsigned char*>& layers, const vk::SamplerConfig& sampler = vk::SamplerConfig());
+		~TextureArrayImage();
+
+		const vk::ImageView& ImageView() const { return *imageView_; }
+		const vk::Sampler& Sampler() const { return *sampler_; }
+
+	private:
+		std::unique_ptr<vk::Image> image_;
+		std::unique_ptr<vk::DeviceMemory> imageMemory_;
+		std::unique_ptr<vk::ImageView> imageView_;
+		std::shared_ptr<vk::Sampler> sampler_;
 	};
 }
@@ -0,0 +1,126 @@
+#include "Assets/TexturePacker.h"
+#include "Assets/Texture.h"
+#include <algorithm>
+#include <map>
+#include <utility>
+
+namespace Assets {
+
+	TexturePacker::TexturePacker(const std::vector<Texture>& textures, const TexturePacking& options)
+	{
+		slots_.resize(textures.size());
+
+		std::vector<size_t> small;
+		std::map<std::pair<uint32_t, uint32_t>, uint32_t> arrays;
+
+		for (size_t i = 0; i != textures.size(); ++i)
+		{
+			const auto width = static_cast<uint32_t>(textures[i].Width());
+			const auto height = static_cast<uint32_t>(textures[i].Height());
+
+			if (width <= options.AtlasThreshold && height <= options.AtlasThreshold &&
+				width + 2 * options.Padding <= options.AtlasSize && height + 2 * options.Padding <= options.AtlasSize)
+			{
+				small.push_back(i);
+				continue;
+			}
+
+			// Same extent (all textures are RGBA8) means same array image.
+			const auto key = std::make_pair(width, height);
+			auto it = arrays.find(key);
+
+			if (it == arrays.end())
+			{
+				it = arrays.emplace(key, static_cast<uint32_t>(images_.size())).first;
+				images_.push_back(Image{ width, height, {} });
+			}
+
+			auto& image = images_[it->second];
+			slots_[i] = TextureSlot{ glm::vec4(1, 1, 0, 0), it->second, static_cast<uint32_t>(image.Layers.size()), {} };
+			image.Layers.push_back(textures[i].Pixels());
+		}
+
+		if (!small.empty())
+		{
+			PackAtlas(textures, small, options);
+		}
+	}
+
+	void TexturePacker::PackAtlas(const std::vector<Texture>& textures, std::vector<size_t> indices, const TexturePacking& options)
+	{
+		const uint32_t size = options.AtlasSize;
+		const uint32_t padding = options.Padding;
+		const auto imageIndex = static_cast<uint32_t>(images_.size());
+
+		// Shelf packing, tallest first so each shelf wastes little height.
+		std::sort(indices.begin(), indices.end(), [&](const size_t a, const size_t b)
+			{
+				return textures[a].Height() > textures[b].Height();
+			});
+
+		uint32_t x = 0;
+		uint32_t y = 0;
+		uint32_t shelfHeight = 0;
+
+		atlasPages_.emplace_back(static_cast<size_t>(size) * size * 4, 0);
+
+		for (const size_t index : indices)
+		{
+			const auto& texture = textures[index];
+			const auto width = static_cast<uint32_t>(texture.Width());
+			const auto height = static_cast<uint32_t>(texture.Height());
+
+			if (x + width + 2 * padding > size)
+			{
+				x = 0;
+				y += shelfHeight;
+				shelfHeight = 0;
+			}
+
+			if (y + height + 2 * padding > size)
+			{
+				atlasPages_.emplace_back(static_cast<size_t>(size) * size * 4, 0);
+				x = 0;
+				y = 0;
+				shelfHeight = 0;
+			}
+
+			// Copy with the edge pixels replicated into the padding.
+			unsigned char* page = atlasPages_.back().data();
+			const unsigned char* pixels = texture.Pixels();
+
+			for (uint32_t dy = 0; dy != height + 2 * padding; ++dy)
+			{
+				const uint32_t sy = std::min(std::max(dy, padding) - padding, height - 1);
+
+				for (uint32_t dx = 0; dx != width + 2 * padding; ++dx)
+				{
+					const uint32_t sx = std::min(std::max(dx, padding) - padding, width - 1);
+					const unsigned char* src = pixels + (static_cast<size_t>(sy) * width + sx) * 4;
+					unsigned char* dst = page + (static_cast<size_t>(y + dy) * size + x + dx) * 4;
+
+					std::copy(src, src + 4, dst);
+				}
+			}
+
+			const float scale = 1.0f / static_cast<float>(size);
+
+			slots_[index] = TextureSlot{
+				glm::vec4(width * scale, height * scale, (x + padding) * scale, (y + padding) * scale),
+				imageIndex,
+				static_cast<uint32_t>(atlasPages_.size() - 1),
+				{} };
+
+			x += width + 2 * padding;
+			shelfHeight = std::max(shelfHeight, height + 2 * padding);
+		}
+
+		// All pages share one extent, so they become the layers of a single array image.
+		images_.push_back(Image{ size, size, {} });
+
+		for (const auto& page : atlasPages_)
+		{
+			images_.back().Layers.push_back(page.data());
+		}
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Utilities/Glm.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Assets
+{
+	class Texture;
+
+	struct TexturePacking final
+	{
+		uint32_t AtlasThreshold = 256;	// Textures no larger than this on either side go into the atlas.
+		uint32_t AtlasSize = 1024;		// Width and height of every atlas page.
+		uint32_t Padding = 2;			// Replicated border around atlas entries against filtering bleed.
+	};
+
+	// Where a scene texture ended up after packing. Laid out to match the std430 TextureSlot
+	// struct in the shaders: sample tex[Image] at vec3(uv * UvTransform.xy + UvTransform.zw, Layer).
+	struct TextureSlot final
+	{
+		glm::vec4 UvTransform;
+		uint32_t Image;
+		uint32_t Layer;
+		uint32_t Padding[2];
+	};
+
+	// Groups same-sized textures into layers of one 2D array image and packs small textures into
+	// atlas pages (which form one more array image), so a scene needs a handful of images and
+	// descriptors instead of one per texture. Atlas entries cannot use repeat addressing.
+	class TexturePacker final
+	{
+	public:
+
+		struct Image
+		{
+			uint32_t Width;
+			uint32_t Height;
+			std::vector<const unsigned char*> Layers;
+		};
+
+		TexturePacker(const TexturePacker&) = delete;
+		TexturePacker(TexturePacker&&) = delete;
+		TexturePacker& operator = (const TexturePacker&) = delete;
+		TexturePacker& operator = (TexturePacker&&) = delete;
+
+		TexturePacker(const std::vector<Texture>& textures, const TexturePacking& options);
+		~TexturePacker() = default;
+
+		// Layer pixels point into the source textures or into atlas pages owned by the packer.
+		const std::vector<Image>& Images() const { return images_; }
+		const std::vector<TextureSlot>& Slots() const { return slots_; }
+
+	private:
+
+		void PackAtlas(const std::vector<Texture>& textures, std::vector<size_t> indices, const TexturePacking& options);
+
+		std::vector<Image> images_;
+		std::vector<TextureSlot> slots_;
+		std::vector<std::vector<unsigned char>> atlasPages_;
+	};
+}
@@ -0,0 +1,115 @@
+#include "Assets/TextureStreamer.h"
+#include "Assets/StreamingTextureImage.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Assets {
+
+	TextureStreamer::TextureStreamer(const VkDeviceSize budget) :
+		budget_(budget)
+	{
+	}
+
+	VkDeviceSize TextureStreamer::ResidentBytes() const
+	{
+		VkDeviceSize size = 0;
+
+		for (const auto& entry : entries_)
+		{
+			size += entry.Texture->ResidentBytes();
+		}
+
+		return size;
+	}
+
+	void TextureStreamer::Register(StreamingTextureImage& texture)
+	{
+		entries_.push_back({ &texture, std::numeric_limits<float>::max() });
+	}
+
+	float TextureStreamer::DesiredLevel(const float distance, const float worldUnitsPerUv, const uint32_t textureSize, const float viewportHeight, const float fovY)
+	{
+		// Pixels covered by one world unit at that distance against texels covering the same unit.
+		const float pixelsPerUnit = viewportHeight / (2.0f * std::max(distance, 1e-3f) * std::tan(fovY * 0.5f));
+		const float texelsPerUnit = static_cast<float>(textureSize) / std::max(worldUnitsPerUv, 1e-6f);
+
+		return std::max(0.0f, std::log2(texelsPerUnit / pixelsPerUnit));
+	}
+
+	void TextureStreamer::Request(const StreamingTextureImage& texture, const float level)
+	{
+		for (auto& entry : entries_)
+		{
+			if (entry.Texture == &texture)
+			{
+				entry.Level = std::min(entry.Level, level);
+			}
+		}
+	}
+
+	bool TextureStreamer::Update(vk::CommandPool& commandPool)
+	{
+		// Level each texture should have, textures nobody asked for fall back to their mip tail.
+		std::vector<uint32_t> targets(entries_.size());
+		VkDeviceSize size = 0;
+
+		for (size_t i = 0; i != entries_.size(); ++i)
+		{
+			const auto& texture = *entries_[i].Texture;
+			const float level = std::floor(std::min(entries_[i].Level, static_cast<float>(texture.TailLevel())));
+
+			targets[i] = static_cast<uint32_t>(level);
+			size += texture.ResidentBytes(targets[i]);
+		}
+
+		// Over budget: drop one level from the largest texture until it fits or only tails remain.
+		while (size > budget_)
+		{
+			size_t largest = entries_.size();
+
+			for (size_t i = 0; i != entries_.size(); ++i)
+			{
+				const auto& texture = *entries_[i].Texture;
+
+				if (targets[i] < texture.TailLevel() &&
+					(largest == entries_.size() || texture.ResidentBytes(targets[i]) > entries_[largest].Texture->ResidentBytes(targets[largest])))
+				{
+					largest = i;
+				}
+			}
+
+			if (largest == entries_.size())
+			{
+				break;
+			}
+
+			const auto& texture = *entries_[largest].Texture;
+			size -= texture.ResidentBytes(targets[largest]) - texture.ResidentBytes(targets[largest] + 1);
+			++targets[largest];
+		}
+
+		const bool overBudget = ResidentBytes() > budget_;
+		bool changed = false;
+
+		for (size_t i = 0; i != entries_.size(); ++i)
+		{
+			auto& texture = *entries_[i].Texture;
+
+			// Keep one spare level before evicting so a texture does not thrash on a boundary.
+			if (targets[i] > texture.ResidentLevel() + (overBudget ? 0 : 1))
+			{
+				texture.Evict(commandPool, targets[i]);
+			}
+			else if (targets[i] < texture.ResidentLevel())
+			{
+				texture.Request(targets[i]);
+			}
+
+			changed |= texture.Update(commandPool);
+			entries_[i].Level = std::numeric_limits<float>::max();
+		}
+
+		return changed;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Vulkan/VkConfig.h"
+#include <vector>
+
+namespace vk
+{
+	class CommandPool;
+}
+
+namespace Assets
+{
+	class StreamingTextureImage;
+
+	// Decides each frame which mip levels of the registered streaming textures should be resident.
+	// Callers report the screen-space footprint of whatever samples a texture through Request(),
+	// Update() then loads the levels that are needed and evicts the ones that are not, keeping the
+	// total resident size under the memory budget by coarsening the largest textures first.
+	class TextureStreamer final
+	{
+	public:
+
+		TextureStreamer(const TextureStreamer&) = delete;
+		TextureStreamer(TextureStreamer&&) = delete;
+		TextureStreamer& operator = (const TextureStreamer&) = delete;
+		TextureStreamer& operator = (TextureStreamer&&) = delete;
+
+		explicit TextureStreamer(VkDeviceSize budget);
+		~TextureStreamer() = default;
+
+		VkDeviceSize Budget() const { return budget_; }
+		void SetBudget(VkDeviceSize budget) { budget_ = budget; }
+		VkDeviceSize ResidentBytes() const;
+
+		void Register(StreamingTextureImage& texture);
+
+		// Finest mip level worth sampling for a surface at the given distance, from how many texels
+		// of a texture of the given size land on one pixel.
+		static float DesiredLevel(float distance, float worldUnitsPerUv, uint32_t textureSize, float viewportHeight, float fovY);
+
+		// Reports that texture is sampled at a footprint needing the given level this frame.
+		void Request(const StreamingTextureImage& texture, float level);
+
+		// Applies this frame's requests, returns true if any texture image view changed.
+		bool Update(vk::CommandPool& commandPool);
+
+	private:
+
+		struct Entry
+		{
+			StreamingTextureImage* Texture;
+			float Level;
+		};
+
+		VkDeviceSize budget_;
+		std::vector<Entry> entries_;
+	};
+}
@@ -1,4 +1,6 @@
 #include "Assets/UiPipeline.h"
+#include "Vulkan/PipelineBuilder.h"
+#include "Vulkan/ShaderReflection.h"
 #include <iostream>
 
 namespace Assets {
@@ -8,100 +10,17 @@ namespace Assets {
 		const Assets::TextureImage& fontTexture) :
 		device_(device)
 	{
-		VkVertexInputBindingDescription bindingDescription = { 0, 20, VK_VERTEX_INPUT_RATE_VERTEX };
-		std::vector<VkVertexInputAttributeDescription> attributeDescriptions = {
-			{ 0, 0, VK_FORMAT_R32G32_SFLOAT, 0 },
-			{ 1, 0, VK_FORMAT_R32G32_SFLOAT, sizeof(float) * 2 },
-			{ 2, 0, VK_FORMAT_R8G8B8A8_UNORM, sizeof(float) * 4 },
-		};
-
-		VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
-		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		vertexInputInfo.vertexBindingDescriptionCount = 1;
-		vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-		vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-		VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
-		inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-		inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-		inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-		VkPipelineViewportStateCreateInfo viewportState = {};
-		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-		viewportState.viewportCount = 1;
-		viewportState.scissorCount = 1;
-
-		std::vector<VkDynamicState> dynamicStates = {
-				VK_DYNAMIC_STATE_VIEWPORT,
-				VK_DYNAMIC_STATE_SCISSOR
-		};
-
-		VkPipelineDynamicStateCreateInfo dynamicState{};
-		dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-		dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-		dynamicState.pDynamicStates = dynamicStates.data();
-
-		VkPipelineRasterizationStateCreateInfo rasterizer = {};
-		rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-		rasterizer.depthClampEnable = VK_FALSE;
-		rasterizer.rasterizerDiscardEnable = VK_FALSE;
-		rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-		rasterizer.lineWidth = 1.0f;
-		rasterizer.cullMode = VK_CULL_MODE_NONE;
-		rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-		rasterizer.depthBiasEnable = VK_FALSE;
-		rasterizer.depthBiasConstantFactor = 0.0f; // Optional
-		rasterizer.depthBiasClamp = 0.0f; // Optional
-		rasterizer.depthBiasSlopeFactor = 0.0f; // Optional
-
-		VkPipelineMultisampleStateCreateInfo multisampling = {};
-		multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-		multisampling.sampleShadingEnable = VK_FALSE;
-		multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-		multisampling.minSampleShading = 1.0f; // Optional
-		multisampling.pSampleMask = nullptr; // Optional
-		multisampling.alphaToCoverageEnable = VK_FALSE; // Optional
-		multisampling.alphaToOneEnable = VK_FALSE; // Optional
-
-		VkPipelineDepthStencilStateCreateInfo depthStencil = {};
-		depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-		depthStencil.depthTestEnable = VK_FALSE;
-		depthStencil.depthWriteEnable = VK_FALSE;
-		depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
-		depthStencil.depthBoundsTestEnable = VK_FALSE;
-		depthStencil.stencilTestEnable = VK_FALSE;
-		/*depthStencil.front = depthStencil.back;
-		depthStencil.back.compareOp = VK_COMPARE_OP_ALWAYS;*/
-
-		VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
-		colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-		colorBlendAttachment.blendEnable = VK_TRUE;
-		colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA; 
-		colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA; 
-		colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD; 
-		colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA; 
-		colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO; 
-		colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD; 
+		const auto vertCode = vk::ShaderModule::ReadFile("../shaders/ui.vert");
+		const auto fragCode = vk::ShaderModule::ReadFile("../shaders/ui.frag");
 
-		VkPipelineColorBlendStateCreateInfo colorBlending = {};
-		colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-		colorBlending.logicOpEnable = VK_FALSE;
-		colorBlending.logicOp = VK_LOGIC_OP_COPY; // Optional
-		colorBlending.attachmentCount = 1;
-		colorBlending.pAttachments = &colorBlendAttachment;
-		colorBlending.blendConstants[0] = 0.0f; // Optional
-		colorBlending.blendConstants[1] = 0.0f; // Optional
-		colorBlending.blendConstants[2] = 0.0f; // Optional
-		colorBlending.blendConstants[3] = 0.0f; // Optional
+		// Derive the descriptor bindings and push constants from the shaders.
+		vk::ShaderReflection reflection;
+		reflection.AddStage(VK_SHADER_STAGE_VERTEX_BIT, vertCode);
+		reflection.AddStage(VK_SHADER_STAGE_FRAGMENT_BIT, fragCode);
+		reflection.CheckPushConstantSize(sizeof(PushConstBlock));
 
 		// Create descriptor pool/sets.
-		std::vector<vk::DescriptorBinding> descriptorBindings =
-		{
-			{0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT}
-		};
-
-		descriptorSetManager_.reset(new vk::DescriptorSetManager(device, descriptorBindings, 1));
+		descriptorSetManager_.reset(new vk::DescriptorSetManager(device, reflection, 1));
 
 		auto& descriptorSets = descriptorSetManager_->DescriptorSets();
 
@@ -115,53 +34,35 @@ namespace Assets {
 
 		descriptorSets.UpdateDescriptors(0, descriptorWrites);
 
-		VkPushConstantRange pushConstantRange{ VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstBlock) };
-
 		// Create pipeline layout and render pass.
-		pipelineLayout_.reset(new vk::PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout(), pushConstantRange));
+		pipelineLayout_.reset(new vk::PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout(), reflection));
 
-		// Load shaders.
-		auto vert_code = vk::ShaderModule::ReadFile("../shaders/ui.vert", shaderc_glsl_vertex_shader);
-		auto frag_code = vk::ShaderModule::ReadFile("../shaders/ui.frag", shaderc_glsl_fragment_shader);
-
-		const vk::ShaderModule vertShader(device, vert_code);
-		const vk::ShaderModule fragShader(device, frag_code);
-
-		VkPipelineShaderStageCreateInfo shaderStages[] =
-		{
-			vertShader.CreateShaderStage(VK_SHADER_STAGE_VERTEX_BIT),
-			fragShader.CreateShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT)
+		// Create graphic pipeline, identical requests share one pipeline.
+		vk::PipelineState state;
+		state.VertexBindings = { { 0, 20, VK_VERTEX_INPUT_RATE_VERTEX } };
+		state.VertexAttributes = {
+			{ 0, 0, VK_FORMAT_R32G32_SFLOAT, 0 },
+			{ 1, 0, VK_FORMAT_R32G32_SFLOAT, sizeof(float) * 2 },
+			{ 2, 0, VK_FORMAT_R8G8B8A8_UNORM, sizeof(float) * 4 },
 		};
-
-		// Create graphic pipeline
-		VkGraphicsPipelineCreateInfo pipelineInfo = {};
-		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		pipelineInfo.stageCount = 2;
-		pipelineInfo.pStages = shaderStages;
-		pipelineInfo.pVertexInputState = &vertexInputInfo;
-		pipelineInfo.pInputAssemblyState = &inputAssembly;
-		pipelineInfo.pViewportState = &viewportState;
-		pipelineInfo.pRasterizationState = &rasterizer;
-		pipelineInfo.pMultisampleState = &multisampling;
-		pipelineInfo.pDepthStencilState = &depthStencil;
-		pipelineInfo.pColorBlendState = &colorBlending;
-		pipelineInfo.pDynamicState = &dynamicState;
-		pipelineInfo.layout = pipelineLayout_->Handle();
-		pipelineInfo.renderPass = renderPass.Handle();
-		pipelineInfo.subpass = 0;
-
-		vk::Check(vkCreateGraphicsPipelines(device.Handle(), nullptr, 1, &pipelineInfo, nullptr, &pipeline_),
-			"create graphics pipeline");
+		state.DepthTestEnable = false;
+		state.DepthWriteEnable = false;
+		state.DepthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+		state.ColorBlend.blendEnable = VK_TRUE;
+		state.ColorBlend.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		state.ColorBlend.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		state.ColorBlend.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+
+		vk::PipelineBuilder builder(device, state);
+		builder.AddStage(VK_SHADER_STAGE_VERTEX_BIT, vertCode);
+		builder.AddStage(VK_SHADER_STAGE_FRAGMENT_BIT, fragCode);
+
+		pipeline_ = builder.Build(*pipelineLayout_, renderPass, "ui");
 	}
 
 	UiPipeline::~UiPipeline()
 	{
-		if (pipeline_ != nullptr) {
-			vkDestroyPipeline(Device().Handle(), pipeline_, nullptr);
-			pipeline_ = nullptr;
-		}
-
-
+		pipeline_.reset();
 		pipelineLayout_.reset();
 		descriptorSetManager_.reset();
 	}
@@ -6,6 +6,7 @@
 #include "Vulkan/DescriptorPool.h"
 #include "Vulkan/DescriptorSets.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/Pipeline.h"
 #include "Vulkan/PipelineLayout.h"
 #include "Vulkan/RenderPass.h"
 #include "Vulkan/ShaderModule.h"
@@ -31,6 +32,7 @@ namespace Assets {
 			const Assets::TextureImage& fontTexture);
 		~UiPipeline();
 
+		VkPipeline Handle() const { return pipeline_->Handle(); }
 		VkDescriptorSet DescriptorSet(uint32_t index) const;
 		const vk::PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
 		const vk::Device& Device() const { return device_; }
@@ -43,7 +45,7 @@ namespace Assets {
 	private:
 		const vk::Device& device_;
 
-		VULKAN_HANDLE(VkPipeline, pipeline_)
+		std::shared_ptr<vk::Pipeline> pipeline_;
 
 		std::unique_ptr<vk::DescriptorSetManager> descriptorSetManager_;
 		std::unique_ptr<vk::PipelineLayout> pipelineLayout_;
@@ -1,4 +1,5 @@
 #include "Assets/UserInterface.h"
+#include "Vulkan/Strings.h"
 
 namespace Assets {
 	UserInterface::UserInterface(
@@ -38,7 +39,7 @@ namespace Assets {
 		vkCmdBindVertexBuffers(cmdBuffer, 0, 1, vertexBuffers, offsets);
 		vkCmdBindIndexBuffer(cmdBuffer, indexBuffer->Handle(), 0, VK_INDEX_TYPE_UINT16);
 
-		vkCmdPushConstants(cmdBuffer, pipeline_->PipelineLayout().Handle(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(UiPipeline::PushConstBlock), &pipeline_->pushConstBlock);
+		vkCmdPushConstants(cmdBuffer, pipeline_->PipelineLayout().Handle(), pipeline_->PipelineLayout().PushConstantStages(), 0, sizeof(UiPipeline::PushConstBlock), &pipeline_->pushConstBlock);
 
 		ImDrawData* imDrawData = ImGui::GetDrawData();
 		int32_t vertexOffset = 0;
@@ -110,4 +111,60 @@ namespace Assets {
 		ImGui::TextV(formatstr, args);
 		va_end(args);
 	}
+	void UserInterface::memoryStatistics(const vk::Allocator& allocator) {
+		const float mb = 1024.0f * 1024.0f;
+		const auto budgets = allocator.Budgets();
+
+		for (size_t heap = 0; heap < budgets.size(); heap++) {
+			const auto& budget = budgets[heap];
+			if (budget.PeakBlockBytes == 0) {
+				continue;
+			}
+			text("heap %d: %.0f / %.0f MB", static_cast<int>(heap), budget.Usage / mb, budget.Budget / mb);
+			if (budget.Usage > budget.Budget) {
+				ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "  over budget by %.1f MB", (budget.Usage - budget.Budget) / mb);
+			}
+			else {
+				text("  headroom %.1f MB", (budget.Budget - budget.Usage) / mb);
+			}
+			text("  blocks %.1f MB, peak %.1f MB", budget.BlockBytes / mb, budget.PeakBlockBytes / mb);
+		}
+
+		for (uint32_t i = 0; i < static_cast<uint32_t>(vk::MemoryCategory::Count); i++) {
+			const auto category = static_cast<vk::MemoryCategory>(i);
+			const auto stats = allocator.CategoryStats(category);
+			if (stats.PeakBytes == 0) {
+				continue;
+			}
+			text("%s: %.1f MB, peak %.1f MB, %.1f MB lost to rounding", vk::ToString(category), stats.AllocatedBytes / mb, stats.PeakBytes / mb,
+				(stats.AllocatedBytes - stats.RequestedBytes) / mb);
+		}
+	}
+	void UserInterface::hostStatistics(const vk::HostAllocator& hostAllocator) {
+		const float kb = 1024.0f;
+		const auto frame = hostAllocator.LastFrame();
+
+		// Allocations that keep happening every frame are the ones worth hunting down.
+		const bool churning = frame.Allocations + frame.Reallocations + frame.Frees != 0;
+		ImGui::TextColored(churning ? ImVec4(1.0f, 0.8f, 0.3f, 1.0f) : ImVec4(1.0f, 1.0f, 1.0f, 1.0f),
+			"last frame: %d allocs, %d reallocs, %d frees, %.1f KB",
+			static_cast<int>(frame.Allocations), static_cast<int>(frame.Reallocations), static_cast<int>(frame.Frees), frame.AllocatedBytes / kb);
+
+		for (uint32_t scope = 0; scope < vk::HostAllocator::ScopeCount; scope++) {
+			const auto stats = hostAllocator.ScopeStats(static_cast<VkSystemAllocationScope>(scope));
+			if (stats.TotalAllocations == 0 && stats.InternalBytes == 0) {
+				continue;
+			}
+			text("%s: %d live, %.1f KB, peak %.1f KB", vk::Strings::AllocationScope(static_cast<VkSystemAllocationScope>(scope)),
+				static_cast<int>(stats.AllocationCount), stats.AllocatedBytes / kb, stats.PeakBytes / kb);
+		}
+
+		for (const auto& type : hostAllocator.ObjectTypeStats()) {
+			if (type.second.TotalAllocations == 0) {
+				continue;
+			}
+			text("%s: %d live, %.1f KB, %d total", vk::Strings::ObjectType(type.first),
+				static_cast<int>(type.second.AllocationCount), type.second.AllocatedBytes / kb, static_cast<int>(type.second.TotalAllocations));
+		}
+	}
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "Vulkan/CommandPool.h"
 #include "Vulkan/Buffer.h"
 #include "Vulkan/DeviceMemory.h"
+#include "Vulkan/HostAllocator.h"
 #include "Assets/Texture.h"
 #include "Assets/TextureImage.h"
 #include "Assets/UiPipeline.h"
@@ -49,6 +50,9 @@ namespace Assets {
 		bool combo(const char* caption, std::string& selectedkey, std::map<std::string, std::string> items);
 		bool button(const char* caption);
 		void text(const char* formatstr, ...);
+		// Budget, usage and peak per memory heap and allocated bytes per category.
+		void memoryStatistics(const vk::Allocator& allocator);
+		void hostStatistics(const vk::HostAllocator& hostAllocator);
 
 		const Assets::TextureImage& FontTexture()const { return *fontTexture_; }
 		Assets::UiPipeline& Pipeline() { return *pipeline_; }
@@ -8,6 +8,7 @@
 
 #include "Vulkan/VkConfig.h"
 #include <array>
+#include <vector>
 
 namespace Assets
 {
@@ -132,4 +133,33 @@ namespace Assets
 		}
 	};
 
+	// Bounding sphere of any vertex type with a Position, xyz = center of the bounding box, w = radius.
+	template <class TVertex>
+	glm::vec4 BoundingSphere(const std::vector<TVertex>& vertices)
+	{
+		if (vertices.empty())
+		{
+			return glm::vec4(0);
+		}
+
+		glm::vec3 min = vertices.front().Position;
+		glm::vec3 max = min;
+
+		for (const auto& vertex : vertices)
+		{
+			min = glm::min(min, vertex.Position);
+			max = glm::max(max, vertex.Position);
+		}
+
+		const glm::vec3 center = (min + max) * 0.5f;
+		float radius = 0;
+
+		for (const auto& vertex : vertices)
+		{
+			radius = glm::max(radius, glm::distance(center, vertex.Position));
+		}
+
+		return glm::vec4(center, radius);
+	}
+
 }
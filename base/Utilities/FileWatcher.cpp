@@ -0,0 +1,158 @@
+#include "Utilities/FileWatcher.h"
+#include <stdexcept>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace Utilities {
+
+	namespace
+	{
+		bool IsIgnored(const std::filesystem::path& path)
+		{
+			const std::string name = path.filename().string();
+			return name.empty() || name.front() == '.' || name.back() == '~';
+		}
+	}
+
+	FileWatcher::FileWatcher(const std::vector<std::string>& directories, const std::chrono::milliseconds interval) :
+		interval_(interval)
+	{
+#ifdef __linux__
+		inotify_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+		if (inotify_ < 0)
+		{
+			throw std::runtime_error("failed to initialize inotify");
+		}
+
+		// Editors either rewrite the file in place or rename a temporary over it.
+		for (const auto& directory : directories)
+		{
+			const int watch = inotify_add_watch(inotify_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+			if (watch >= 0)
+			{
+				watches_[watch] = directory;
+			}
+		}
+#else
+		directories_.assign(directories.begin(), directories.end());
+		Scan(false);
+#endif
+
+		thread_ = std::thread([this]() { Run(); });
+	}
+
+	FileWatcher::~FileWatcher()
+	{
+		stopping_ = true;
+		thread_.join();
+
+#ifdef __linux__
+		close(inotify_);
+#endif
+	}
+
+	std::vector<std::string> FileWatcher::TakeChanges()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		std::vector<std::string> changes(changes_.begin(), changes_.end());
+		changes_.clear();
+
+		return changes;
+	}
+
+	void FileWatcher::Record(const std::filesystem::path& path)
+	{
+		if (IsIgnored(path))
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		changes_.insert(path.generic_string());
+	}
+
+#ifdef __linux__
+
+	void FileWatcher::Run()
+	{
+		alignas(inotify_event) char buffer[4096];
+
+		while (!stopping_)
+		{
+			pollfd descriptor = { inotify_, POLLIN, 0 };
+
+			if (poll(&descriptor, 1, static_cast<int>(interval_.count())) <= 0)
+			{
+				continue;
+			}
+
+			ssize_t size;
+
+			while ((size = read(inotify_, buffer, sizeof(buffer))) > 0)
+			{
+				for (ssize_t offset = 0; offset < size; )
+				{
+					const auto event = reinterpret_cast<const inotify_event*>(buffer + offset);
+					const auto directory = watches_.find(event->wd);
+
+					if (directory != watches_.end() && event->len != 0 && (event->mask & IN_ISDIR) == 0)
+					{
+						Record(directory->second / event->name);
+					}
+
+					offset += sizeof(inotify_event) + event->len;
+				}
+			}
+		}
+	}
+
+#else
+
+	void FileWatcher::Run()
+	{
+		while (!stopping_)
+		{
+			std::this_thread::sleep_for(interval_);
+			Scan(true);
+		}
+	}
+
+	void FileWatcher::Scan(const bool record)
+	{
+		std::error_code error;
+
+		for (const auto& directory : directories_)
+		{
+			for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+			{
+				if (!entry.is_regular_file(error))
+				{
+					continue;
+				}
+
+				const auto writeTime = entry.last_write_time(error);
+				auto& known = writeTimes_[entry.path()];
+
+				if (known != writeTime)
+				{
+					known = writeTime;
+
+					if (record)
+					{
+						Record(entry.path());
+					}
+				}
+			}
+		}
+	}
+
+#endif
+
+}
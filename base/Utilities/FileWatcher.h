@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Utilities {
+
+	// Collects the files written in a set of directories (not recursive) on a background thread. Linux uses
+	// inotify, other platforms compare modification times every interval. Hidden files and editor backups
+	// ('.name', 'name~') are ignored, so caches kept next to the sources do not report themselves.
+	class FileWatcher final
+	{
+	public:
+
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher(FileWatcher&&) = delete;
+		FileWatcher& operator = (const FileWatcher&) = delete;
+		FileWatcher& operator = (FileWatcher&&) = delete;
+
+		explicit FileWatcher(const std::vector<std::string>& directories, std::chrono::milliseconds interval = std::chrono::milliseconds(250));
+		~FileWatcher();
+
+		// Returns the files changed since the previous call, each one once.
+		std::vector<std::string> TakeChanges();
+
+	private:
+
+		void Run();
+		void Record(const std::filesystem::path& path);
+
+		const std::chrono::milliseconds interval_;
+
+		std::mutex mutex_;
+		std::set<std::string> changes_;
+
+#ifdef __linux__
+		int inotify_{ -1 };
+		std::map<int, std::filesystem::path> watches_;
+#else
+		std::vector<std::filesystem::path> directories_;
+		std::map<std::filesystem::path, std::filesystem::file_time_type> writeTimes_;
+
+		void Scan(bool record);
+#endif
+
+		std::atomic<bool> stopping_{};
+		std::thread thread_;
+	};
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace Utilities {
+	class Hash final
+	{
+	public:
+
+		// 64-bit hash of a byte range, processing 8 bytes per step (MurmurHash64A mixing).
+		static uint64_t Bytes(const void* data, const size_t size, const uint64_t seed = 0) noexcept
+		{
+			const uint64_t m = 0xc6a4a7935bd1e995ull;
+			const int r = 47;
+
+			const auto bytes = static_cast<const unsigned char*>(data);
+			const size_t words = size / 8;
+			uint64_t h = seed ^ (size * m);
+
+			for (size_t i = 0; i != words; ++i)
+			{
+				uint64_t k;
+				std::memcpy(&k, bytes + i * 8, sizeof(k));
+
+				k *= m;
+				k ^= k >> r;
+				k *= m;
+
+				h ^= k;
+				h *= m;
+			}
+
+			const unsigned char* tail = bytes + words * 8;
+			switch (size & 7)
+			{
+			case 7: h ^= uint64_t(tail[6]) << 48; [[fallthrough]];
+			case 6: h ^= uint64_t(tail[5]) << 40; [[fallthrough]];
+			case 5: h ^= uint64_t(tail[4]) << 32; [[fallthrough]];
+			case 4: h ^= uint64_t(tail[3]) << 24; [[fallthrough]];
+			case 3: h ^= uint64_t(tail[2]) << 16; [[fallthrough]];
+			case 2: h ^= uint64_t(tail[1]) << 8; [[fallthrough]];
+			case 1: h ^= uint64_t(tail[0]);
+				h *= m;
+			default:;
+			}
+
+			h ^= h >> r;
+			h *= m;
+			h ^= h >> r;
+
+			return h;
+		}
+
+		template <class T>
+		static uint64_t Value(const T& value, const uint64_t seed = 0) noexcept
+		{
+			return Bytes(&value, sizeof(T), seed);
+		}
+
+		static uint64_t Combine(const uint64_t hash0, const uint64_t hash1) noexcept
+		{
+			return hash0 ^ (hash1 + 0x9e3779b97f4a7c15ull + (hash0 << 6) + (hash0 >> 2));
+		}
+	};
+}
@@ -0,0 +1,103 @@
+#include "Utilities/Pixels.h"
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define PIXELS_USE_SSSE3
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PIXELS_USE_NEON
+#endif
+
+namespace Utilities {
+	void Pixels::ExpandRgbToRgba(const unsigned char* rgb, unsigned char* rgba, const size_t pixelCount) noexcept
+	{
+		size_t i = 0;
+
+#if defined(PIXELS_USE_SSSE3)
+		// 4 pixels per iteration: shuffle 12 RGB bytes into 16 RGBA bytes and force the alpha lanes to 0xFF.
+		// The 16 byte load reads 4 bytes past the pixels it uses, so stop while a whole load still fits.
+		const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+		for (; i + 6 <= pixelCount; i += 4)
+		{
+			const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + i * 3));
+			const __m128i out = _mm_or_si128(_mm_shuffle_epi8(in, shuffle), alpha);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + i * 4), out);
+		}
+#elif defined(PIXELS_USE_NEON)
+		// 16 pixels per iteration using the structured load/store de-interleaving.
+		for (; i + 16 <= pixelCount; i += 16)
+		{
+			const uint8x16x3_t in = vld3q_u8(rgb + i * 3);
+			uint8x16x4_t out;
+			out.val[0] = in.val[0];
+			out.val[1] = in.val[1];
+			out.val[2] = in.val[2];
+			out.val[3] = vdupq_n_u8(0xFF);
+			vst4q_u8(rgba + i * 4, out);
+		}
+#endif
+
+		// Scalar tail (and fallback when no SIMD instruction set is enabled).
+		for (; i < pixelCount; ++i)
+		{
+			rgba[i * 4 + 0] = rgb[i * 3 + 0];
+			rgba[i * 4 + 1] = rgb[i * 3 + 1];
+			rgba[i * 4 + 2] = rgb[i * 3 + 2];
+			rgba[i * 4 + 3] = 0xFF;
+		}
+	}
+
+	void Pixels::ExpandToRgba(const unsigned char* src, const int channels, unsigned char* rgba, const size_t pixelCount) noexcept
+	{
+		if (channels == 3)
+		{
+			ExpandRgbToRgba(src, rgba, pixelCount);
+			return;
+		}
+
+		// Grey and grey + alpha replicate the grey channel into RGB.
+		for (size_t i = 0; i < pixelCount; ++i)
+		{
+			const unsigned char* const in = src + i * channels;
+
+			for (int j = 0; j < 3; ++j)
+			{
+				rgba[i * 4 + j] = channels <= 2 ? in[0] : in[j];
+			}
+
+			rgba[i * 4 + 3] = channels == 2 || channels == 4 ? in[channels - 1] : 0xFF;
+		}
+	}
+
+	void Pixels::HalveRgba(const unsigned char* src, const uint32_t width, const uint32_t height, unsigned char* dst) noexcept
+	{
+		const uint32_t dstWidth = width > 1 ? width / 2 : 1;
+		const uint32_t dstHeight = height > 1 ? height / 2 : 1;
+
+		for (uint32_t y = 0; y != dstHeight; ++y)
+		{
+			// Clamp the second row/column so 1-pixel wide levels average with themselves.
+			const size_t y0 = static_cast<size_t>(y) * 2;
+			const size_t y1 = height > 1 ? y0 + 1 : y0;
+
+			for (uint32_t x = 0; x != dstWidth; ++x)
+			{
+				const size_t x0 = static_cast<size_t>(x) * 2;
+				const size_t x1 = width > 1 ? x0 + 1 : x0;
+
+				const unsigned char* p00 = src + (y0 * width + x0) * 4;
+				const unsigned char* p01 = src + (y0 * width + x1) * 4;
+				const unsigned char* p10 = src + (y1 * width + x0) * 4;
+				const unsigned char* p11 = src + (y1 * width + x1) * 4;
+				unsigned char* out = dst + (static_cast<size_t>(y) * dstWidth + x) * 4;
+
+				for (int c = 0; c != 4; ++c)
+				{
+					out[c] = static_cast<unsigned char>((p00[c] + p01[c] + p10[c] + p11[c] + 2) >> 2);
+				}
+			}
+		}
+	}
+}
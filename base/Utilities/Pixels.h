@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Utilities {
+	class Pixels final
+	{
+	public:
+
+		// Expands tightly packed RGB (3 bytes per pixel) into RGBA with an opaque alpha channel.
+		static void ExpandRgbToRgba(const unsigned char* rgb, unsigned char* rgba, size_t pixelCount) noexcept;
+
+		// Generic expansion for 1 to 4 channel images: grey (1) and grey + alpha (2) are replicated into RGB,
+		// alpha is opaque unless the source has one.
+		static void ExpandToRgba(const unsigned char* src, int channels, unsigned char* rgba, size_t pixelCount) noexcept;
+
+		// 2x2 box filter of an RGBA image into the next mip level (max(1, width / 2) x max(1, height / 2)).
+		static void HalveRgba(const unsigned char* src, uint32_t width, uint32_t height, unsigned char* dst) noexcept;
+	};
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Utilities {
+	class Sha256 final
+	{
+	public:
+
+		using Digest = std::array<uint8_t, 32>;
+
+		// SHA-256 (FIPS 180-4) of a byte range, for content comparisons where a collision must not happen in practice.
+		static Digest Bytes(const void* data, size_t size) noexcept;
+	};
+}
@@ -0,0 +1,57 @@
+#include "Utilities/ThreadPool.h"
+#include <algorithm>
+
+namespace Utilities {
+
+	ThreadPool::ThreadPool(const unsigned threadCount)
+	{
+		// hardware_concurrency() may report 0 when it cannot tell.
+		const unsigned count = std::max(threadCount, 1u);
+
+		threads_.reserve(count);
+
+		for (unsigned i = 0; i != count; ++i)
+		{
+			threads_.emplace_back([this]() { Run(); });
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+
+		condition_.notify_all();
+
+		for (auto& thread : threads_)
+		{
+			thread.join();
+		}
+	}
+
+	void ThreadPool::Run()
+	{
+		for (;;)
+		{
+			std::function<void()> task;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				condition_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+
+				if (tasks_.empty())
+				{
+					return;
+				}
+
+				task = std::move(tasks_.front());
+				tasks_.pop();
+			}
+
+			task();
+		}
+	}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Utilities {
+
+	// Fixed set of worker threads running submitted tasks in order. Results and exceptions come back through
+	// the returned futures; the destructor finishes every queued task before joining the workers.
+	class ThreadPool final
+	{
+	public:
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool(ThreadPool&&) = delete;
+		ThreadPool& operator = (const ThreadPool&) = delete;
+		ThreadPool& operator = (ThreadPool&&) = delete;
+
+		explicit ThreadPool(unsigned threadCount = std::thread::hardware_concurrency());
+		~ThreadPool();
+
+		size_t ThreadCount() const { return threads_.size(); }
+
+		template <class Task>
+		std::future<std::invoke_result_t<std::decay_t<Task>>> Submit(Task&& task)
+		{
+			using Result = std::invoke_result_t<std::decay_t<Task>>;
+
+			auto packagedTask = std::make_shared<std::packaged_task<Result()>>(std::forward<Task>(task));
+			auto future = packagedTask->get_future();
+
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				tasks_.emplace([packagedTask]() { (*packagedTask)(); });
+			}
+
+			condition_.notify_one();
+			return future;
+		}
+
+	private:
+
+		void Run();
+
+		std::vector<std::thread> threads_;
+		std::queue<std::function<void()>> tasks_;
+		std::mutex mutex_;
+		std::condition_variable condition_;
+		bool stopping_{};
+	};
+
+}
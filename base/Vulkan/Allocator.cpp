@@ -0,0 +1,542 @@
+#include "Vulkan/Allocator.h"
+#include "Vulkan/Device.h"
+#include "Vulkan/HostAllocator.h"
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace vk {
+
+	namespace
+	{
+		const VkDeviceSize DefaultBlockSize = VkDeviceSize(64) << 20;
+		const uint32_t MinOrder = 8; // 256 bytes, the smallest node handed out.
+
+		uint32_t Log2Ceil(VkDeviceSize value)
+		{
+			uint32_t order = 0;
+
+			while ((VkDeviceSize(1) << order) < value)
+			{
+				++order;
+			}
+
+			return order;
+		}
+
+		uint32_t Log2Floor(VkDeviceSize value)
+		{
+			uint32_t order = 0;
+
+			while ((VkDeviceSize(2) << order) <= value)
+			{
+				++order;
+			}
+
+			return order;
+		}
+	}
+
+	// A buddy allocator over one VkDeviceMemory. Node offsets of order n are multiples of 2^n.
+	struct Allocator::Block
+	{
+		PoolKey Pool;
+		VkDeviceMemory Memory{};
+		void* Mapped{};
+		uint32_t MemoryType{};
+		uint32_t MaxOrder{};
+		std::vector<std::set<VkDeviceSize>> Free; // Free node offsets, per order.
+		std::unordered_map<VkDeviceSize, uint32_t> Used; // Order of each allocated node.
+
+		bool IsEmpty() const { return !Free[MaxOrder].empty(); }
+
+		bool TryAllocate(const uint32_t order, VkDeviceSize& offset)
+		{
+			uint32_t available = order;
+
+			while (available <= MaxOrder && Free[available].empty())
+			{
+				++available;
+			}
+
+			if (available > MaxOrder)
+			{
+				return false;
+			}
+
+			offset = *Free[available].begin();
+			Free[available].erase(Free[available].begin());
+
+			// Split down to the requested order, keeping the lower half.
+			while (available != order)
+			{
+				--available;
+				Free[available].insert(offset + (VkDeviceSize(1) << available));
+			}
+
+			Used[offset] = order;
+			return true;
+		}
+
+		void Release(VkDeviceSize offset)
+		{
+			const auto used = Used.find(offset);
+			uint32_t order = used->second;
+
+			Used.erase(used);
+
+			// Merge with the buddy for as long as it is free too.
+			while (order != MaxOrder)
+			{
+				const VkDeviceSize buddy = offset ^ (VkDeviceSize(1) << order);
+				const auto free = Free[order].find(buddy);
+
+				if (free == Free[order].end())
+				{
+					break;
+				}
+
+				Free[order].erase(free);
+				offset = std::min(offset, buddy);
+				++order;
+			}
+
+			Free[order].insert(offset);
+		}
+	};
+
+	Allocator::Allocator(const class Device& device) :
+		device_(device)
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(device.PhysicalDevice(), &properties);
+		vkGetPhysicalDeviceMemoryProperties(device.PhysicalDevice(), &memoryProperties_);
+
+		bufferImageGranularity_ = properties.limits.bufferImageGranularity;
+		stats_.resize(memoryProperties_.memoryTypeCount);
+		heapBytes_.resize(memoryProperties_.memoryHeapCount);
+		heapPeakBytes_.resize(memoryProperties_.memoryHeapCount);
+	}
+
+	Allocator::~Allocator()
+	{
+		for (auto& pool : pools_)
+		{
+			for (auto& block : pool.second)
+			{
+				FreeDeviceMemory(block->Memory, block->MemoryType, VkDeviceSize(1) << block->MaxOrder);
+			}
+		}
+	}
+
+	Allocator::Allocation Allocator::Allocate(
+		const VkMemoryRequirements& requirements,
+		const VkMemoryPropertyFlags propertyFlags,
+		const VkMemoryAllocateFlags allocateFlags,
+		const bool optimalTiling,
+		const MemoryCategory category,
+		const VkImage dedicatedImage)
+	{
+		const uint32_t memoryType = FindMemoryType(requirements.memoryTypeBits, propertyFlags);
+		const VkDeviceSize blockSize = BlockSize(memoryType);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		Allocation allocation;
+		allocation.MemoryType = memoryType;
+		allocation.Category = category;
+
+		const bool lazilyAllocated = (memoryProperties_.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) != 0;
+
+		const VkDeviceSize size = std::max(requirements.size, requirements.alignment);
+		const uint32_t order = std::max(MinOrder, Log2Ceil(size));
+
+		// Big requests just past a power of two would leave up to half their node unused, those are cheaper as
+		// their own allocation than as internal fragmentation.
+		const VkDeviceSize waste = (VkDeviceSize(1) << order) - size;
+		const bool wasteful = size >= blockSize / 8 && waste > (VkDeviceSize(1) << order) / 4;
+
+		allocation.RequestedSize = requirements.size;
+
+		if (dedicatedImage != nullptr || lazilyAllocated || wasteful || size > blockSize / 2)
+		{
+			allocation.Memory = AllocateDeviceMemory(requirements.size, memoryType, allocateFlags, category, dedicatedImage, &allocation.Mapped);
+			allocation.Size = requirements.size;
+
+			++stats_[memoryType].DedicatedCount;
+			AddAllocation(allocation);
+
+			return allocation;
+		}
+
+		// Without a granularity constraint linear and optimal resources can share blocks.
+		const PoolKey pool(memoryType, optimalTiling && bufferImageGranularity_ > 1, allocateFlags);
+		auto& blocks = pools_[pool];
+		Block* owner = nullptr;
+
+		for (auto& block : blocks)
+		{
+			if (block->TryAllocate(order, allocation.Offset))
+			{
+				owner = block.get();
+				break;
+			}
+		}
+
+		if (owner == nullptr)
+		{
+			std::unique_ptr<Block> block(new Block());
+			block->Pool = pool;
+			block->MemoryType = memoryType;
+			block->MaxOrder = Log2Floor(blockSize);
+			block->Free.resize(block->MaxOrder + 1);
+			block->Free[block->MaxOrder].insert(0);
+			block->Memory = AllocateDeviceMemory(blockSize, memoryType, allocateFlags, category, nullptr, &block->Mapped);
+
+			block->TryAllocate(order, allocation.Offset);
+			owner = block.get();
+			blocks.push_back(std::move(block));
+
+			++stats_[memoryType].BlockCount;
+		}
+
+		allocation.Memory = owner->Memory;
+		allocation.Size = VkDeviceSize(1) << order;
+		allocation.Mapped = owner->Mapped != nullptr ? static_cast<char*>(owner->Mapped) + allocation.Offset : nullptr;
+		allocation.Owner = owner;
+
+		AddAllocation(allocation);
+
+		return allocation;
+	}
+
+	void Allocator::Free(const Allocation& allocation)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		auto& stats = stats_[allocation.MemoryType];
+		--stats.AllocationCount;
+		stats.AllocatedBytes -= allocation.Size;
+		stats.RequestedBytes -= allocation.RequestedSize;
+
+		auto& categoryStats = categoryStats_[static_cast<size_t>(allocation.Category)];
+		--categoryStats.AllocationCount;
+		categoryStats.AllocatedBytes -= allocation.Size;
+		categoryStats.RequestedBytes -= allocation.RequestedSize;
+
+		if (allocation.Owner == nullptr)
+		{
+			--stats.DedicatedCount;
+			FreeDeviceMemory(allocation.Memory, allocation.MemoryType, allocation.Size);
+			return;
+		}
+
+		Block* const owner = allocation.Owner;
+		owner->Release(allocation.Offset);
+
+		if (!owner->IsEmpty())
+		{
+			return;
+		}
+
+		// Keep one empty block per pool around so that a free/allocate cycle does not hit the driver.
+		auto& blocks = pools_[owner->Pool];
+
+		const bool otherEmpty = std::any_of(blocks.begin(), blocks.end(), [owner](const std::unique_ptr<Block>& block)
+			{
+				return block.get() != owner && block->IsEmpty();
+			});
+
+		if (otherEmpty)
+		{
+			FreeDeviceMemory(owner->Memory, owner->MemoryType, VkDeviceSize(1) << owner->MaxOrder);
+			--stats.BlockCount;
+
+			blocks.erase(std::find_if(blocks.begin(), blocks.end(), [owner](const std::unique_ptr<Block>& block) { return block.get() == owner; }));
+		}
+	}
+
+	uint32_t Allocator::FindMemoryType(const uint32_t typeFilter, const VkMemoryPropertyFlags propertyFlags) const
+	{
+		for (uint32_t i = 0; i != memoryProperties_.memoryTypeCount; ++i)
+		{
+			if ((typeFilter & (1 << i)) && (memoryProperties_.memoryTypes[i].propertyFlags & propertyFlags) == propertyFlags)
+			{
+				return i;
+			}
+		}
+
+		throw std::runtime_error("failed to find suitable memory type");
+	}
+
+	bool Allocator::HasMemoryType(const uint32_t typeFilter, const VkMemoryPropertyFlags propertyFlags) const
+	{
+		for (uint32_t i = 0; i != memoryProperties_.memoryTypeCount; ++i)
+		{
+			if ((typeFilter & (1 << i)) && (memoryProperties_.memoryTypes[i].propertyFlags & propertyFlags) == propertyFlags)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	Allocator::Statistics Allocator::Stats() const
+	{
+		Statistics total;
+
+		for (uint32_t heap = 0; heap != memoryProperties_.memoryHeapCount; ++heap)
+		{
+			const auto stats = HeapStats(heap);
+			total.BlockCount += stats.BlockCount;
+			total.DedicatedCount += stats.DedicatedCount;
+			total.AllocationCount += stats.AllocationCount;
+			total.BlockBytes += stats.BlockBytes;
+			total.AllocatedBytes += stats.AllocatedBytes;
+			total.RequestedBytes += stats.RequestedBytes;
+		}
+
+		return total;
+	}
+
+	Allocator::Statistics Allocator::HeapStats(const uint32_t heapIndex) const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		Statistics total;
+
+		for (uint32_t type = 0; type != memoryProperties_.memoryTypeCount; ++type)
+		{
+			if (memoryProperties_.memoryTypes[type].heapIndex != heapIndex)
+			{
+				continue;
+			}
+
+			const auto& stats = stats_[type];
+			total.BlockCount += stats.BlockCount;
+			total.DedicatedCount += stats.DedicatedCount;
+			total.AllocationCount += stats.AllocationCount;
+			total.BlockBytes += stats.BlockBytes;
+			total.AllocatedBytes += stats.AllocatedBytes;
+			total.RequestedBytes += stats.RequestedBytes;
+		}
+
+		return total;
+	}
+
+	Allocator::CategoryStatistics Allocator::CategoryStats(const MemoryCategory category) const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		return categoryStats_[static_cast<size_t>(category)];
+	}
+
+	std::vector<Allocator::HeapBudget> Allocator::Budgets() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		return QueryBudgets();
+	}
+
+	std::string Allocator::StatisticsJson() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		std::ostringstream json;
+		json << "{\n\t\"heaps\": [";
+
+		const auto budgets = QueryBudgets();
+
+		for (size_t heap = 0; heap != budgets.size(); ++heap)
+		{
+			const auto& budget = budgets[heap];
+			const bool deviceLocal = (memoryProperties_.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+
+			json << (heap == 0 ? "\n" : ",\n")
+				<< "\t\t{ \"index\": " << heap
+				<< ", \"deviceLocal\": " << (deviceLocal ? "true" : "false")
+				<< ", \"size\": " << budget.HeapSize
+				<< ", \"usage\": " << budget.Usage
+				<< ", \"budget\": " << budget.Budget
+				<< ", \"blockBytes\": " << budget.BlockBytes
+				<< ", \"peakBlockBytes\": " << budget.PeakBlockBytes << " }";
+		}
+
+		json << "\n\t],\n\t\"categories\": {";
+
+		for (size_t i = 0; i != categoryStats_.size(); ++i)
+		{
+			const auto& stats = categoryStats_[i];
+
+			json << (i == 0 ? "\n" : ",\n")
+				<< "\t\t\"" << ToString(static_cast<MemoryCategory>(i)) << "\": { "
+				<< "\"allocations\": " << stats.AllocationCount
+				<< ", \"bytes\": " << stats.AllocatedBytes
+				<< ", \"requestedBytes\": " << stats.RequestedBytes
+				<< ", \"peakBytes\": " << stats.PeakBytes << " }";
+		}
+
+		// Internal fragmentation: bytes handed out beyond what was asked for, summed over all memory types.
+		VkDeviceSize allocatedBytes = 0;
+		VkDeviceSize requestedBytes = 0;
+
+		for (const auto& stats : stats_)
+		{
+			allocatedBytes += stats.AllocatedBytes;
+			requestedBytes += stats.RequestedBytes;
+		}
+
+		json << "\n\t},\n\t\"fragmentation\": { "
+			<< "\"allocatedBytes\": " << allocatedBytes
+			<< ", \"requestedBytes\": " << requestedBytes
+			<< ", \"wastedBytes\": " << (allocatedBytes - requestedBytes)
+			<< ", \"wastedRatio\": " << (allocatedBytes != 0 ? double(allocatedBytes - requestedBytes) / double(allocatedBytes) : 0.0) << " }\n}\n";
+
+		return json.str();
+	}
+
+	VkDeviceMemory Allocator::AllocateDeviceMemory(
+		const VkDeviceSize size,
+		const uint32_t memoryType,
+		const VkMemoryAllocateFlags allocateFlags,
+		const MemoryCategory category,
+		const VkImage dedicatedImage,
+		void** const mapped)
+	{
+		const uint32_t heap = memoryProperties_.memoryTypes[memoryType].heapIndex;
+		const auto budget = QueryBudgets()[heap];
+
+		// Going over budget is allowed, but the driver may start evicting or paging memory.
+		if (budget.Usage + size > budget.Budget)
+		{
+			std::cerr << "WARNING: allocating " << (size >> 20) << " MB for " << ToString(category) << " takes memory heap " << heap
+				<< " over its budget (" << (budget.Usage >> 20) << " MB used of " << (budget.Budget >> 20) << " MB)" << std::endl;
+		}
+
+		VkMemoryDedicatedAllocateInfo dedicatedInfo = {};
+		dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+		dedicatedInfo.image = dedicatedImage;
+
+		VkMemoryAllocateFlagsInfo flagsInfo = {};
+		flagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+		flagsInfo.pNext = dedicatedImage != nullptr ? &dedicatedInfo : nullptr;
+		flagsInfo.flags = allocateFlags;
+
+		VkMemoryAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.pNext = &flagsInfo;
+		allocInfo.allocationSize = size;
+		allocInfo.memoryTypeIndex = memoryType;
+
+		VkDeviceMemory memory;
+		Check(vkAllocateMemory(device_.Handle(), &allocInfo, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_DEVICE_MEMORY), &memory),
+			"allocate memory");
+
+		*mapped = nullptr;
+
+		if (memoryProperties_.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+		{
+			Check(vkMapMemory(device_.Handle(), memory, 0, VK_WHOLE_SIZE, 0, mapped),
+				"map memory");
+		}
+
+		stats_[memoryType].BlockBytes += size;
+		heapBytes_[heap] += size;
+		heapPeakBytes_[heap] = std::max(heapPeakBytes_[heap], heapBytes_[heap]);
+
+		return memory;
+	}
+
+	void Allocator::FreeDeviceMemory(const VkDeviceMemory memory, const uint32_t memoryType, const VkDeviceSize size)
+	{
+		// Freeing implicitly unmaps.
+		vkFreeMemory(device_.Handle(), memory, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_DEVICE_MEMORY));
+
+		stats_[memoryType].BlockBytes -= size;
+		heapBytes_[memoryProperties_.memoryTypes[memoryType].heapIndex] -= size;
+	}
+
+	VkDeviceSize Allocator::BlockSize(const uint32_t memoryType) const
+	{
+		// Small heaps (e.g. the 256 MB host visible device local heap) would be exhausted by a few blocks.
+		const auto heapSize = memoryProperties_.memoryHeaps[memoryProperties_.memoryTypes[memoryType].heapIndex].size;
+		const auto size = std::min(DefaultBlockSize, heapSize / 8);
+
+		return VkDeviceSize(1) << std::max(MinOrder, Log2Floor(size));
+	}
+
+	void Allocator::AddAllocation(const Allocation& allocation)
+	{
+		auto& stats = stats_[allocation.MemoryType];
+		++stats.AllocationCount;
+		stats.AllocatedBytes += allocation.Size;
+		stats.RequestedBytes += allocation.RequestedSize;
+
+		auto& categoryStats = categoryStats_[static_cast<size_t>(allocation.Category)];
+		++categoryStats.AllocationCount;
+		categoryStats.AllocatedBytes += allocation.Size;
+		categoryStats.RequestedBytes += allocation.RequestedSize;
+		categoryStats.PeakBytes = std::max(categoryStats.PeakBytes, categoryStats.AllocatedBytes);
+	}
+
+	std::vector<Allocator::HeapBudget> Allocator::QueryBudgets() const
+	{
+		const uint32_t heapCount = memoryProperties_.memoryHeapCount;
+		std::vector<HeapBudget> budgets(heapCount);
+
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = {};
+		budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+		if (device_.HasMemoryBudget())
+		{
+			VkPhysicalDeviceMemoryProperties2 properties = {};
+			properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+			properties.pNext = &budgetProperties;
+
+			vkGetPhysicalDeviceMemoryProperties2(device_.PhysicalDevice(), &properties);
+		}
+
+		for (uint32_t heap = 0; heap != heapCount; ++heap)
+		{
+			auto& budget = budgets[heap];
+			budget.HeapSize = memoryProperties_.memoryHeaps[heap].size;
+			budget.BlockBytes = heapBytes_[heap];
+			budget.PeakBlockBytes = heapPeakBytes_[heap];
+
+			if (device_.HasMemoryBudget())
+			{
+				budget.Usage = budgetProperties.heapUsage[heap];
+				budget.Budget = budgetProperties.heapBudget[heap];
+			}
+			else
+			{
+				budget.Usage = heapBytes_[heap];
+				budget.Budget = budget.HeapSize / 10 * 8;
+			}
+		}
+
+		return budgets;
+	}
+
+	const char* ToString(const MemoryCategory category)
+	{
+		switch (category)
+		{
+		case MemoryCategory::Other: return "Other";
+		case MemoryCategory::Mesh: return "Mesh";
+		case MemoryCategory::Uniform: return "Uniform";
+		case MemoryCategory::Staging: return "Staging";
+		case MemoryCategory::Texture: return "Texture";
+		case MemoryCategory::Environment: return "Environment";
+		case MemoryCategory::RenderTarget: return "RenderTarget";
+		case MemoryCategory::ShadowMap: return "ShadowMap";
+		default: return "Unknown";
+		}
+	}
+
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "Vulkan/VkConfig.h"
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace vk
+{
+	class Device;
+
+	// What an allocation is used for, only tracked for statistics.
+	enum class MemoryCategory : uint32_t
+	{
+		Other,
+		Mesh,
+		Uniform,
+		Staging,
+		Texture,
+		Environment,
+		RenderTarget,
+		ShadowMap,
+
+		Count
+	};
+
+	const char* ToString(MemoryCategory category);
+
+	// Sub-allocates buffer and image memory out of large per memory type blocks, so the number of
+	// vkAllocateMemory calls stays far below maxMemoryAllocationCount. Blocks are split with a buddy allocator,
+	// whose power of two nodes are naturally aligned to any smaller alignment. Linear and optimal tiling
+	// resources are kept in separate blocks when bufferImageGranularity requires it. Images the driver prefers to
+	// own their memory, requests bigger than half a block, requests of at least an eighth of a block that would
+	// waste over a quarter of their buddy node (a 22 MB texture would otherwise take 32 MB) and lazily allocated
+	// memory (committed by the driver per allocation, only ever used by transient attachments) get a dedicated
+	// allocation. The statistics track the requested bytes next to the rounded ones to expose internal
+	// fragmentation. Host visible blocks are mapped once for their whole lifetime. Allocations are tagged with a
+	// MemoryCategory for statistics, and a warning is printed when a new block would take a heap over its
+	// VK_EXT_memory_budget budget. Thread safe.
+	class Allocator final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(Allocator)
+
+		struct Block; // Defined in Allocator.cpp.
+
+		struct Allocation
+		{
+			VkDeviceMemory Memory{};
+			VkDeviceSize Offset{};
+			VkDeviceSize Size{};
+			VkDeviceSize RequestedSize{}; // Before rounding to the buddy node size.
+			void* Mapped{}; // Null unless host visible, already offset.
+			uint32_t MemoryType{};
+			MemoryCategory Category{};
+			Block* Owner{}; // Null for dedicated allocations.
+		};
+
+		struct Statistics
+		{
+			uint32_t BlockCount{};
+			uint32_t DedicatedCount{};
+			uint32_t AllocationCount{};
+			VkDeviceSize BlockBytes{}; // Obtained from vkAllocateMemory, dedicated allocations included.
+			VkDeviceSize AllocatedBytes{}; // Handed out, after rounding to the buddy node size.
+			VkDeviceSize RequestedBytes{}; // Asked for, AllocatedBytes - RequestedBytes is lost to rounding.
+		};
+
+		struct CategoryStatistics
+		{
+			uint32_t AllocationCount{};
+			VkDeviceSize AllocatedBytes{};
+			VkDeviceSize RequestedBytes{};
+			VkDeviceSize PeakBytes{};
+		};
+
+		struct HeapBudget
+		{
+			VkDeviceSize HeapSize{};
+			VkDeviceSize Usage{}; // By the whole process, or by this allocator without VK_EXT_memory_budget.
+			VkDeviceSize Budget{}; // Usable before risking eviction, 80% of the heap without VK_EXT_memory_budget.
+			VkDeviceSize BlockBytes{}; // Obtained by this allocator.
+			VkDeviceSize PeakBlockBytes{};
+		};
+
+		explicit Allocator(const Device& device);
+		~Allocator();
+
+		// optimalTiling is true for images with VK_IMAGE_TILING_OPTIMAL. dedicatedImage, if given, is the
+		// image the allocation is dedicated to.
+		Allocation Allocate(
+			const VkMemoryRequirements& requirements,
+			VkMemoryPropertyFlags propertyFlags,
+			VkMemoryAllocateFlags allocateFlags,
+			bool optimalTiling,
+			MemoryCategory category,
+			VkImage dedicatedImage = nullptr);
+
+		void Free(const Allocation& allocation);
+
+		uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags propertyFlags) const;
+		bool HasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags propertyFlags) const;
+		const VkPhysicalDeviceMemoryProperties& MemoryProperties() const { return memoryProperties_; }
+
+		Statistics Stats() const;
+		Statistics HeapStats(uint32_t heapIndex) const;
+		CategoryStatistics CategoryStats(MemoryCategory category) const;
+
+		// One per memory heap, the usage and budget are queried from the driver on every call.
+		std::vector<HeapBudget> Budgets() const;
+
+		// Budgets, per category statistics and the bytes lost to buddy rounding as a JSON document.
+		std::string StatisticsJson() const;
+
+	private:
+
+		using PoolKey = std::tuple<uint32_t, bool, VkMemoryAllocateFlags>;
+
+		VkDeviceMemory AllocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, VkMemoryAllocateFlags allocateFlags, MemoryCategory category, VkImage dedicatedImage, void** mapped);
+		void FreeDeviceMemory(VkDeviceMemory memory, uint32_t memoryType, VkDeviceSize size);
+		VkDeviceSize BlockSize(uint32_t memoryType) const;
+
+		void AddAllocation(const Allocation& allocation);
+		std::vector<HeapBudget> QueryBudgets() const; // mutex_ must be held.
+
+		const class Device& device_;
+		VkPhysicalDeviceMemoryProperties memoryProperties_{};
+		VkDeviceSize bufferImageGranularity_{};
+
+		mutable std::mutex mutex_;
+		std::map<PoolKey, std::vector<std::unique_ptr<Block>>> pools_;
+		std::vector<Statistics> stats_; // Per memory type.
+		std::vector<VkDeviceSize> heapBytes_;
+		std::vector<VkDeviceSize> heapPeakBytes_;
+		std::array<CategoryStatistics, static_cast<size_t>(MemoryCategory::Count)> categoryStats_{};
+	};
+
+}
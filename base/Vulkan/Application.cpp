@@ -1,32 +1,38 @@
 #include "Vulkan/Application.h"
+#include "Vulkan/Allocator.h"
 #include "Vulkan/Buffer.h"
 #include "Vulkan/CommandPool.h"
 #include "Vulkan/CommandBuffers.h"
 #include "Vulkan/DebugUtilsMessenger.h"
+#include "Vulkan/DeletionQueue.h"
 #include "Vulkan/DepthBuffer.h"
 #include "Vulkan/Device.h"
 #include "Vulkan/Fence.h"
 #include "Vulkan/FrameBuffer.h"
 #include "Vulkan/GraphicsPipeline.h"
+#include "Vulkan/HostAllocator.h"
 #include "Vulkan/Instance.h"
 #include "Vulkan/PipelineLayout.h"
 #include "Vulkan/RenderPass.h"
 #include "Vulkan/Semaphore.h"
+#include "Vulkan/ShaderReloader.h"
 #include "Vulkan/Surface.h"
 #include "Vulkan/SwapChain.h"
+#include "Vulkan/UniformRing.h"
+#include "Vulkan/UploadManager.h"
 #include "Vulkan/Window.h"
 #include "Assets/Model.h"
 #include "Assets/Scene.h"
 #include "Assets/UniformBuffer.h"
 #include <stdexcept>
 #include <array>
+#include <fstream>
 #include <iostream>
 
 namespace Assets
 {
 	class Scene;
 	class UniformBufferObject;
-	class UniformBuffer;
 	class UserInterface;
 }
 
@@ -38,16 +44,19 @@ namespace vk {
 			? std::vector<const char*>{"VK_LAYER_KHRONOS_validation"}
 		: std::vector<const char*>();
 
+		hostAllocator_.reset(new HostAllocator(PoolHostAllocations));
 		window_.reset(new class Window(windowConfig));
-		instance_.reset(new Instance(*window_, validationLayers, VK_API_VERSION_1_2));
+		instance_.reset(new Instance(*window_, *hostAllocator_, validationLayers, VK_API_VERSION_1_2));
 		debugUtilsMessenger_.reset(enableValidationLayers ? new DebugUtilsMessenger(*instance_, VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT) : nullptr);
 		surface_.reset(new Surface(*instance_));
+		shaderReloader_.reset(new class ShaderReloader({ "../shaders" }, MAX_FRAMES_IN_FLIGHT));
 	}
 
 	Application::~Application()
 	{
+		shaderReloader_.reset();
 		Application::DeleteSwapChain();
-		uniformBuffers_.clear();
+		uniformRing_.reset();
 		inFlightFences_.clear();
 		renderFinishedSemaphores_.clear();
 		imageAvailableSemaphores_.clear();
@@ -57,6 +66,7 @@ namespace vk {
 		debugUtilsMessenger_.reset();
 		instance_.reset();
 		window_.reset();
+		hostAllocator_.reset();
 	}
 
 	const std::vector<VkExtensionProperties>& Application::Extensions() const
@@ -87,8 +97,12 @@ namespace vk {
 			VK_KHR_SWAPCHAIN_EXTENSION_NAME
 		};
 
+		VkPhysicalDeviceFeatures supportedFeatures = {};
+		vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
 		VkPhysicalDeviceFeatures deviceFeatures = {};
 		deviceFeatures.samplerAnisotropy = VK_TRUE;
+		deviceFeatures.fillModeNonSolid = supportedFeatures.fillModeNonSolid; // Wireframe view, optional.
 
 		SetPhysicalDevice(physicalDevice, requiredExtensions, deviceFeatures, nullptr);
 		OnDeviceSet();
@@ -116,6 +130,12 @@ namespace vk {
 		window_->OnScroll = [this](const double xoffset, const double yoffset) { OnScroll(xoffset, yoffset); };
 		window_->Run();
 		device_->WaitIdle();
+
+		// Peaks and final usage per category and heap, for comparing runs.
+		std::ofstream("memory_statistics.json") << device_->Allocator().StatisticsJson();
+
+		// Nothing may rebuild against the application once the loop has ended.
+		shaderReloader_->Clear();
 	}
 
 	void Application::SetPhysicalDevice(
@@ -143,7 +163,7 @@ namespace vk {
 		swapChain_.reset(new class SwapChain(*device_, presentMode_));
 		depthBuffer_.reset(new class DepthBuffer(*commandPool_, swapChain_->Extent(), 1));
 
-		graphicsPipeline_.reset(new class GraphicsPipeline(*swapChain_, *depthBuffer_, uniformBuffers_, GetScene(), isWireFrame_));
+		graphicsPipeline_.reset(new class GraphicsPipeline(*swapChain_, *depthBuffer_, UniformBufferInfo(), GetScene()));
 
 		for (const auto& imageView : swapChain_->ImageViews())
 		{
@@ -160,8 +180,9 @@ namespace vk {
 			imageAvailableSemaphores_.emplace_back(*device_);
 			renderFinishedSemaphores_.emplace_back(*device_);
 			inFlightFences_.emplace_back(*device_, true);
-			uniformBuffers_.emplace_back(*device_);
 		}
+
+		uniformRing_.reset(new class UniformRing(*device_, UniformRingFrameSize, MAX_FRAMES_IN_FLIGHT));
 	}
 
 	void Application::DeleteSwapChain()
@@ -184,10 +205,22 @@ namespace vk {
 
 		inFlightFence.Wait(noTimeout);
 
+		// Whatever the driver allocated on the host since the previous frame counts as its churn.
+		hostAllocator_->BeginFrame();
+
+		// The frames that could still use a replaced pipeline are the ones in flight.
+		shaderReloader_->Update();
+
+		// Objects retired while this frame was last in flight are no longer referenced.
+		device_->DeletionQueue().BeginFrame(static_cast<uint32_t>(inFlightFences_.size()));
+
+		// This frame's uniform data can be overwritten now that the GPU is done with it.
+		uniformRing_->BeginFrame(static_cast<uint32_t>(currentFrame_));
+
 		uint32_t imageIndex;
 		auto result = vkAcquireNextImageKHR(device_->Handle(), swapChain_->Handle(), noTimeout, imageAvailableSemaphore, nullptr, &imageIndex);
 
-		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || isWireFrame_ != graphicsPipeline_->IsWireFrame())
+		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
 		{
 			RecreateSwapChain();
 			return;
@@ -200,11 +233,15 @@ namespace vk {
 
 		const auto commandBuffer = commandBuffers_->Begin(imageIndex);
 
-		UpdateUniformBuffer(imageIndex);
+		UpdateUniformBuffer();
 
 		Render(commandBuffer, imageIndex);
 		commandBuffers_->End(imageIndex);
 
+		// Uploads recorded before or while rendering must precede the frame on the queue, finished
+		// asynchronous ones are handed over here too.
+		device_->UploadManager().Submit();
+
 		VkSubmitInfo submitInfo = {};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
@@ -271,41 +308,38 @@ namespace vk {
 		{
 			const auto& scene = GetScene();
 
-			VkDescriptorSet descriptorSets[] = { graphicsPipeline_->DescriptorSet(imageIndex) };
+			VkDescriptorSet descriptorSets[] = { graphicsPipeline_->DescriptorSet() };
 			VkBuffer vertexBuffers[] = { scene.VertexBuffer().Handle() };
 			const VkBuffer indexBuffer = scene.IndexBuffer().Handle();
 			VkDeviceSize offsets[] = { 0 };
 
-			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline_->Handle());
-			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline_->PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline_->Handle(isWireFrame_));
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline_->PipelineLayout().Handle(), 0, 1, descriptorSets, 1, &uniformBufferOffset_);
 			vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
 			vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
 
-			uint32_t vertexOffset = 0;
-			uint32_t indexOffset = 0;
-
-			for (const auto& model : scene.Models())
+			for (const auto& range : scene.DrawRanges())
 			{
-				const auto vertexCount = static_cast<uint32_t>(model.NumberOfVertices());
-				const auto indexCount = static_cast<uint32_t>(model.NumberOfIndices());
-
-				vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexOffset, vertexOffset, 0);
-
-				vertexOffset += vertexCount;
-				indexOffset += indexCount;
+				vkCmdDrawIndexed(commandBuffer, range.IndexCount, 1, range.FirstIndex, range.VertexOffset, 0);
 			}
 		}
 		vkCmdEndRenderPass(commandBuffer);
 	}
 
-	void Application::UpdateUniformBuffer(const uint32_t imageIndex)
+	VkDescriptorBufferInfo Application::UniformBufferInfo() const
+	{
+		return uniformRing_->Descriptor(sizeof(Assets::UniformBufferObject));
+	}
+
+	void Application::UpdateUniformBuffer()
 	{
-		uniformBuffers_[imageIndex].SetValue(GetUniformBufferObject(swapChain_->Extent()));
+		uniformBufferOffset_ = uniformRing_->Push(GetUniformBufferObject(swapChain_->Extent()));
 	}
 
 	void Application::RecreateSwapChain()
 	{
 		device_->WaitIdle();
+		shaderReloader_->Drain();
 		DeleteSwapChain();
 		CreateSwapChain();
 	}
@@ -9,7 +9,6 @@
 namespace Assets {
 	class Scene;
 	class UniformBufferObject;
-	class UniformBuffer;
 }
 
 namespace vk {
@@ -38,9 +37,14 @@ namespace vk {
 		const class Device& Device() const { return *device_; }
 		class CommandPool& CommandPool() { return *commandPool_; }
 		const class DepthBuffer& DepthBuffer() const { return *depthBuffer_; }
-		const std::vector<Assets::UniformBuffer>& UniformBuffers() const { return uniformBuffers_; }
+		class UniformRing& UniformRing() { return *uniformRing_; }
+		// The per frame UniformBufferObject lives in UniformRing(), bind it as a dynamic uniform buffer with
+		// UniformBufferInfo() and pass UniformBufferOffset() when binding the descriptor set.
+		VkDescriptorBufferInfo UniformBufferInfo() const;
+		uint32_t UniformBufferOffset() const { return uniformBufferOffset_; }
 		const class GraphicsPipeline& GraphicsPipeline() const { return *graphicsPipeline_; }
 		const class FrameBuffer& SwapChainFrameBuffer(const size_t i) const { return swapChainFramebuffers_[i]; }
+		class ShaderReloader& ShaderReloader() { return *shaderReloader_; }
 
 		virtual const Assets::Scene& GetScene() const = 0;
 		//virtual const Assets::Scene& GetSkybox() const = 0;
@@ -64,21 +68,23 @@ namespace vk {
 		virtual void OnMouseButton(int button, int action, int mods) { }
 		virtual void OnScroll(double xoffset, double yoffset) { }
 
-		bool isWireFrame_{};
+		bool isWireFrame_{}; // Picks the pipeline variant per frame, toggling needs no rebuild.
 
 	private:
-		void UpdateUniformBuffer(uint32_t imageIndex);
+		void UpdateUniformBuffer();
 		void RecreateSwapChain();
 
 		const VkPresentModeKHR presentMode_;
 
+		std::unique_ptr<class HostAllocator> hostAllocator_;
 		std::unique_ptr<class Window> window_;
 		std::unique_ptr<class Instance> instance_;
 		std::unique_ptr<class DebugUtilsMessenger> debugUtilsMessenger_;
 		std::unique_ptr<class Surface> surface_;
 		std::unique_ptr<class Device> device_;
 		std::unique_ptr<class SwapChain> swapChain_;
-		std::vector<Assets::UniformBuffer> uniformBuffers_;
+		std::unique_ptr<class UniformRing> uniformRing_;
+		uint32_t uniformBufferOffset_{};
 		std::unique_ptr<class DepthBuffer> depthBuffer_;
 		std::unique_ptr<class GraphicsPipeline> graphicsPipeline_;
 		std::vector<class FrameBuffer> swapChainFramebuffers_;
@@ -87,9 +93,12 @@ namespace vk {
 		std::vector<class Semaphore> imageAvailableSemaphores_;
 		std::vector<class Semaphore> renderFinishedSemaphores_;
 		std::vector<class Fence> inFlightFences_;
+		std::unique_ptr<class ShaderReloader> shaderReloader_;
 		//std::unique_ptr<class Assets::UserInterface> ui_;
 
 		size_t currentFrame_{};
 		const int MAX_FRAMES_IN_FLIGHT = 2;
+		const VkDeviceSize UniformRingFrameSize = 64 * 1024;
+		const bool PoolHostAllocations = true;
 	};
 }
\ No newline at end of file
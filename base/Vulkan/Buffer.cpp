@@ -1,9 +1,30 @@
 #include "Vulkan/Buffer.h"
+#include "Vulkan/Device.h"
+#include "Vulkan/HostAllocator.h"
 #include "Vulkan/SingleTimeCommands.h"
 
 namespace vk {
+	namespace
+	{
+		MemoryCategory CategoryOf(const VkBufferUsageFlags usage)
+		{
+			if (usage & (VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT))
+			{
+				return MemoryCategory::Mesh;
+			}
+
+			if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+			{
+				return MemoryCategory::Uniform;
+			}
+
+			return usage == VK_BUFFER_USAGE_TRANSFER_SRC_BIT ? MemoryCategory::Staging : MemoryCategory::Other;
+		}
+	}
+
 	Buffer::Buffer(const class Device& device, const size_t size, const VkBufferUsageFlags usage) :
-		device_(device)
+		device_(device),
+		usage_(usage)
 	{
 		VkBufferCreateInfo bufferInfo = {};
 		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -11,7 +32,7 @@ namespace vk {
 		bufferInfo.usage = usage;
 		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-		Check(vkCreateBuffer(device.Handle(), &bufferInfo, nullptr, &buffer_),
+		Check(vkCreateBuffer(device.Handle(), &bufferInfo, device.HostAllocator().Callbacks(VK_OBJECT_TYPE_BUFFER), &buffer_),
 			"create buffer");
 	}
 
@@ -19,7 +40,7 @@ namespace vk {
 	{
 		if (buffer_ != nullptr)
 		{
-			vkDestroyBuffer(device_.Handle(), buffer_, nullptr);
+			vkDestroyBuffer(device_.Handle(), buffer_, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_BUFFER));
 			buffer_ = nullptr;
 		}
 	}
@@ -32,9 +53,9 @@ namespace vk {
 	DeviceMemory Buffer::AllocateMemory(const VkMemoryAllocateFlags allocateFlags, const VkMemoryPropertyFlags propertyFlags)
 	{
 		const auto requirements = GetMemoryRequirements();
-		DeviceMemory memory(device_, requirements.size, requirements.memoryTypeBits, allocateFlags, propertyFlags);
+		DeviceMemory memory(device_, device_.Allocator().Allocate(requirements, propertyFlags, allocateFlags, false, CategoryOf(usage_)));
 
-		Check(vkBindBufferMemory(device_.Handle(), buffer_, memory.Handle(), 0),
+		Check(vkBindBufferMemory(device_.Handle(), buffer_, memory.Handle(), memory.Offset()),
 			"bind buffer memory");
 
 		return memory;
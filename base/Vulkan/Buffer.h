@@ -16,6 +16,9 @@ namespace vk {
 
 		const class Device& Device() const { return device_; }
 
+		VkBufferUsageFlags Usage() const { return usage_; }
+
+		// Tagged with the memory category implied by the usage flags.
 		DeviceMemory AllocateMemory(VkMemoryPropertyFlags propertyFlags);
 		DeviceMemory AllocateMemory(VkMemoryAllocateFlags allocateFlags, VkMemoryPropertyFlags propertyFlags);
 		VkMemoryRequirements GetMemoryRequirements() const;
@@ -25,6 +28,7 @@ namespace vk {
 
 	private:
 		const class Device& device_;
+		const VkBufferUsageFlags usage_;
 
 		VULKAN_HANDLE(VkBuffer, buffer_)
 	};
@@ -4,7 +4,7 @@
 #include "Vulkan/CommandPool.h"
 #include "Vulkan/Device.h"
 #include "Vulkan/DeviceMemory.h"
-#include <cstring>
+#include "Vulkan/UploadManager.h"
 #include <memory>
 #include <string>
 #include <vector>
@@ -27,28 +27,24 @@ namespace vk
 			const std::vector<T>& content,
 			std::unique_ptr<Buffer>& buffer,
 			std::unique_ptr<DeviceMemory>& memory);
+
+		// Leaves the contents to the caller, e.g. several CopyToBuffer() calls at different offsets.
+		static void CreateDeviceBuffer(
+			CommandPool& commandPool,
+			const char* name,
+			VkBufferUsageFlags usage,
+			VkDeviceSize size,
+			std::unique_ptr<Buffer>& buffer,
+			std::unique_ptr<DeviceMemory>& memory);
 	};
 
 	template <class T>
 	void BufferUtil::CopyFromStagingBuffer(CommandPool& commandPool, Buffer& dstBuffer, const std::vector<T>& content)
 	{
-		const auto& device = commandPool.Device();
+		// Staged and recorded by the upload manager, the copy is submitted along with the rest of its batch.
 		const auto contentSize = sizeof(content[0]) * content.size();
 
-		// Create a temporary host-visible staging buffer.
-		auto stagingBuffer = std::make_unique<Buffer>(device, contentSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
-		auto stagingBufferMemory = stagingBuffer->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-		// Copy the host data into the staging buffer.
-		const auto data = stagingBufferMemory.Map(0, contentSize);
-		std::memcpy(data, content.data(), contentSize);
-		stagingBufferMemory.Unmap();
-
-		// Copy the staging buffer to the device buffer.
-		dstBuffer.CopyFrom(commandPool, *stagingBuffer, contentSize);
-
-		// Delete the buffer before the memory
-		stagingBuffer.reset();
+		commandPool.Device().UploadManager().CopyToBuffer(dstBuffer, content.data(), contentSize);
 	}
 
 	template <class T>
@@ -59,20 +55,32 @@ namespace vk
 		const std::vector<T>& content,
 		std::unique_ptr<Buffer>& buffer,
 		std::unique_ptr<DeviceMemory>& memory)
+	{
+		CreateDeviceBuffer(commandPool, name, usage, sizeof(content[0]) * content.size(), buffer, memory);
+		CopyFromStagingBuffer(commandPool, *buffer, content);
+	}
+
+	inline void BufferUtil::CreateDeviceBuffer(
+		CommandPool& commandPool,
+		const char* const name,
+		const VkBufferUsageFlags usage,
+		const VkDeviceSize size,
+		std::unique_ptr<Buffer>& buffer,
+		std::unique_ptr<DeviceMemory>& memory)
 	{
 		const auto& device = commandPool.Device();
 		const auto& debugUtils = device.DebugUtils();
-		const auto contentSize = sizeof(content[0]) * content.size();
 		const VkMemoryAllocateFlags allocateFlags = usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
 			? VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT
 			: 0;
 
-		buffer.reset(new Buffer(device, contentSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage));
+		buffer.reset(new Buffer(device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage));
 		memory.reset(new DeviceMemory(buffer->AllocateMemory(allocateFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 
 		debugUtils.SetObjectName(buffer->Handle(), (name + std::string(" Buffer")).c_str());
-		debugUtils.SetObjectName(memory->Handle(), (name + std::string(" Memory")).c_str());
-
-		CopyFromStagingBuffer(commandPool, *buffer, content);
+		if (memory->IsDedicated()) // Otherwise a block shared with other resources.
+		{
+			debugUtils.SetObjectName(memory->Handle(), (name + std::string(" Memory")).c_str());
+		}
 	}
 }
@@ -1,5 +1,6 @@
 #include "Vulkan/CommandPool.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/HostAllocator.h"
 
 namespace vk {
 	CommandPool::CommandPool(const class Device& device, const uint32_t queueFamilyIndex, const bool allowReset) : device_(device) {
@@ -8,13 +9,13 @@ namespace vk {
 		poolInfo.queueFamilyIndex = queueFamilyIndex;
 		poolInfo.flags = allowReset ? VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT : 0;
 
-		Check(vkCreateCommandPool(device.Handle(), &poolInfo, nullptr, &commandPool_),
+		Check(vkCreateCommandPool(device.Handle(), &poolInfo, device.HostAllocator().Callbacks(VK_OBJECT_TYPE_COMMAND_POOL), &commandPool_),
 			"create command pool");
 	}
 
 	CommandPool::~CommandPool() {
 		if (commandPool_ != nullptr) {
-			vkDestroyCommandPool(device_.Handle(), commandPool_, nullptr);
+			vkDestroyCommandPool(device_.Handle(), commandPool_, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_COMMAND_POOL));
 			commandPool_ = nullptr;
 		}
 	}
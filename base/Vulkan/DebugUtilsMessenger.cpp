@@ -1,4 +1,5 @@
 #include "Vulkan/DebugUtilsMessenger.h"
+#include "Vulkan/HostAllocator.h"
 #include "Vulkan/Instance.h"
 #include "Utilities/Console.h"
 #include <iostream>
@@ -173,7 +174,7 @@ namespace vk {
 		createInfo.pfnUserCallback = VulkanDebugCallback;
 		createInfo.pUserData = nullptr;
 
-		Check(CreateDebugUtilsMessengerEXT(instance_.Handle(), &createInfo, nullptr, &messenger_),
+		Check(CreateDebugUtilsMessengerEXT(instance_.Handle(), &createInfo, instance_.HostAllocator().Callbacks(VK_OBJECT_TYPE_DEBUG_UTILS_MESSENGER_EXT), &messenger_),
 			"set up Vulkan debug callback");
 	}
 
@@ -181,7 +182,7 @@ namespace vk {
 	{
 		if (messenger_ != nullptr)
 		{
-			DestroyDebugUtilsMessengerEXT(instance_.Handle(), messenger_, nullptr);
+			DestroyDebugUtilsMessengerEXT(instance_.Handle(), messenger_, instance_.HostAllocator().Callbacks(VK_OBJECT_TYPE_DEBUG_UTILS_MESSENGER_EXT));
 			messenger_ = nullptr;
 		}
 	}
@@ -0,0 +1,57 @@
+#include "Vulkan/DeletionQueue.h"
+
+namespace vk {
+
+	DeletionQueue::~DeletionQueue()
+	{
+		Flush();
+	}
+
+	void DeletionQueue::Retire(std::shared_ptr<const void> object)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		if (retired_.empty() || retired_.back().Frame != frame_)
+		{
+			retired_.push_back({ frame_, {} });
+		}
+
+		retired_.back().Objects.push_back(std::move(object));
+	}
+
+	void DeletionQueue::BeginFrame(const uint32_t framesInFlight)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		++frame_;
+
+		// An object retired during frame N may be used by the frames recorded up to N. The fence waited on at the
+		// start of frame N + framesInFlight is the one of frame N, the last of them.
+		while (!retired_.empty() && frame_ - retired_.front().Frame >= framesInFlight)
+		{
+			Destroy(retired_.front());
+			retired_.pop_front();
+		}
+	}
+
+	void DeletionQueue::Flush()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		for (auto& retired : retired_)
+		{
+			Destroy(retired);
+		}
+
+		retired_.clear();
+	}
+
+	void DeletionQueue::Destroy(Retired& retired)
+	{
+		for (auto& object : retired.Objects)
+		{
+			object.reset();
+		}
+	}
+
+}
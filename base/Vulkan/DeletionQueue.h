@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Vulkan/VkConfig.h"
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vk
+{
+	// Keeps buffers, images, views, pipelines, memory and the like alive until the frames that could still
+	// reference them have completed, so they can be replaced without waiting for the device to go idle.
+	// Objects retired during a frame are destroyed together, in the order they were retired (e.g. a buffer
+	// before its memory), once BeginFrame() has been called framesInFlight more times. Thread safe.
+	class DeletionQueue final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(DeletionQueue)
+
+		DeletionQueue() = default;
+		~DeletionQueue();
+
+		template <class T>
+		void Retire(std::unique_ptr<T> object)
+		{
+			if (object)
+			{
+				Retire(std::shared_ptr<const void>(std::move(object)));
+			}
+		}
+
+		void Retire(std::shared_ptr<const void> object);
+
+		// Call once per frame after waiting for the fence of the frame about to be recorded.
+		void BeginFrame(uint32_t framesInFlight);
+
+		// Destroys everything right away, the device must be idle.
+		void Flush();
+
+	private:
+
+		struct Retired
+		{
+			uint64_t Frame;
+			std::vector<std::shared_ptr<const void>> Objects;
+		};
+
+		static void Destroy(Retired& retired);
+
+		std::mutex mutex_;
+		uint64_t frame_{};
+		std::deque<Retired> retired_;
+	};
+
+}
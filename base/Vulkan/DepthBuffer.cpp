@@ -4,7 +4,9 @@
 #include "Vulkan/DeviceMemory.h"
 #include "Vulkan/Image.h"
 #include "Vulkan/ImageView.h"
+#include "Vulkan/MemoryAliasPool.h"
 #include "Vulkan/Sampler.h"
+#include <iostream>
 #include <stdexcept>
 
 namespace vk {
@@ -30,14 +32,23 @@ namespace vk {
 			throw std::runtime_error("failed to find supported format");
 		}
 
-		VkFormat FindDepthFormat(const Device& device)
+		VkFormat FindDepthFormat(const Device& device, const VkFormat preferred = VK_FORMAT_UNDEFINED, const VkFormatFeatureFlags features = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
 		{
-			return FindSupportedFormat(
-				device,
-				{ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT },
-				VK_IMAGE_TILING_OPTIMAL,
-				VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
-			);
+			std::vector<VkFormat> candidates = { VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT, VK_FORMAT_D16_UNORM };
+
+			if (preferred != VK_FORMAT_UNDEFINED)
+			{
+				candidates.insert(candidates.begin(), preferred);
+			}
+
+			const VkFormat format = FindSupportedFormat(device, candidates, VK_IMAGE_TILING_OPTIMAL, features);
+
+			if (preferred != VK_FORMAT_UNDEFINED && format != preferred)
+			{
+				std::cerr << "WARNING: depth format " << preferred << " is not supported, using " << format << " instead" << std::endl;
+			}
+
+			return format;
 		}
 	}
 
@@ -46,8 +57,9 @@ namespace vk {
 	{
 		const auto& device = commandPool.Device();
 
-		image_.reset(new class Image(device, extent, format_, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, 1, arrayLayers));
-		imageMemory_.reset(new DeviceMemory(image_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+		// Only cleared and discarded within the render pass, so it never needs to leave tile memory.
+		image_.reset(new class Image(device, extent, format_, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT, 1, arrayLayers));
+		aliasedMemory_ = device.MemoryAliasPool().AcquireTransient(*image_, MemoryCategory::RenderTarget);
 		imageView_.reset(new class ImageView(device, image_->Handle(), format_, VK_IMAGE_ASPECT_DEPTH_BIT, arrayLayers, 0, arrayLayers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D));
 
 		image_->TransitionImageLayout(commandPool, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, 1, arrayLayers);
@@ -55,12 +67,12 @@ namespace vk {
 		const auto& debugUtils = device.DebugUtils();
 
 		debugUtils.SetObjectName(image_->Handle(), "Depth Buffer Image");
-		debugUtils.SetObjectName(imageMemory_->Handle(), "Depth Buffer Image Memory");
 		debugUtils.SetObjectName(imageView_->Handle(), "Depth Buffer ImageView");
 	}
 
-	DepthBuffer::DepthBuffer(CommandPool& commandPool, const VkExtent2D extent, const int32_t arrayLayers, bool shadowMap) :
-		format_(FindDepthFormat(commandPool.Device()))
+	DepthBuffer::DepthBuffer(CommandPool& commandPool, const VkExtent2D extent, const int32_t arrayLayers, bool shadowMap, const VkFormat format) :
+		format_(FindDepthFormat(commandPool.Device(), format,
+			shadowMap ? (VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) : VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT))
 	{
 		const auto& device = commandPool.Device();
 
@@ -68,7 +80,7 @@ namespace vk {
 			shadowMap ? (VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT) 
 			: (VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT),
 			1, arrayLayers));
-		imageMemory_.reset(new DeviceMemory(image_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+		imageMemory_.reset(new DeviceMemory(image_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, shadowMap ? MemoryCategory::ShadowMap : MemoryCategory::RenderTarget)));
 		imageView_.reset(new class ImageView(device, image_->Handle(), format_, VK_IMAGE_ASPECT_DEPTH_BIT, arrayLayers, 0, arrayLayers > 1? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D));
 
 		if (shadowMap) {
@@ -80,7 +92,10 @@ namespace vk {
 		const auto& debugUtils = device.DebugUtils();
 
 		debugUtils.SetObjectName(image_->Handle(), "Depth Buffer Image");
-		debugUtils.SetObjectName(imageMemory_->Handle(), "Depth Buffer Image Memory");
+		if (imageMemory_->IsDedicated()) // Otherwise a block shared with other resources.
+		{
+			debugUtils.SetObjectName(imageMemory_->Handle(), "Depth Buffer Image Memory");
+		}
 		debugUtils.SetObjectName(imageView_->Handle(), "Depth Buffer ImageView");
 	}
 
@@ -89,5 +104,6 @@ namespace vk {
 		imageView_.reset();
 		image_.reset();
 		imageMemory_.reset(); // release memory after bound image has been destroyed
+		aliasedMemory_.reset();
 	}
 }
\ No newline at end of file
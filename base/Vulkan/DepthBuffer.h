@@ -4,6 +4,7 @@
 #include <memory>
 
 namespace vk {
+	class AliasedMemory;
 	class CommandPool;
 	class Device;
 	class DeviceMemory;
@@ -16,7 +17,8 @@ namespace vk {
 		VULKAN_NON_COPIABLE(DepthBuffer)
 
 		DepthBuffer(CommandPool& commandPool, const VkExtent2D extent, const int32_t arrayLayers);
-		DepthBuffer(CommandPool& commandPool, VkExtent2D extent, const int32_t arrayLayers, bool shadowMap);
+		// format is a preference, the best supported depth format is used instead if the device lacks it.
+		DepthBuffer(CommandPool& commandPool, VkExtent2D extent, const int32_t arrayLayers, bool shadowMap, VkFormat format = VK_FORMAT_UNDEFINED);
 		~DepthBuffer();
 
 		VkFormat Format() const { return format_; }
@@ -32,6 +34,7 @@ namespace vk {
 		const VkFormat format_;
 		std::unique_ptr<class Image> image_;
 		std::unique_ptr<DeviceMemory> imageMemory_;
+		std::unique_ptr<AliasedMemory> aliasedMemory_;
 		std::unique_ptr<class ImageView> imageView_;
 		std::unique_ptr<vk::Sampler> sampler_;
 	};
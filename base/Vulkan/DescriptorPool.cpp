@@ -1,5 +1,6 @@
 #include "Vulkan/DescriptorPool.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/HostAllocator.h"
 
 namespace vk {
 
@@ -19,7 +20,7 @@ namespace vk {
 		poolInfo.pPoolSizes = poolSizes.data();
 		poolInfo.maxSets = static_cast<uint32_t>(maxSets);
 
-		Check(vkCreateDescriptorPool(device.Handle(), &poolInfo, nullptr, &descriptorPool_),
+		Check(vkCreateDescriptorPool(device.Handle(), &poolInfo, device.HostAllocator().Callbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL), &descriptorPool_),
 			"create descriptor pool");
 	}
 
@@ -27,7 +28,7 @@ namespace vk {
 	{
 		if (descriptorPool_ != nullptr)
 		{
-			vkDestroyDescriptorPool(device_.Handle(), descriptorPool_, nullptr);
+			vkDestroyDescriptorPool(device_.Handle(), descriptorPool_, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_DESCRIPTOR_POOL));
 			descriptorPool_ = nullptr;
 		}
 	}
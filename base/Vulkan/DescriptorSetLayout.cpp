@@ -1,5 +1,7 @@
 #include "Vulkan/DescriptorSetLayout.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/HostAllocator.h"
+#include "Utilities/Hash.h"
 
 namespace vk {
 
@@ -17,6 +19,11 @@ namespace vk {
 			b.stageFlags = binding.Stage;
 
 			layoutBindings.push_back(b);
+
+			hash_ = Utilities::Hash::Combine(hash_, Utilities::Hash::Value(binding.Binding));
+			hash_ = Utilities::Hash::Combine(hash_, Utilities::Hash::Value(binding.DescriptorCount));
+			hash_ = Utilities::Hash::Combine(hash_, Utilities::Hash::Value(binding.Type));
+			hash_ = Utilities::Hash::Combine(hash_, Utilities::Hash::Value(binding.Stage));
 		}
 
 		VkDescriptorSetLayoutCreateInfo layoutInfo = {};
@@ -24,7 +31,7 @@ namespace vk {
 		layoutInfo.bindingCount = static_cast<uint32_t>(layoutBindings.size());
 		layoutInfo.pBindings = layoutBindings.data();
 
-		Check(vkCreateDescriptorSetLayout(device.Handle(), &layoutInfo, nullptr, &layout_),
+		Check(vkCreateDescriptorSetLayout(device.Handle(), &layoutInfo, device.HostAllocator().Callbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT), &layout_),
 			"create descriptor set layout");
 	}
 
@@ -32,7 +39,7 @@ namespace vk {
 	{
 		if (layout_ != nullptr)
 		{
-			vkDestroyDescriptorSetLayout(device_.Handle(), layout_, nullptr);
+			vkDestroyDescriptorSetLayout(device_.Handle(), layout_, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT));
 			layout_ = nullptr;
 		}
 	}
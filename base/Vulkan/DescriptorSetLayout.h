@@ -16,9 +16,13 @@ namespace vk
 		DescriptorSetLayout(const Device& device, const std::vector<DescriptorBinding>& descriptorBindings);
 		~DescriptorSetLayout();
 
+		// Hash of the binding description, equal for layouts created from the same bindings.
+		uint64_t Hash() const { return hash_; }
+
 	private:
 
 		const Device& device_;
+		uint64_t hash_{};
 
 		VULKAN_HANDLE(VkDescriptorSetLayout, layout_)
 	};
@@ -0,0 +1,76 @@
+#include "Vulkan/DescriptorSetLayoutCache.h"
+#include "Vulkan/Device.h"
+#include "Utilities/Hash.h"
+
+namespace vk {
+
+	std::mutex DescriptorSetLayoutCache::mutex_;
+	std::unordered_multimap<uint64_t, DescriptorSetLayoutCache::Entry> DescriptorSetLayoutCache::entries_;
+
+	std::shared_ptr<const DescriptorSetLayout> DescriptorSetLayoutCache::Acquire(const class Device& device, const std::vector<DescriptorBinding>& descriptorBindings)
+	{
+		const auto hash = Utilities::Hash::Combine(HashOf(descriptorBindings), Utilities::Hash::Value(device.Handle()));
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		const auto range = entries_.equal_range(hash);
+		for (auto it = range.first; it != range.second; )
+		{
+			auto layout = it->second.Instance.lock();
+
+			if (!layout)
+			{
+				it = entries_.erase(it);
+				continue;
+			}
+
+			if (it->second.Device == device.Handle() && Equals(it->second.Bindings, descriptorBindings))
+			{
+				return layout;
+			}
+
+			++it;
+		}
+
+		auto layout = std::make_shared<const DescriptorSetLayout>(device, descriptorBindings);
+		entries_.emplace(hash, Entry{ device.Handle(), descriptorBindings, layout });
+
+		return layout;
+	}
+
+	uint64_t DescriptorSetLayoutCache::HashOf(const std::vector<DescriptorBinding>& descriptorBindings)
+	{
+		uint64_t hash = 0;
+
+		for (const auto& binding : descriptorBindings)
+		{
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(binding.Binding));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(binding.DescriptorCount));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(binding.Type));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(binding.Stage));
+		}
+
+		return hash;
+	}
+
+	bool DescriptorSetLayoutCache::Equals(const std::vector<DescriptorBinding>& a, const std::vector<DescriptorBinding>& b)
+	{
+		if (a.size() != b.size())
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i != a.size(); ++i)
+		{
+			if (a[i].Binding != b[i].Binding ||
+				a[i].DescriptorCount != b[i].DescriptorCount ||
+				a[i].Type != b[i].Type ||
+				a[i].Stage != b[i].Stage)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
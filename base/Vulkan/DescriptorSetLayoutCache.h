@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Vulkan/DescriptorSetLayout.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace vk
+{
+	// Process-wide cache handing out one reference counted set layout per (device, bindings), so pipelines
+	// whose shaders declare the same resources share a layout. Entries are weak, the layout is destroyed
+	// when its last user releases it.
+	class DescriptorSetLayoutCache final
+	{
+	public:
+
+		static std::shared_ptr<const DescriptorSetLayout> Acquire(const Device& device, const std::vector<DescriptorBinding>& descriptorBindings);
+
+		static uint64_t HashOf(const std::vector<DescriptorBinding>& descriptorBindings);
+		static bool Equals(const std::vector<DescriptorBinding>& a, const std::vector<DescriptorBinding>& b);
+
+	private:
+
+		struct Entry
+		{
+			VkDevice Device;
+			std::vector<DescriptorBinding> Bindings;
+			std::weak_ptr<const DescriptorSetLayout> Instance;
+		};
+
+		static std::mutex mutex_;
+		static std::unordered_multimap<uint64_t, Entry> entries_;
+	};
+}
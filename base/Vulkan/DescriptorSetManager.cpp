@@ -1,8 +1,10 @@
 #include "Vulkan/DescriptorSetManager.h"
 #include "Vulkan/DescriptorPool.h"
 #include "Vulkan/DescriptorSetLayout.h"
+#include "Vulkan/DescriptorSetLayoutCache.h"
 #include "Vulkan/DescriptorSets.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/ShaderReflection.h"
 #include <stdexcept>
 #include <set>
 
@@ -22,10 +24,15 @@ namespace vk {
 		}
 
 		descriptorPool_.reset(new DescriptorPool(device, descriptorBindings, maxSets));
-		descriptorSetLayout_.reset(new class DescriptorSetLayout(device, descriptorBindings));
+		descriptorSetLayout_ = DescriptorSetLayoutCache::Acquire(device, descriptorBindings);
 		descriptorSets_.reset(new class DescriptorSets(*descriptorPool_, *descriptorSetLayout_, bindingTypes, maxSets));
 	}
 
+	DescriptorSetManager::DescriptorSetManager(const Device& device, const ShaderReflection& reflection, const size_t maxSets) :
+		DescriptorSetManager(device, reflection.DescriptorBindings(), maxSets)
+	{
+	}
+
 	DescriptorSetManager::~DescriptorSetManager()
 	{
 		descriptorSets_.reset();
@@ -9,6 +9,7 @@ namespace vk {
 	class DescriptorPool;
 	class DescriptorSetLayout;
 	class DescriptorSets;
+	class ShaderReflection;
 
 	class DescriptorSetManager final
 	{
@@ -17,6 +18,7 @@ namespace vk {
 		VULKAN_NON_COPIABLE(DescriptorSetManager)
 
 			explicit DescriptorSetManager(const Device& device, const std::vector<DescriptorBinding>& descriptorBindings, size_t maxSets);
+		DescriptorSetManager(const Device& device, const ShaderReflection& reflection, size_t maxSets);
 		~DescriptorSetManager();
 
 		const class DescriptorSetLayout& DescriptorSetLayout() const { return *descriptorSetLayout_; }
@@ -25,7 +27,7 @@ namespace vk {
 	private:
 
 		std::unique_ptr<DescriptorPool> descriptorPool_;
-		std::unique_ptr<class DescriptorSetLayout> descriptorSetLayout_;
+		std::shared_ptr<const class DescriptorSetLayout> descriptorSetLayout_;
 		std::unique_ptr<class DescriptorSets> descriptorSets_;
 	};
 
@@ -1,7 +1,14 @@
 #include "Vulkan/Device.h"
+#include "Vulkan/Allocator.h"
+#include "Vulkan/DeletionQueue.h"
 #include "Vulkan/Enumerate.h"
+#include "Vulkan/HostAllocator.h"
 #include "Vulkan/Instance.h"
+#include "Vulkan/MemoryAliasPool.h"
+#include "Vulkan/PipelineCache.h"
+#include "Vulkan/SubmissionPool.h"
 #include "Vulkan/Surface.h"
+#include "Vulkan/UploadManager.h"
 #include <algorithm>
 #include <string>
 #include <stdexcept>
@@ -40,10 +47,26 @@ namespace vk {
 		const void* nextDeviceFeatures) :
 		physicalDevice_(physicalDevice),
 		surface_(surface),
+		hostAllocator_(surface.Instance().HostAllocator()),
+		enabledFeatures_(deviceFeatures),
 		debugUtils_(surface.Instance().Handle())
 	{
 		CheckRequiredExtensions(physicalDevice, requiredExtensions);
 
+		// Optional extensions, enabled when available.
+		const auto availableExtensions = GetEnumerateVector(physicalDevice, static_cast<const char*>(nullptr), vkEnumerateDeviceExtensionProperties);
+		std::vector<const char*> extensions(requiredExtensions);
+
+		memoryBudget_ = std::any_of(availableExtensions.begin(), availableExtensions.end(), [](const VkExtensionProperties& extension)
+			{
+				return std::string(extension.extensionName) == VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+			});
+
+		if (memoryBudget_ && std::find_if(extensions.begin(), extensions.end(), [](const char* extension) { return std::string(extension) == VK_EXT_MEMORY_BUDGET_EXTENSION_NAME; }) == extensions.end())
+		{
+			extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		}
+
 		const auto queueFamilies = GetEnumerateVector(physicalDevice, vkGetPhysicalDeviceQueueFamilyProperties);
 
 		// Find the graphics queue.
@@ -63,9 +86,21 @@ namespace vk {
 			throw std::runtime_error("found no presentation queue");
 		}
 
+		// Find a transfer only queue (usually a DMA engine) for uploads, falling back to the graphics queue.
+		const auto transferFamily = std::find_if(queueFamilies.begin(), queueFamilies.end(), [](const VkQueueFamilyProperties& queueFamily)
+			{
+				return
+					queueFamily.queueCount > 0 &&
+					queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT &&
+					!(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+			});
+
 		graphicsFamilyIndex_ = static_cast<uint32_t>(graphicsFamily - queueFamilies.begin());
 		computeFamilyIndex_  = static_cast<uint32_t>(computeFamily - queueFamilies.begin());
 		presentFamilyIndex_  = static_cast<uint32_t>(presentFamily - queueFamilies.begin());
+		transferFamilyIndex_ = transferFamily != queueFamilies.end()
+			? static_cast<uint32_t>(transferFamily - queueFamilies.begin())
+			: graphicsFamilyIndex_;
 
 		// Queues can be the same
 		const std::set<uint32_t> uniqueQueueFamilies =
@@ -73,6 +108,7 @@ namespace vk {
 			graphicsFamilyIndex_,
 			computeFamilyIndex_,
 			presentFamilyIndex_,
+			transferFamilyIndex_,
 		};
 
 		// Create queues
@@ -99,10 +135,10 @@ namespace vk {
 		createInfo.pEnabledFeatures = &deviceFeatures;
 		createInfo.enabledLayerCount = static_cast<uint32_t>(surface_.Instance().ValidationLayers().size());
 		createInfo.ppEnabledLayerNames = surface_.Instance().ValidationLayers().data();
-		createInfo.enabledExtensionCount = static_cast<uint32_t>(requiredExtensions.size());
-		createInfo.ppEnabledExtensionNames = requiredExtensions.data();
+		createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+		createInfo.ppEnabledExtensionNames = extensions.data();
 
-		Check(vkCreateDevice(physicalDevice, &createInfo, nullptr, &device_),
+		Check(vkCreateDevice(physicalDevice, &createInfo, hostAllocator_.Callbacks(VK_OBJECT_TYPE_DEVICE), &device_),
 			"create logical device");
 
 		debugUtils_.SetDevice(device_);
@@ -110,13 +146,28 @@ namespace vk {
 		vkGetDeviceQueue(device_, graphicsFamilyIndex_, 0, &graphicsQueue_);
 		vkGetDeviceQueue(device_, computeFamilyIndex_,  0, &computeQueue_);
 		vkGetDeviceQueue(device_, presentFamilyIndex_,  0, &presentQueue_);
+		vkGetDeviceQueue(device_, transferFamilyIndex_, 0, &transferQueue_);
+
+		pipelineCache_.reset(new class PipelineCache(*this, "pipeline_cache.bin"));
+		allocator_.reset(new class Allocator(*this));
+		uploadManager_.reset(new class UploadManager(*this, VkDeviceSize(16) << 20, 3));
+		submissionPool_.reset(new class SubmissionPool(*this));
+		deletionQueue_.reset(new class DeletionQueue());
+		memoryAliasPool_.reset(new class MemoryAliasPool(*this));
 	}
 
 	Device::~Device()
 	{
+		submissionPool_.reset(); // waits for its submissions
+		deletionQueue_.reset(); // destroys what is left while the allocator is still alive
+		memoryAliasPool_.reset(); // after the deletion queue, which may hold aliased memory
+		uploadManager_.reset(); // waits for its submissions and frees its staging memory
+		allocator_.reset();
+		pipelineCache_.reset(); // saved and destroyed while the device is still alive
+
 		if (device_ != nullptr)
 		{
-			vkDestroyDevice(device_, nullptr);
+			vkDestroyDevice(device_, hostAllocator_.Callbacks(VK_OBJECT_TYPE_DEVICE));
 			device_ = nullptr;
 		}
 	}
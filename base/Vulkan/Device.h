@@ -2,10 +2,18 @@
 
 #include "Vulkan/DebugUtils.h"
 #include "Vulkan/VkConfig.h"
+#include <memory>
 #include <vector>
 
 namespace vk {
+	class Allocator;
+	class DeletionQueue;
+	class HostAllocator;
+	class MemoryAliasPool;
+	class PipelineCache;
+	class SubmissionPool;
 	class Surface;
+	class UploadManager;
 
 	class Device final {
 	public:
@@ -21,16 +29,30 @@ namespace vk {
 
 		VkPhysicalDevice PhysicalDevice() const { return physicalDevice_; }
 		const class Surface& Surface() const { return surface_; }
+		// Pass its Callbacks() to every create, destroy and memory allocation call.
+		class HostAllocator& HostAllocator() const { return hostAllocator_; }
+		const VkPhysicalDeviceFeatures& EnabledFeatures() const { return enabledFeatures_; }
+		// VK_EXT_memory_budget is enabled.
+		bool HasMemoryBudget() const { return memoryBudget_; }
 
 		const class DebugUtils& DebugUtils() const { return debugUtils_; }
+		const class PipelineCache& PipelineCache() const { return *pipelineCache_; }
+		class Allocator& Allocator() const { return *allocator_; }
+		class UploadManager& UploadManager() const { return *uploadManager_; }
+		class SubmissionPool& SubmissionPool() const { return *submissionPool_; }
+		class DeletionQueue& DeletionQueue() const { return *deletionQueue_; }
+		class MemoryAliasPool& MemoryAliasPool() const { return *memoryAliasPool_; }
 
 		uint32_t GraphicsFamilyIndex() const { return graphicsFamilyIndex_; }
 		uint32_t ComputeFamilyIndex() const { return computeFamilyIndex_; }
 		uint32_t PresentFamilyIndex() const { return presentFamilyIndex_; }
+		// Same as GraphicsFamilyIndex() if the device has no dedicated transfer queue.
+		uint32_t TransferFamilyIndex() const { return transferFamilyIndex_; }
 
 		VkQueue GraphicsQueue() const { return graphicsQueue_; }
 		VkQueue ComputeQueue() const { return computeQueue_; }
 		VkQueue PresentQueue() const { return presentQueue_; }
+		VkQueue TransferQueue() const { return transferQueue_; }
 
 		void WaitIdle() const;
 
@@ -39,17 +61,28 @@ namespace vk {
 
 		const VkPhysicalDevice physicalDevice_;
 		const class Surface& surface_;
+		class HostAllocator& hostAllocator_;
+		const VkPhysicalDeviceFeatures enabledFeatures_;
+		bool memoryBudget_{};
 
 		VULKAN_HANDLE(VkDevice, device_)
 
 		class DebugUtils debugUtils_;
-		
+		std::unique_ptr<class PipelineCache> pipelineCache_;
+		std::unique_ptr<class Allocator> allocator_;
+		std::unique_ptr<class UploadManager> uploadManager_;
+		std::unique_ptr<class SubmissionPool> submissionPool_;
+		std::unique_ptr<class DeletionQueue> deletionQueue_;
+		std::unique_ptr<class MemoryAliasPool> memoryAliasPool_;
+
 		uint32_t graphicsFamilyIndex_{};
 		uint32_t computeFamilyIndex_{};
 		uint32_t presentFamilyIndex_{};
+		uint32_t transferFamilyIndex_{};
 
 		VkQueue graphicsQueue_{};
 		VkQueue computeQueue_{};
 		VkQueue presentQueue_{};
+		VkQueue transferQueue_{};
 	};
 }
\ No newline at end of file
@@ -3,72 +3,44 @@
 #include <stdexcept>
 
 namespace vk {
-	DeviceMemory::DeviceMemory(
-		const class Device& device,
-		const size_t size,
-		const uint32_t memoryTypeBits,
-		const VkMemoryAllocateFlags allocateFLags,
-		const VkMemoryPropertyFlags propertyFlags) :
-		device_(device)
+	DeviceMemory::DeviceMemory(const class Device& device, const Allocator::Allocation& allocation) :
+		device_(device),
+		allocation_(allocation)
 	{
-		VkMemoryAllocateFlagsInfo flagsInfo = {};
-		flagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
-		flagsInfo.pNext = nullptr;
-		flagsInfo.flags = allocateFLags;
-
-		VkMemoryAllocateInfo allocInfo = {};
-		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		allocInfo.pNext = &flagsInfo;
-		allocInfo.allocationSize = size;
-		allocInfo.memoryTypeIndex = FindMemoryType(memoryTypeBits, propertyFlags);
-
-		Check(vkAllocateMemory(device.Handle(), &allocInfo, nullptr, &memory_),
-			"allocate memory");
 	}
 
 	DeviceMemory::DeviceMemory(DeviceMemory&& other) noexcept :
 		device_(other.device_),
-		memory_(other.memory_)
+		allocation_(other.allocation_)
 	{
-		other.memory_ = nullptr;
+		other.allocation_.Memory = nullptr;
 	}
 
 	DeviceMemory::~DeviceMemory()
 	{
-		if (memory_ != nullptr)
+		if (allocation_.Memory != nullptr)
 		{
-			vkFreeMemory(device_.Handle(), memory_, nullptr);
-			memory_ = nullptr;
+			device_.Allocator().Free(allocation_);
+			allocation_.Memory = nullptr;
 		}
 	}
 
 	void* DeviceMemory::Map(const size_t offset, const size_t size)
 	{
-		void* data;
-		Check(vkMapMemory(device_.Handle(), memory_, offset, size, 0, &data),
-			"map memory");
+		if (allocation_.Mapped == nullptr)
+		{
+			throw std::runtime_error("cannot map memory that is not host visible");
+		}
 
-		return data;
-	}
+		if (offset + size > allocation_.Size)
+		{
+			throw std::out_of_range("mapped range exceeds the allocation");
+		}
 
-	void DeviceMemory::Unmap()
-	{
-		vkUnmapMemory(device_.Handle(), memory_);
+		return static_cast<char*>(allocation_.Mapped) + offset;
 	}
 
-	uint32_t DeviceMemory::FindMemoryType(const uint32_t typeFilter, const VkMemoryPropertyFlags propertyFlags) const
+	void DeviceMemory::Unmap()
 	{
-		VkPhysicalDeviceMemoryProperties memProperties;
-		vkGetPhysicalDeviceMemoryProperties(device_.PhysicalDevice(), &memProperties);
-
-		for (uint32_t i = 0; i != memProperties.memoryTypeCount; ++i)
-		{
-			if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & propertyFlags) == propertyFlags)
-			{
-				return i;
-			}
-		}
-
-		throw std::runtime_error("failed to find suitable memory type");
 	}
-}
\ No newline at end of file
+}
@@ -1,30 +1,36 @@
 #pragma once
 
-#include "Vulkan/VkConfig.h"
+#include "Vulkan/Allocator.h"
 
 namespace vk {
 	class Device;
 
+	// A range of device memory obtained from the device Allocator, returned to it on destruction. Handle() may
+	// be shared with other allocations, resources must be bound at Offset().
 	class DeviceMemory final {
 	public:
 		DeviceMemory(const DeviceMemory&) = delete;
 		DeviceMemory& operator = (const DeviceMemory&) = delete;
 		DeviceMemory& operator = (DeviceMemory&&) = delete;
 
-		DeviceMemory(const Device& device, size_t size, uint32_t memoryTypeBits, VkMemoryAllocateFlags allocateFLags, VkMemoryPropertyFlags propertyFlags);
+		DeviceMemory(const Device& device, const Allocator::Allocation& allocation);
 		DeviceMemory(DeviceMemory&& other) noexcept;
 		~DeviceMemory();
 
 		const class Device& Device() const { return device_; }
 
+		VkDeviceMemory Handle() const { return allocation_.Memory; }
+		VkDeviceSize Offset() const { return allocation_.Offset; }
+		VkDeviceSize Size() const { return allocation_.Size; }
+		uint32_t MemoryType() const { return allocation_.MemoryType; }
+		bool IsDedicated() const { return allocation_.Owner == nullptr; }
+
+		// Host visible memory stays mapped, offset is relative to this allocation and Unmap() does nothing.
 		void* Map(size_t offset, size_t size);
 		void Unmap();
 
 	private:
-		uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
-
 		const class Device& device_;
-
-		VULKAN_HANDLE(VkDeviceMemory, memory_)
+		Allocator::Allocation allocation_;
 	};
-}
\ No newline at end of file
+}
@@ -1,5 +1,6 @@
 #include "Vulkan/Fence.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/HostAllocator.h"
 
 namespace vk {
 	Fence::Fence(const class Device& device, const bool signaled) :
@@ -9,7 +10,7 @@ namespace vk {
 		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
 		fenceInfo.flags = signaled ? VK_FENCE_CREATE_SIGNALED_BIT : 0;
 
-		Check(vkCreateFence(device.Handle(), &fenceInfo, nullptr, &fence_),
+		Check(vkCreateFence(device.Handle(), &fenceInfo, device.HostAllocator().Callbacks(VK_OBJECT_TYPE_FENCE), &fence_),
 			"create fence");
 	}
 
@@ -24,7 +25,7 @@ namespace vk {
 	{
 		if (fence_ != nullptr)
 		{
-			vkDestroyFence(device_.Handle(), fence_, nullptr);
+			vkDestroyFence(device_.Handle(), fence_, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_FENCE));
 			fence_ = nullptr;
 		}
 	}
@@ -1,6 +1,7 @@
 #include "Vulkan/FrameBuffer.h"
 #include "Vulkan/DepthBuffer.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/HostAllocator.h"
 #include "Vulkan/ImageView.h"
 #include "Vulkan/RenderPass.h"
 #include "Vulkan/SwapChain.h"
@@ -26,7 +27,7 @@ namespace vk {
 		framebufferInfo.height = renderPass.SwapChain().Extent().height;
 		framebufferInfo.layers = 1;
 
-		Check(vkCreateFramebuffer(imageView_.Device().Handle(), &framebufferInfo, nullptr, &framebuffer_),
+		Check(vkCreateFramebuffer(imageView_.Device().Handle(), &framebufferInfo, imageView_.Device().HostAllocator().Callbacks(VK_OBJECT_TYPE_FRAMEBUFFER), &framebuffer_),
 			"create framebuffer");
 	}
 
@@ -42,7 +43,7 @@ namespace vk {
 	{
 		if (framebuffer_ != nullptr)
 		{
-			vkDestroyFramebuffer(imageView_.Device().Handle(), framebuffer_, nullptr);
+			vkDestroyFramebuffer(imageView_.Device().Handle(), framebuffer_, imageView_.Device().HostAllocator().Callbacks(VK_OBJECT_TYPE_FRAMEBUFFER));
 			framebuffer_ = nullptr;
 		}
 	}
@@ -7,11 +7,11 @@
 namespace Assets
 {
 	class Scene;
-	class UniformBuffer;
 }
 
 namespace vk {
 	class DepthBuffer;
+	class Pipeline;
 	class PipelineLayout;
 	class RenderPass;
 	class SwapChain;
@@ -25,23 +25,24 @@ namespace vk {
 		GraphicsPipeline(
 			const SwapChain& swapChain,
 			const DepthBuffer& depthBuffer,
-			const std::vector<Assets::UniformBuffer>& uniformBuffers,
-			const Assets::Scene& scene,
-			bool isWireFrame);
+			const VkDescriptorBufferInfo& uniformBufferInfo,
+			const Assets::Scene& scene);
 		~GraphicsPipeline();
 
-		VkDescriptorSet DescriptorSet(uint32_t index) const;
-		bool IsWireFrame() const { return isWireFrame_; }
+		// Both polygon modes are built up front, switching between them is free. Falls back to the filled
+		// pipeline if the device does not support fillModeNonSolid.
+		VkPipeline Handle(bool wireFrame = false) const;
+		VkDescriptorSet DescriptorSet() const;
+		bool HasWireFrame() const { return wireFramePipeline_ != nullptr; }
 		const class PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
 		const class RenderPass& RenderPass() const { return *renderPass_; }
 
 	private:
 
 		const SwapChain& swapChain_;
-		const bool isWireFrame_;
-
-		VULKAN_HANDLE(VkPipeline, pipeline_)
 
+		std::shared_ptr<Pipeline> pipeline_;
+		std::shared_ptr<Pipeline> wireFramePipeline_;
 		std::unique_ptr<class DescriptorSetManager> descriptorSetManager_;
 		std::unique_ptr<class PipelineLayout> pipelineLayout_;
 		std::unique_ptr<class RenderPass> renderPass_;
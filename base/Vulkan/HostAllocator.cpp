@@ -0,0 +1,311 @@
+#include "Vulkan/HostAllocator.h"
+#include "Vulkan/Strings.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+namespace vk {
+
+	namespace
+	{
+		const size_t MinPooledSize = 64;
+		const size_t ChunkSize = 64 * 1024;
+		const uint32_t Unpooled = ~0u;
+	}
+
+	// Sits right before every pointer handed to the driver.
+	struct HostAllocator::Header
+	{
+		void* Raw;
+		TypeCallbacks* Type;
+		size_t Size;
+		uint32_t SizeClass;
+		VkSystemAllocationScope Scope;
+	};
+
+	struct HostAllocator::TypeCallbacks
+	{
+		VkAllocationCallbacks Callbacks;
+		HostAllocator* Allocator;
+		Statistics Stats;
+	};
+
+	HostAllocator::HostAllocator(const bool pooled) :
+		pooled_(pooled)
+	{
+		for (size_t size = MinPooledSize; size <= MaxPooledSize; size *= 2)
+		{
+			freeLists_.emplace_back();
+		}
+	}
+
+	HostAllocator::~HostAllocator()
+	{
+		for (size_t scope = 0; scope != ScopeCount; ++scope)
+		{
+			const auto& stats = scopeStats_[scope];
+
+			if (stats.AllocationCount != 0)
+			{
+				std::cerr << "WARNING: " << stats.AllocationCount << " host allocations (" << stats.AllocatedBytes << " bytes) of scope "
+					<< Strings::AllocationScope(static_cast<VkSystemAllocationScope>(scope)) << " were never freed" << std::endl;
+			}
+		}
+	}
+
+	const VkAllocationCallbacks* HostAllocator::Callbacks(const VkObjectType objectType)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		auto& type = types_[static_cast<uint32_t>(objectType)];
+
+		if (!type)
+		{
+			type.reset(new TypeCallbacks());
+			type->Allocator = this;
+			type->Callbacks.pUserData = type.get();
+			type->Callbacks.pfnAllocation = &HostAllocator::Allocate;
+			type->Callbacks.pfnReallocation = &HostAllocator::Reallocate;
+			type->Callbacks.pfnFree = &HostAllocator::Free;
+			type->Callbacks.pfnInternalAllocation = &HostAllocator::InternalAllocate;
+			type->Callbacks.pfnInternalFree = &HostAllocator::InternalFree;
+		}
+
+		return &type->Callbacks;
+	}
+
+	void HostAllocator::BeginFrame()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		lastFrame_ = frame_;
+		frame_ = {};
+	}
+
+	HostAllocator::Statistics HostAllocator::ScopeStats(const VkSystemAllocationScope scope) const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		return scopeStats_[scope];
+	}
+
+	std::vector<std::pair<VkObjectType, HostAllocator::Statistics>> HostAllocator::ObjectTypeStats() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		std::vector<std::pair<VkObjectType, Statistics>> stats;
+
+		for (const auto& type : types_)
+		{
+			stats.emplace_back(static_cast<VkObjectType>(type.first), type.second->Stats);
+		}
+
+		std::sort(stats.begin(), stats.end(), [](const auto& a, const auto& b)
+		{
+			return a.second.AllocatedBytes > b.second.AllocatedBytes;
+		});
+
+		return stats;
+	}
+
+	HostAllocator::Churn HostAllocator::LastFrame() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		return lastFrame_;
+	}
+
+	void* HostAllocator::Allocate(void* const userData, const size_t size, const size_t alignment, const VkSystemAllocationScope scope)
+	{
+		auto& type = *static_cast<TypeCallbacks*>(userData);
+		auto& allocator = *type.Allocator;
+
+		std::lock_guard<std::mutex> lock(allocator.mutex_);
+
+		++allocator.frame_.Allocations;
+
+		return allocator.AllocateLocked(type, size, alignment, scope);
+	}
+
+	void* HostAllocator::Reallocate(void* const userData, void* const original, const size_t size, const size_t alignment, const VkSystemAllocationScope scope)
+	{
+		auto& type = *static_cast<TypeCallbacks*>(userData);
+		auto& allocator = *type.Allocator;
+
+		std::lock_guard<std::mutex> lock(allocator.mutex_);
+
+		++allocator.frame_.Reallocations;
+
+		if (original == nullptr)
+		{
+			return allocator.AllocateLocked(type, size, alignment, scope);
+		}
+
+		if (size == 0)
+		{
+			allocator.FreeLocked(original);
+			return nullptr;
+		}
+
+		// On failure the original must be left untouched.
+		void* const memory = allocator.AllocateLocked(type, size, alignment, scope);
+
+		if (memory != nullptr)
+		{
+			std::memcpy(memory, original, std::min(size, (static_cast<Header*>(original) - 1)->Size));
+			allocator.FreeLocked(original);
+		}
+
+		return memory;
+	}
+
+	void HostAllocator::Free(void* const userData, void* const memory)
+	{
+		if (memory == nullptr)
+		{
+			return;
+		}
+
+		auto& allocator = *static_cast<TypeCallbacks*>(userData)->Allocator;
+
+		std::lock_guard<std::mutex> lock(allocator.mutex_);
+
+		++allocator.frame_.Frees;
+
+		allocator.FreeLocked(memory);
+	}
+
+	void HostAllocator::InternalAllocate(void* const userData, const size_t size, VkInternalAllocationType, const VkSystemAllocationScope scope)
+	{
+		auto& type = *static_cast<TypeCallbacks*>(userData);
+		auto& allocator = *type.Allocator;
+
+		std::lock_guard<std::mutex> lock(allocator.mutex_);
+
+		allocator.scopeStats_[scope].InternalBytes += size;
+		type.Stats.InternalBytes += size;
+	}
+
+	void HostAllocator::InternalFree(void* const userData, const size_t size, VkInternalAllocationType, const VkSystemAllocationScope scope)
+	{
+		auto& type = *static_cast<TypeCallbacks*>(userData);
+		auto& allocator = *type.Allocator;
+
+		std::lock_guard<std::mutex> lock(allocator.mutex_);
+
+		allocator.scopeStats_[scope].InternalBytes -= size;
+		type.Stats.InternalBytes -= size;
+	}
+
+	void* HostAllocator::AllocateLocked(TypeCallbacks& type, const size_t size, size_t alignment, const VkSystemAllocationScope scope)
+	{
+		if (size == 0)
+		{
+			return nullptr;
+		}
+
+		// The header goes in the padding in front of the aligned pointer.
+		alignment = std::max(alignment, alignof(Header));
+
+		uint32_t sizeClass = Unpooled;
+		char* const raw = static_cast<char*>(AllocateRaw(sizeof(Header) + alignment - 1 + size, sizeClass));
+
+		if (raw == nullptr)
+		{
+			return nullptr;
+		}
+
+		const auto address = (reinterpret_cast<uintptr_t>(raw) + sizeof(Header) + alignment - 1) & ~(uintptr_t(alignment) - 1);
+		char* const memory = reinterpret_cast<char*>(address);
+
+		auto& header = *(reinterpret_cast<Header*>(memory) - 1);
+		header.Raw = raw;
+		header.Type = &type;
+		header.Size = size;
+		header.SizeClass = sizeClass;
+		header.Scope = scope;
+
+		for (auto* stats : { &scopeStats_[scope], &type.Stats })
+		{
+			++stats->AllocationCount;
+			++stats->TotalAllocations;
+			stats->AllocatedBytes += size;
+			stats->PeakBytes = std::max(stats->PeakBytes, stats->AllocatedBytes);
+		}
+
+		frame_.AllocatedBytes += size;
+
+		return memory;
+	}
+
+	void HostAllocator::FreeLocked(void* const memory)
+	{
+		const auto& header = *(static_cast<Header*>(memory) - 1);
+
+		for (auto* stats : { &scopeStats_[header.Scope], &header.Type->Stats })
+		{
+			--stats->AllocationCount;
+			stats->AllocatedBytes -= header.Size;
+		}
+
+		FreeRaw(header.Raw, header.SizeClass);
+	}
+
+	void* HostAllocator::AllocateRaw(const size_t size, uint32_t& sizeClass)
+	{
+		if (!pooled_ || size > MaxPooledSize)
+		{
+			sizeClass = Unpooled;
+			return std::malloc(size);
+		}
+
+		size_t classSize = MinPooledSize;
+		sizeClass = 0;
+
+		while (classSize < size)
+		{
+			classSize *= 2;
+			++sizeClass;
+		}
+
+		auto& freeList = freeLists_[sizeClass];
+
+		if (freeList.empty())
+		{
+			// Chunks are only released with the allocator, the driver's small allocations tend to come back.
+			std::unique_ptr<char[]> chunk(new (std::nothrow) char[ChunkSize]);
+
+			if (!chunk)
+			{
+				return nullptr;
+			}
+
+			for (size_t offset = ChunkSize; offset != 0; offset -= classSize)
+			{
+				freeList.push_back(chunk.get() + offset - classSize);
+			}
+
+			chunks_.push_back(std::move(chunk));
+		}
+
+		void* const raw = freeList.back();
+		freeList.pop_back();
+
+		return raw;
+	}
+
+	void HostAllocator::FreeRaw(void* const raw, const uint32_t sizeClass)
+	{
+		if (sizeClass == Unpooled)
+		{
+			std::free(raw);
+			return;
+		}
+
+		freeLists_[sizeClass].push_back(raw);
+	}
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Vulkan/VkConfig.h"
+#include <array>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vk
+{
+	// Implements VkAllocationCallbacks so the host memory the driver allocates for us is accounted for, per
+	// allocation scope and per type of the object it was allocated for. Every vkCreate*, vkDestroy*, vkAllocateMemory
+	// and vkFreeMemory call passes Callbacks() of its object type; an object is destroyed with the callbacks it was
+	// created with. When pooled, allocations up to MaxPooledSize are recycled through size class free lists carved
+	// from larger chunks instead of going to the heap each time. Thread safe.
+	class HostAllocator final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(HostAllocator)
+
+		struct Statistics
+		{
+			uint64_t AllocationCount{}; // Live.
+			uint64_t AllocatedBytes{}; // Live.
+			uint64_t PeakBytes{};
+			uint64_t TotalAllocations{}; // Since creation, reallocations included.
+			uint64_t InternalBytes{}; // Reported by the driver as allocated without the callbacks (e.g. executable memory).
+		};
+
+		// Callback traffic over one frame, a steady state frame should have little to none.
+		struct Churn
+		{
+			uint64_t Allocations{};
+			uint64_t Reallocations{};
+			uint64_t Frees{};
+			uint64_t AllocatedBytes{};
+		};
+
+		static constexpr size_t ScopeCount = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+		static constexpr size_t MaxPooledSize = 4096;
+
+		explicit HostAllocator(bool pooled);
+		~HostAllocator();
+
+		const VkAllocationCallbacks* Callbacks(VkObjectType objectType);
+
+		// Call once per frame, the churn since the previous call becomes LastFrame().
+		void BeginFrame();
+
+		bool Pooled() const { return pooled_; }
+		Statistics ScopeStats(VkSystemAllocationScope scope) const;
+		std::vector<std::pair<VkObjectType, Statistics>> ObjectTypeStats() const;
+		Churn LastFrame() const;
+
+	private:
+
+		struct Header;
+		struct TypeCallbacks;
+
+		static VKAPI_ATTR void* VKAPI_CALL Allocate(void* userData, size_t size, size_t alignment, VkSystemAllocationScope scope);
+		static VKAPI_ATTR void* VKAPI_CALL Reallocate(void* userData, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+		static VKAPI_ATTR void VKAPI_CALL Free(void* userData, void* memory);
+		static VKAPI_ATTR void VKAPI_CALL InternalAllocate(void* userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+		static VKAPI_ATTR void VKAPI_CALL InternalFree(void* userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+
+		// The mutex must be held.
+		void* AllocateLocked(TypeCallbacks& type, size_t size, size_t alignment, VkSystemAllocationScope scope);
+		void FreeLocked(void* memory);
+
+		void* AllocateRaw(size_t size, uint32_t& sizeClass);
+		void FreeRaw(void* raw, uint32_t sizeClass);
+
+		const bool pooled_;
+
+		mutable std::mutex mutex_;
+		std::unordered_map<uint32_t, std::unique_ptr<TypeCallbacks>> types_;
+		std::array<Statistics, ScopeCount> scopeStats_{};
+		Churn frame_{};
+		Churn lastFrame_{};
+
+		std::vector<std::vector<void*>> freeLists_;
+		std::vector<std::unique_ptr<char[]>> chunks_;
+	};
+
+}
@@ -2,12 +2,26 @@
 #include "Vulkan/Buffer.h"
 #include "Vulkan/DepthBuffer.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/HostAllocator.h"
 #include "Vulkan/SingleTimeCommands.h"
 #include <stdexcept>
 #include <iostream>
 #include <string>
 
 namespace vk {
+	namespace
+	{
+		MemoryCategory CategoryOf(const VkImageUsageFlags usage)
+		{
+			if (usage & (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT))
+			{
+				return MemoryCategory::RenderTarget;
+			}
+
+			return usage & VK_IMAGE_USAGE_SAMPLED_BIT ? MemoryCategory::Texture : MemoryCategory::Other;
+		}
+	}
+
 	Image::Image(const class Device& device, const VkExtent2D extent, const VkFormat format, const int32_t miplevels, const int32_t arrayLayers, const int32_t flag) :
 		Image(device, extent, format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, miplevels, arrayLayers, flag)
 	{
@@ -25,6 +39,8 @@ namespace vk {
 		device_(device),
 		extent_(extent),
 		format_(format),
+		tiling_(tiling),
+		usage_(usage),
 		imageLayout_(VK_IMAGE_LAYOUT_UNDEFINED)
 	{
 		VkImageCreateInfo imageInfo = {};
@@ -43,7 +59,7 @@ namespace vk {
 		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 		imageInfo.flags = flag; // Optional
 
-		Check(vkCreateImage(device.Handle(), &imageInfo, nullptr, &image_),
+		Check(vkCreateImage(device.Handle(), &imageInfo, device.HostAllocator().Callbacks(VK_OBJECT_TYPE_IMAGE), &image_),
 			"create image");
 	}
 
@@ -51,6 +67,8 @@ namespace vk {
 		device_(other.device_),
 		extent_(other.extent_),
 		format_(other.format_),
+		tiling_(other.tiling_),
+		usage_(other.usage_),
 		imageLayout_(other.imageLayout_),
 		image_(other.image_)
 	{
@@ -61,17 +79,37 @@ namespace vk {
 	{
 		if (image_ != nullptr)
 		{
-			vkDestroyImage(device_.Handle(), image_, nullptr);
+			vkDestroyImage(device_.Handle(), image_, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_IMAGE));
 			image_ = nullptr;
 		}
 	}
 
 	DeviceMemory Image::AllocateMemory(const VkMemoryPropertyFlags properties) const
 	{
-		const auto requirements = GetMemoryRequirements();
-		DeviceMemory memory(device_, requirements.size, requirements.memoryTypeBits, 0, properties);
+		return AllocateMemory(properties, CategoryOf(usage_));
+	}
+
+	DeviceMemory Image::AllocateMemory(const VkMemoryPropertyFlags properties, const MemoryCategory category) const
+	{
+		// Render targets and the like may be faster in memory of their own, the driver tells.
+		VkImageMemoryRequirementsInfo2 info = {};
+		info.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+		info.image = image_;
+
+		VkMemoryDedicatedRequirements dedicated = {};
+		dedicated.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+		VkMemoryRequirements2 requirements = {};
+		requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+		requirements.pNext = &dedicated;
 
-		Check(vkBindImageMemory(device_.Handle(), image_, memory.Handle(), 0),
+		vkGetImageMemoryRequirements2(device_.Handle(), &info, &requirements);
+
+		const bool isDedicated = dedicated.prefersDedicatedAllocation || dedicated.requiresDedicatedAllocation;
+		DeviceMemory memory(device_, device_.Allocator().Allocate(requirements.memoryRequirements, properties, 0,
+			tiling_ == VK_IMAGE_TILING_OPTIMAL, category, isDedicated ? image_ : nullptr));
+
+		Check(vkBindImageMemory(device_.Handle(), image_, memory.Handle(), memory.Offset()),
 			"bind image memory");
 
 		return memory;
@@ -88,96 +126,101 @@ namespace vk {
 	{
 		SingleTimeCommands::Submit(commandPool, [&](VkCommandBuffer commandBuffer)
 			{
-				VkImageMemoryBarrier barrier = {};
-				barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-				barrier.oldLayout = imageLayout_;
-				barrier.newLayout = newLayout;
-				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-				barrier.image = image_;
-				barrier.subresourceRange.baseMipLevel = 0;
-				barrier.subresourceRange.levelCount = levelCount;
-				barrier.subresourceRange.baseArrayLayer = 0;
-				barrier.subresourceRange.layerCount = layerCount;
-
-				if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
-				{
-					barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-
-					if (DepthBuffer::HasStencilComponent(format_))
-					{
-						barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
-					}
-				}
-				else
-				{
-					barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-				}
-
-				VkPipelineStageFlags sourceStage;
-				VkPipelineStageFlags destinationStage;
-
-				if (imageLayout_ == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
-				{
-					barrier.srcAccessMask = 0;
-					barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-					sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-					destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-				}
-				else if (imageLayout_ == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-				{
-					barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-					barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-					sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-					destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-				}
-				else if (imageLayout_ == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
-				{
-					barrier.srcAccessMask = 0;
-					barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-					sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-					destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-				}
-				else if (imageLayout_ == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) 
-				{
-					barrier.srcAccessMask = 0;
-					barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-					sourceStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-					destinationStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-				}
-				else if (imageLayout_ == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
-				{
-					barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-					barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-					sourceStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-					destinationStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-
-				}
-				else if (imageLayout_ == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
-				{
-					barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-					barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-					sourceStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-					destinationStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-				}
-				else
-				{
-					throw std::invalid_argument("unsupported layout transition from " + std::to_string(imageLayout_) + " to " + std::to_string(newLayout));
-				}
-
-				vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+				TransitionImageLayout(commandBuffer, newLayout, levelCount, layerCount);
 			});
+	}
+
+	void Image::TransitionImageLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout, const int32_t levelCount, const int32_t layerCount)
+	{
+		VkImageMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = imageLayout_;
+		barrier.newLayout = newLayout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image_;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = levelCount;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = layerCount;
+
+		if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
+		{
+			barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+
+			if (DepthBuffer::HasStencilComponent(format_))
+			{
+				barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+			}
+		}
+		else
+		{
+			barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		}
+
+		VkPipelineStageFlags sourceStage;
+		VkPipelineStageFlags destinationStage;
+
+		if (imageLayout_ == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+		{
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+			sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		}
+		else if (imageLayout_ == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+		{
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+			sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+			destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		}
+		else if (imageLayout_ == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
+		{
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+			sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+		}
+		else if (imageLayout_ == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) 
+		{
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+			sourceStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			destinationStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		}
+		else if (imageLayout_ == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+		{
+			barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+			sourceStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			destinationStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+		}
+		else if (imageLayout_ == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
+		{
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+			sourceStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			destinationStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		}
+		else
+		{
+			throw std::invalid_argument("unsupported layout transition from " + std::to_string(imageLayout_) + " to " + std::to_string(newLayout));
+		}
+
+		vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
 
 		imageLayout_ = newLayout;
 	}
 
-	void Image::CopyFrom(CommandPool& commandPool, const Buffer& buffer)
+	void Image::CopyFrom(CommandPool& commandPool, const Buffer& buffer, const int32_t layerCount)
 	{
 		SingleTimeCommands::Submit(commandPool, [&](VkCommandBuffer commandBuffer)
 			{
@@ -188,7 +231,7 @@ namespace vk {
 				region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 				region.imageSubresource.mipLevel = 0;
 				region.imageSubresource.baseArrayLayer = 0;
-				region.imageSubresource.layerCount = 1;
+				region.imageSubresource.layerCount = layerCount;
 				region.imageOffset = { 0, 0, 0 };
 				region.imageExtent = { extent_.width, extent_.height, 1 };
 
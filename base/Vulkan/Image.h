@@ -23,17 +23,25 @@ namespace vk {
 		VkExtent2D Extent() const { return extent_; }
 		VkFormat Format() const { return format_; }
 		VkImageLayout ImageLayout() const { return imageLayout_; }
+		// For barriers recorded by hand, e.g. the two halves of a queue family ownership transfer.
+		void SetImageLayout(VkImageLayout layout) { imageLayout_ = layout; }
 
+		// Tagged with the memory category implied by the usage flags, unless given.
 		DeviceMemory AllocateMemory(VkMemoryPropertyFlags properties) const;
+		DeviceMemory AllocateMemory(VkMemoryPropertyFlags properties, MemoryCategory category) const;
 		VkMemoryRequirements GetMemoryRequirements() const;
 
 		void TransitionImageLayout(CommandPool& commandPool, VkImageLayout newLayout, const int32_t levelCount, const int32_t layerCount);
-		void CopyFrom(CommandPool& commandPool, const Buffer& buffer);
+		// Records the barrier into commandBuffer, ImageLayout() is updated right away.
+		void TransitionImageLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout, const int32_t levelCount, const int32_t layerCount);
+		void CopyFrom(CommandPool& commandPool, const Buffer& buffer, const int32_t layerCount = 1);
 
 	private:
 		const class Device& device_;
 		const VkExtent2D extent_;
 		const VkFormat format_;
+		const VkImageTiling tiling_;
+		const VkImageUsageFlags usage_;
 		VkImageLayout imageLayout_;
 
 		VULKAN_HANDLE(VkImage, image_)
@@ -1,8 +1,9 @@
 #include "Vulkan/ImageView.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/HostAllocator.h"
 
 namespace vk {
-	ImageView::ImageView(const class Device& device, const VkImage image, const VkFormat format, const VkImageAspectFlags aspectFlags, int32_t layerCount, int32_t baseLayer, VkImageViewType viewType) :
+	ImageView::ImageView(const class Device& device, const VkImage image, const VkFormat format, const VkImageAspectFlags aspectFlags, int32_t layerCount, int32_t baseLayer, VkImageViewType viewType, int32_t levelCount) :
 		device_(device),
 		image_(image),
 		format_(format)
@@ -18,11 +19,11 @@ namespace vk {
 		createInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
 		createInfo.subresourceRange.aspectMask = aspectFlags;
 		createInfo.subresourceRange.baseMipLevel = 0;
-		createInfo.subresourceRange.levelCount = 1;
+		createInfo.subresourceRange.levelCount = levelCount;
 		createInfo.subresourceRange.baseArrayLayer = baseLayer;
 		createInfo.subresourceRange.layerCount = layerCount;
 
-		Check(vkCreateImageView(device_.Handle(), &createInfo, nullptr, &imageView_),
+		Check(vkCreateImageView(device_.Handle(), &createInfo, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_IMAGE_VIEW), &imageView_),
 			"create image view");
 	}
 
@@ -30,7 +31,7 @@ namespace vk {
 	{
 		if (imageView_ != nullptr)
 		{
-			vkDestroyImageView(device_.Handle(), imageView_, nullptr);
+			vkDestroyImageView(device_.Handle(), imageView_, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_IMAGE_VIEW));
 			imageView_ = nullptr;
 		}
 	}
@@ -51,14 +52,14 @@ namespace vk {
 		createInfo.subresourceRange.baseArrayLayer = 0;
 		createInfo.subresourceRange.layerCount = 6;
 
-		Check(vkCreateImageView(device_.Handle(), &createInfo, nullptr, &imageView_),
+		Check(vkCreateImageView(device_.Handle(), &createInfo, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_IMAGE_VIEW), &imageView_),
 			"create image view");
 	}
 
 	CubeImageView::~CubeImageView() {
 		if (imageView_ != nullptr)
 		{
-			vkDestroyImageView(device_.Handle(), imageView_, nullptr);
+			vkDestroyImageView(device_.Handle(), imageView_, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_IMAGE_VIEW));
 			imageView_ = nullptr;
 		}
 	}
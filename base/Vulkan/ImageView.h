@@ -9,7 +9,7 @@ namespace vk {
 	public:
 		VULKAN_NON_COPIABLE(ImageView)
 
-		explicit ImageView(const Device& device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, int32_t layerCount = 1, int32_t baseLayer = 0, VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D);
+		explicit ImageView(const Device& device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, int32_t layerCount = 1, int32_t baseLayer = 0, VkImageViewType viewType = VK_IMAGE_VIEW_TYPE_2D, int32_t levelCount = 1);
 		~ImageView();
 
 		const class Device& Device() const { return device_; }
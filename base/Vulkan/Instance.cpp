@@ -1,13 +1,15 @@
 #include "Vulkan/Instance.h"
 #include "Vulkan/Enumerate.h"
+#include "Vulkan/HostAllocator.h"
 #include "Vulkan/Version.h"
 #include "Vulkan/Window.h"
 #include <algorithm>
 #include <sstream>
 
 namespace vk {
-	Instance::Instance(const class Window& window, const std::vector<const char*>& validationLayers, uint32_t vulkanVersion) :
+	Instance::Instance(const class Window& window, class HostAllocator& hostAllocator, const std::vector<const char*>& validationLayers, uint32_t vulkanVersion) :
 		window_(window),
+		hostAllocator_(hostAllocator),
 		validationLayers_(validationLayers)
 	{
 		// Check the minimum version.
@@ -40,7 +42,7 @@ namespace vk {
 		createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
 		createInfo.ppEnabledLayerNames = validationLayers.data();
 
-		Check(vkCreateInstance(&createInfo, nullptr, &instance_),
+		Check(vkCreateInstance(&createInfo, hostAllocator.Callbacks(VK_OBJECT_TYPE_INSTANCE), &instance_),
 			"create instance");
 
 		GetVulkanPhysicalDevices();
@@ -52,7 +54,7 @@ namespace vk {
 	{
 		if (instance_ != nullptr)
 		{
-			vkDestroyInstance(instance_, nullptr);
+			vkDestroyInstance(instance_, hostAllocator_.Callbacks(VK_OBJECT_TYPE_INSTANCE));
 			instance_ = nullptr;
 		}
 	}
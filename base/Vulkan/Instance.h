@@ -4,6 +4,7 @@
 #include <vector>
 
 namespace vk {
+	class HostAllocator;
 	class Window;
 
 	class Instance final {
@@ -11,10 +12,11 @@ namespace vk {
 
 		VULKAN_NON_COPIABLE(Instance)
 
-		Instance(const Window& window, const std::vector<const char*>& validationLayers, uint32_t vulkanVersion);
+		Instance(const Window& window, HostAllocator& hostAllocator, const std::vector<const char*>& validationLayers, uint32_t vulkanVersion);
 		~Instance();
 
 		const class Window& Window() const { return window_; }
+		class HostAllocator& HostAllocator() const { return hostAllocator_; }
 
 		const std::vector<VkExtensionProperties>& Extensions() const { return extensions_; }
 		const std::vector<VkLayerProperties>& Layers() const { return layers_; }
@@ -30,6 +32,7 @@ namespace vk {
 		static void CheckVulkanValidationLayerSupport(const std::vector<const char*>& validationLayers);
 
 		const class Window& window_;
+		class HostAllocator& hostAllocator_;
 		const std::vector<const char*> validationLayers_;
 
 		VULKAN_HANDLE(VkInstance, instance_)
@@ -0,0 +1,172 @@
+#include "Vulkan/MemoryAliasPool.h"
+#include "Vulkan/Device.h"
+#include "Vulkan/DeviceMemory.h"
+#include "Vulkan/Image.h"
+#include <algorithm>
+#include <iostream>
+
+namespace vk {
+
+	AliasedMemory::AliasedMemory(MemoryAliasPool& pool, MemoryAliasPool::Slot& slot) :
+		pool_(pool),
+		slot_(slot)
+	{
+	}
+
+	AliasedMemory::~AliasedMemory()
+	{
+		pool_.Release(slot_);
+	}
+
+	const DeviceMemory& AliasedMemory::DeviceMemory() const
+	{
+		return *slot_.Memory;
+	}
+
+	MemoryAliasPool::MemoryAliasPool(const class Device& device) :
+		device_(device)
+	{
+	}
+
+	MemoryAliasPool::~MemoryAliasPool()
+	{
+		for (const auto& slot : slots_)
+		{
+			if (slot->InUse)
+			{
+				std::cerr << "WARNING: aliased memory slot of " << slot->Memory->Size() << " bytes still in use when destroying its pool" << std::endl;
+			}
+		}
+	}
+
+	std::unique_ptr<AliasedMemory> MemoryAliasPool::Acquire(const Image& image, const VkMemoryPropertyFlags properties, const MemoryCategory category)
+	{
+		VkImageMemoryRequirementsInfo2 info = {};
+		info.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+		info.image = image.Handle();
+
+		VkMemoryDedicatedRequirements dedicated = {};
+		dedicated.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+		VkMemoryRequirements2 requirements2 = {};
+		requirements2.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+		requirements2.pNext = &dedicated;
+
+		vkGetImageMemoryRequirements2(device_.Handle(), &info, &requirements2);
+
+		const auto& requirements = requirements2.memoryRequirements;
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		Slot* slot = nullptr;
+
+		if (!dedicated.requiresDedicatedAllocation)
+		{
+			const auto compatible = [&](const Slot& candidate)
+			{
+				return candidate.Shared && !candidate.InUse && candidate.Properties == properties &&
+					(requirements.memoryTypeBits & (1u << candidate.Memory->MemoryType())) != 0 &&
+					candidate.Memory->Offset() % requirements.alignment == 0;
+			};
+
+			// Best fit first, then the largest slot too small to grow, so fewer slots end up reserved.
+			Slot* grow = nullptr;
+
+			for (const auto& candidate : slots_)
+			{
+				if (!compatible(*candidate))
+				{
+					continue;
+				}
+
+				if (candidate->Memory->Size() >= requirements.size)
+				{
+					if (slot == nullptr || candidate->Memory->Size() < slot->Memory->Size())
+					{
+						slot = candidate.get();
+					}
+				}
+				else if (grow == nullptr || candidate->Memory->Size() > grow->Memory->Size())
+				{
+					grow = candidate.get();
+				}
+			}
+
+			if (slot == nullptr && grow != nullptr)
+			{
+				// Not in use, nothing can still be bound to it.
+				grow->Memory.reset();
+				grow->Memory.reset(new class DeviceMemory(device_, device_.Allocator().Allocate(requirements, properties, 0, true, category)));
+				slot = grow;
+			}
+		}
+
+		if (slot == nullptr)
+		{
+			std::unique_ptr<Slot> added(new Slot());
+			added->Memory.reset(new class DeviceMemory(device_, device_.Allocator().Allocate(requirements, properties, 0, true, category,
+				dedicated.requiresDedicatedAllocation ? image.Handle() : nullptr)));
+			added->Properties = properties;
+			added->Shared = !dedicated.requiresDedicatedAllocation;
+
+			slot = added.get();
+			slots_.push_back(std::move(added));
+		}
+
+		Check(vkBindImageMemory(device_.Handle(), image.Handle(), slot->Memory->Handle(), slot->Memory->Offset()),
+			"bind aliased image memory");
+
+		slot->InUse = true;
+
+		return std::unique_ptr<AliasedMemory>(new AliasedMemory(*this, *slot));
+	}
+
+	std::unique_ptr<AliasedMemory> MemoryAliasPool::AcquireTransient(const Image& image, const MemoryCategory category)
+	{
+		const VkMemoryPropertyFlags lazy = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+		const bool hasLazy = device_.Allocator().HasMemoryType(image.GetMemoryRequirements().memoryTypeBits, lazy);
+
+		return Acquire(image, hasLazy ? lazy : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, category);
+	}
+
+	void MemoryAliasPool::Trim()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		slots_.erase(std::remove_if(slots_.begin(), slots_.end(), [](const std::unique_ptr<Slot>& slot)
+		{
+			return !slot->InUse;
+		}), slots_.end());
+	}
+
+	VkDeviceSize MemoryAliasPool::ReservedBytes() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		VkDeviceSize bytes = 0;
+
+		for (const auto& slot : slots_)
+		{
+			bytes += slot->Memory->Size();
+		}
+
+		return bytes;
+	}
+
+	void MemoryAliasPool::Release(Slot& slot)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		if (slot.Shared)
+		{
+			slot.InUse = false;
+			return;
+		}
+
+		slots_.erase(std::find_if(slots_.begin(), slots_.end(), [&slot](const std::unique_ptr<Slot>& candidate)
+		{
+			return candidate.get() == &slot;
+		}));
+	}
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Vulkan/Allocator.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vk
+{
+	class AliasedMemory;
+	class Device;
+	class DeviceMemory;
+	class Image;
+
+	// Lets render targets whose lifetimes do not overlap share the same memory, e.g. the offscreen targets of
+	// successive bake passes, or a depth buffer and the one replacing it after a resize. A slot is a range of
+	// device memory that at most one image is bound to at a time; Acquire() reuses the best fitting free slot
+	// with a compatible memory type and alignment, grows a free one that is too small, or adds a new one.
+	// Slots are kept until Trim(). Images the driver requires to own their memory get a slot of their own that
+	// is freed with them. Thread safe.
+	class MemoryAliasPool final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(MemoryAliasPool)
+
+		explicit MemoryAliasPool(const Device& device);
+		~MemoryAliasPool();
+
+		// Binds image to a free slot of memory with the given properties.
+		std::unique_ptr<AliasedMemory> Acquire(const Image& image, VkMemoryPropertyFlags properties, MemoryCategory category);
+
+		// For attachments created with VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT: lazily allocated memory if the
+		// device has any (tile based GPUs then never back them), device local memory otherwise.
+		std::unique_ptr<AliasedMemory> AcquireTransient(const Image& image, MemoryCategory category);
+
+		// Frees the slots no image is bound to.
+		void Trim();
+
+		VkDeviceSize ReservedBytes() const;
+
+	private:
+
+		friend class AliasedMemory;
+
+		struct Slot
+		{
+			std::unique_ptr<class DeviceMemory> Memory;
+			VkMemoryPropertyFlags Properties{};
+			bool Shared{};
+			bool InUse{};
+		};
+
+		void Release(Slot& slot);
+
+		const class Device& device_;
+
+		mutable std::mutex mutex_;
+		std::vector<std::unique_ptr<Slot>> slots_;
+	};
+
+	// Memory an image is bound to for as long as it lives, back in the pool on destruction. Must be destroyed
+	// after the image, and only once the device is done with it (e.g. through the DeletionQueue).
+	class AliasedMemory final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(AliasedMemory)
+
+		~AliasedMemory();
+
+		const class DeviceMemory& DeviceMemory() const;
+
+	private:
+
+		friend class MemoryAliasPool;
+
+		AliasedMemory(MemoryAliasPool& pool, MemoryAliasPool::Slot& slot);
+
+		MemoryAliasPool& pool_;
+		MemoryAliasPool::Slot& slot_;
+	};
+
+}
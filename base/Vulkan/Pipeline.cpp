@@ -0,0 +1,22 @@
+#include "Vulkan/Pipeline.h"
+#include "Vulkan/Device.h"
+#include "Vulkan/HostAllocator.h"
+
+namespace vk {
+
+	Pipeline::Pipeline(const class Device& device, const VkPipeline pipeline) :
+		device_(device),
+		pipeline_(pipeline)
+	{
+	}
+
+	Pipeline::~Pipeline()
+	{
+		if (pipeline_ != nullptr)
+		{
+			vkDestroyPipeline(device_.Handle(), pipeline_, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_PIPELINE));
+			pipeline_ = nullptr;
+		}
+	}
+
+}
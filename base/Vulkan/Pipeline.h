@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Vulkan/VkConfig.h"
+#include <vector>
+
+namespace vk
+{
+	class Device;
+
+	// Fixed function state of a graphics pipeline. The defaults describe an opaque, depth tested triangle list
+	// drawn into one colour attachment with dynamic viewport and scissor.
+	struct PipelineState final
+	{
+		std::vector<VkVertexInputBindingDescription> VertexBindings;
+		std::vector<VkVertexInputAttributeDescription> VertexAttributes;
+		VkPrimitiveTopology Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		VkExtent2D Viewport = {}; // Zero makes viewport and scissor dynamic state.
+		bool DepthClampEnable = false;
+		VkPolygonMode PolygonMode = VK_POLYGON_MODE_FILL;
+		VkCullModeFlags CullMode = VK_CULL_MODE_NONE;
+		VkFrontFace FrontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+		bool DepthTestEnable = true;
+		bool DepthWriteEnable = true;
+		VkCompareOp DepthCompareOp = VK_COMPARE_OP_LESS;
+		uint32_t ColorAttachmentCount = 1;
+		VkPipelineColorBlendAttachmentState ColorBlend = {
+			VK_FALSE,
+			VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD,
+			VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD,
+			VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT };
+	};
+
+	class Pipeline final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(Pipeline)
+
+		// Takes ownership of pipeline.
+		Pipeline(const Device& device, VkPipeline pipeline);
+		~Pipeline();
+
+		const class Device& Device() const { return device_; }
+
+	private:
+
+		const class Device& device_;
+
+		VULKAN_HANDLE(VkPipeline, pipeline_)
+	};
+
+}
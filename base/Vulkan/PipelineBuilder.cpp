@@ -0,0 +1,367 @@
+#include "Vulkan/PipelineBuilder.h"
+#include "Vulkan/Device.h"
+#include "Vulkan/PipelineCache.h"
+#include "Vulkan/PipelineLayout.h"
+#include "Vulkan/ShaderModule.h"
+#include "Utilities/Hash.h"
+#include <algorithm>
+
+namespace vk {
+
+	namespace
+	{
+		bool Equals(const VkVertexInputBindingDescription& a, const VkVertexInputBindingDescription& b)
+		{
+			return a.binding == b.binding && a.stride == b.stride && a.inputRate == b.inputRate;
+		}
+
+		bool Equals(const VkVertexInputAttributeDescription& a, const VkVertexInputAttributeDescription& b)
+		{
+			return a.location == b.location && a.binding == b.binding && a.format == b.format && a.offset == b.offset;
+		}
+
+		template <class T>
+		bool Equals(const std::vector<T>& a, const std::vector<T>& b)
+		{
+			return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const T& x, const T& y) { return Equals(x, y); });
+		}
+	}
+
+	std::mutex PipelineBuilder::mutex_;
+	std::unordered_multimap<uint64_t, PipelineBuilder::Entry> PipelineBuilder::entries_;
+
+	PipelineBuilder::PipelineBuilder(const class Device& device, const PipelineState& state) :
+		device_(device),
+		state_(state)
+	{
+	}
+
+	PipelineBuilder& PipelineBuilder::AddStage(const VkShaderStageFlagBits stage, std::vector<uint32_t> code, const SpecializationConstants& constants)
+	{
+		const auto hash = Utilities::Hash::Combine(Utilities::Hash::Bytes(code.data(), code.size() * sizeof(uint32_t)), constants.Hash());
+		stages_.push_back(Stage{ stage, std::move(code), constants, hash });
+		return *this;
+	}
+
+	std::shared_ptr<Pipeline> PipelineBuilder::Build(const PipelineLayout& layout, const VkRenderPass renderPass, const uint64_t renderPassHash, const char* name) const
+	{
+		Entry key{ device_.Handle(), state_, {}, layout.Hash(), renderPassHash, {} };
+
+		uint64_t hash = Utilities::Hash::Combine(HashOf(state_), Utilities::Hash::Value(device_.Handle()));
+		hash = Utilities::Hash::Combine(hash, layout.Hash());
+		hash = Utilities::Hash::Combine(hash, renderPassHash);
+
+		for (const auto& stage : stages_)
+		{
+			key.Stages.emplace_back(stage.Flag, stage.Hash);
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(stage.Flag));
+			hash = Utilities::Hash::Combine(hash, stage.Hash);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			if (auto pipeline = Find(hash, key))
+			{
+				return pipeline;
+			}
+		}
+
+		// Compile outside the lock so pipelines requested from other threads are not serialised behind this one.
+		auto pipeline = Create(layout, renderPass, name);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		if (auto existing = Find(hash, key))
+		{
+			return existing;
+		}
+
+		key.Instance = pipeline;
+		entries_.emplace(hash, std::move(key));
+
+		return pipeline;
+	}
+
+	std::shared_ptr<Pipeline> PipelineBuilder::Find(const uint64_t hash, const Entry& key)
+	{
+		const auto range = entries_.equal_range(hash);
+		for (auto it = range.first; it != range.second; )
+		{
+			auto pipeline = it->second.Instance.lock();
+
+			if (!pipeline)
+			{
+				it = entries_.erase(it);
+				continue;
+			}
+
+			const auto& entry = it->second;
+
+			if (entry.Device == key.Device &&
+				entry.Layout == key.Layout &&
+				entry.RenderPass == key.RenderPass &&
+				entry.Stages == key.Stages &&
+				Equals(entry.State, key.State))
+			{
+				return pipeline;
+			}
+
+			++it;
+		}
+
+		return nullptr;
+	}
+
+	std::shared_ptr<Pipeline> PipelineBuilder::Create(const PipelineLayout& layout, const VkRenderPass renderPass, const char* name) const
+	{
+		const bool dynamicViewport = state_.Viewport.width == 0 || state_.Viewport.height == 0;
+
+		VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(state_.VertexBindings.size());
+		vertexInputInfo.pVertexBindingDescriptions = state_.VertexBindings.data();
+		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(state_.VertexAttributes.size());
+		vertexInputInfo.pVertexAttributeDescriptions = state_.VertexAttributes.data();
+
+		VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+		inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		inputAssembly.topology = state_.Topology;
+		inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+		VkViewport viewport = {};
+		viewport.x = 0.0f;
+		viewport.y = 0.0f;
+		viewport.width = static_cast<float>(state_.Viewport.width);
+		viewport.height = static_cast<float>(state_.Viewport.height);
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+
+		VkRect2D scissor = {};
+		scissor.offset = { 0, 0 };
+		scissor.extent = state_.Viewport;
+
+		VkPipelineViewportStateCreateInfo viewportState = {};
+		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		viewportState.viewportCount = 1;
+		viewportState.pViewports = dynamicViewport ? nullptr : &viewport;
+		viewportState.scissorCount = 1;
+		viewportState.pScissors = dynamicViewport ? nullptr : &scissor;
+
+		const std::vector<VkDynamicState> dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+		VkPipelineDynamicStateCreateInfo dynamicState = {};
+		dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+		dynamicState.pDynamicStates = dynamicStates.data();
+
+		VkPipelineRasterizationStateCreateInfo rasterizer = {};
+		rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		rasterizer.depthClampEnable = state_.DepthClampEnable;
+		rasterizer.rasterizerDiscardEnable = VK_FALSE;
+		rasterizer.polygonMode = state_.PolygonMode;
+		rasterizer.lineWidth = 1.0f;
+		rasterizer.cullMode = state_.CullMode;
+		rasterizer.frontFace = state_.FrontFace;
+		rasterizer.depthBiasEnable = VK_FALSE;
+
+		VkPipelineMultisampleStateCreateInfo multisampling = {};
+		multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		multisampling.sampleShadingEnable = VK_FALSE;
+		multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+		multisampling.minSampleShading = 1.0f;
+
+		VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+		depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		depthStencil.depthTestEnable = state_.DepthTestEnable;
+		depthStencil.depthWriteEnable = state_.DepthWriteEnable;
+		depthStencil.depthCompareOp = state_.DepthCompareOp;
+		depthStencil.depthBoundsTestEnable = VK_FALSE;
+		depthStencil.minDepthBounds = 0.0f;
+		depthStencil.maxDepthBounds = 1.0f;
+		depthStencil.stencilTestEnable = VK_FALSE;
+
+		const std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments(state_.ColorAttachmentCount, state_.ColorBlend);
+
+		VkPipelineColorBlendStateCreateInfo colorBlending = {};
+		colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		colorBlending.logicOpEnable = VK_FALSE;
+		colorBlending.logicOp = VK_LOGIC_OP_COPY;
+		colorBlending.attachmentCount = static_cast<uint32_t>(colorBlendAttachments.size());
+		colorBlending.pAttachments = colorBlendAttachments.data();
+
+		// The modules are only needed until the pipeline is created.
+		std::vector<std::unique_ptr<ShaderModule>> shaderModules;
+		std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
+		std::vector<VkSpecializationInfo> specializationInfos;
+
+		specializationInfos.reserve(stages_.size());
+
+		for (const auto& stage : stages_)
+		{
+			shaderModules.emplace_back(new ShaderModule(device_, stage.Code));
+			shaderStages.push_back(shaderModules.back()->CreateShaderStage(stage.Flag));
+
+			if (!stage.Constants.Empty())
+			{
+				specializationInfos.push_back(stage.Constants.Info());
+				shaderStages.back().pSpecializationInfo = &specializationInfos.back();
+			}
+		}
+
+		VkGraphicsPipelineCreateInfo pipelineInfo = {};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
+		pipelineInfo.pStages = shaderStages.data();
+		pipelineInfo.pVertexInputState = &vertexInputInfo;
+		pipelineInfo.pInputAssemblyState = &inputAssembly;
+		pipelineInfo.pViewportState = &viewportState;
+		pipelineInfo.pRasterizationState = &rasterizer;
+		pipelineInfo.pMultisampleState = &multisampling;
+		pipelineInfo.pDepthStencilState = &depthStencil;
+		pipelineInfo.pColorBlendState = &colorBlending;
+		pipelineInfo.pDynamicState = dynamicViewport ? &dynamicState : nullptr;
+		pipelineInfo.basePipelineHandle = nullptr;
+		pipelineInfo.basePipelineIndex = -1;
+		pipelineInfo.layout = layout.Handle();
+		pipelineInfo.renderPass = renderPass;
+		pipelineInfo.subpass = 0;
+
+		return std::make_shared<Pipeline>(device_, device_.PipelineCache().CreateGraphicsPipeline(pipelineInfo, name));
+	}
+
+	uint64_t PipelineBuilder::HashOf(const PipelineState& state)
+	{
+		// Hash field by field, the Vulkan structs and the state itself have padding.
+		uint64_t hash = 0;
+
+		for (const auto& binding : state.VertexBindings)
+		{
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(binding.binding));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(binding.stride));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(binding.inputRate));
+		}
+
+		for (const auto& attribute : state.VertexAttributes)
+		{
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(attribute.location));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(attribute.binding));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(attribute.format));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(attribute.offset));
+		}
+
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.Topology));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.Viewport.width));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.Viewport.height));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.DepthClampEnable));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.PolygonMode));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.CullMode));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.FrontFace));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.DepthTestEnable));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.DepthWriteEnable));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.DepthCompareOp));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.ColorAttachmentCount));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.ColorBlend.blendEnable));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.ColorBlend.srcColorBlendFactor));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.ColorBlend.dstColorBlendFactor));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.ColorBlend.colorBlendOp));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.ColorBlend.srcAlphaBlendFactor));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.ColorBlend.dstAlphaBlendFactor));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.ColorBlend.alphaBlendOp));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(state.ColorBlend.colorWriteMask));
+
+		return hash;
+	}
+
+	uint64_t PipelineBuilder::HashOf(const VkRenderPassCreateInfo& renderPass)
+	{
+		const auto hashReferences = [](uint64_t hash, const VkAttachmentReference* references, const uint32_t count)
+		{
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(count));
+
+			for (uint32_t i = 0; i != count; ++i)
+			{
+				hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(references[i].attachment));
+				hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(references[i].layout));
+			}
+
+			return hash;
+		};
+
+		uint64_t hash = Utilities::Hash::Value(renderPass.flags);
+
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(renderPass.attachmentCount));
+		for (uint32_t i = 0; i != renderPass.attachmentCount; ++i)
+		{
+			const auto& attachment = renderPass.pAttachments[i];
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(attachment.flags));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(attachment.format));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(attachment.samples));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(attachment.loadOp));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(attachment.storeOp));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(attachment.stencilLoadOp));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(attachment.stencilStoreOp));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(attachment.initialLayout));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(attachment.finalLayout));
+		}
+
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(renderPass.subpassCount));
+		for (uint32_t i = 0; i != renderPass.subpassCount; ++i)
+		{
+			const auto& subpass = renderPass.pSubpasses[i];
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(subpass.flags));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(subpass.pipelineBindPoint));
+			hash = hashReferences(hash, subpass.pInputAttachments, subpass.inputAttachmentCount);
+			hash = hashReferences(hash, subpass.pColorAttachments, subpass.colorAttachmentCount);
+			hash = hashReferences(hash, subpass.pResolveAttachments, subpass.pResolveAttachments != nullptr ? subpass.colorAttachmentCount : 0);
+			hash = hashReferences(hash, subpass.pDepthStencilAttachment, subpass.pDepthStencilAttachment != nullptr ? 1 : 0);
+
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(subpass.preserveAttachmentCount));
+			for (uint32_t j = 0; j != subpass.preserveAttachmentCount; ++j)
+			{
+				hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(subpass.pPreserveAttachments[j]));
+			}
+		}
+
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(renderPass.dependencyCount));
+		for (uint32_t i = 0; i != renderPass.dependencyCount; ++i)
+		{
+			const auto& dependency = renderPass.pDependencies[i];
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(dependency.srcSubpass));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(dependency.dstSubpass));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(dependency.srcStageMask));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(dependency.dstStageMask));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(dependency.srcAccessMask));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(dependency.dstAccessMask));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(dependency.dependencyFlags));
+		}
+
+		return hash;
+	}
+
+	bool PipelineBuilder::Equals(const PipelineState& a, const PipelineState& b)
+	{
+		return
+			vk::Equals(a.VertexBindings, b.VertexBindings) &&
+			vk::Equals(a.VertexAttributes, b.VertexAttributes) &&
+			a.Topology == b.Topology &&
+			a.Viewport.width == b.Viewport.width &&
+			a.Viewport.height == b.Viewport.height &&
+			a.DepthClampEnable == b.DepthClampEnable &&
+			a.PolygonMode == b.PolygonMode &&
+			a.CullMode == b.CullMode &&
+			a.FrontFace == b.FrontFace &&
+			a.DepthTestEnable == b.DepthTestEnable &&
+			a.DepthWriteEnable == b.DepthWriteEnable &&
+			a.DepthCompareOp == b.DepthCompareOp &&
+			a.ColorAttachmentCount == b.ColorAttachmentCount &&
+			a.ColorBlend.blendEnable == b.ColorBlend.blendEnable &&
+			a.ColorBlend.srcColorBlendFactor == b.ColorBlend.srcColorBlendFactor &&
+			a.ColorBlend.dstColorBlendFactor == b.ColorBlend.dstColorBlendFactor &&
+			a.ColorBlend.colorBlendOp == b.ColorBlend.colorBlendOp &&
+			a.ColorBlend.srcAlphaBlendFactor == b.ColorBlend.srcAlphaBlendFactor &&
+			a.ColorBlend.dstAlphaBlendFactor == b.ColorBlend.dstAlphaBlendFactor &&
+			a.ColorBlend.alphaBlendOp == b.ColorBlend.alphaBlendOp &&
+			a.ColorBlend.colorWriteMask == b.ColorBlend.colorWriteMask;
+	}
+}
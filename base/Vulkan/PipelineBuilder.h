@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Vulkan/Pipeline.h"
+#include "Vulkan/SpecializationConstants.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace vk
+{
+	class PipelineLayout;
+
+	// Assembles a graphics pipeline from a PipelineState and its shader stages. Build() goes through a
+	// process-wide cache keyed by the state, the SPIR-V and specialization constants of every stage, the
+	// pipeline layout description and the render pass description, so requesting an identical pipeline returns
+	// the existing one. Entries are weak, the pipeline is destroyed when its last user releases it.
+	class PipelineBuilder final
+	{
+	public:
+
+		PipelineBuilder(const PipelineBuilder&) = delete;
+		PipelineBuilder(PipelineBuilder&&) = delete;
+		PipelineBuilder& operator = (const PipelineBuilder&) = delete;
+		PipelineBuilder& operator = (PipelineBuilder&&) = delete;
+
+		PipelineBuilder(const Device& device, const PipelineState& state);
+
+		// Shader modules are only created if the pipeline is not already cached. The constants are part of the
+		// cache key, each set of values is its own pipeline variant.
+		PipelineBuilder& AddStage(VkShaderStageFlagBits stage, std::vector<uint32_t> code, const SpecializationConstants& constants = SpecializationConstants());
+
+		// The render pass must expose Handle() and Hash(), the cache is keyed on the hash since handles of destroyed
+		// render passes get recycled and a cached pipeline works with any compatible render pass.
+		template <class TRenderPass>
+		std::shared_ptr<Pipeline> Build(const PipelineLayout& layout, const TRenderPass& renderPass, const char* name) const
+		{
+			return Build(layout, renderPass.Handle(), renderPass.Hash(), name);
+		}
+
+		static uint64_t HashOf(const PipelineState& state);
+		// Hash of the attachments, subpasses and dependencies, what render pass compatibility depends on.
+		static uint64_t HashOf(const VkRenderPassCreateInfo& renderPass);
+		static bool Equals(const PipelineState& a, const PipelineState& b);
+
+	private:
+
+		struct Stage
+		{
+			VkShaderStageFlagBits Flag;
+			std::vector<uint32_t> Code;
+			SpecializationConstants Constants;
+			uint64_t Hash;
+		};
+
+		struct Entry
+		{
+			VkDevice Device;
+			PipelineState State;
+			std::vector<std::pair<VkShaderStageFlagBits, uint64_t>> Stages;
+			uint64_t Layout;
+			uint64_t RenderPass;
+			std::weak_ptr<vk::Pipeline> Instance;
+		};
+
+		// Looks up a live entry matching key, callers hold mutex_.
+		static std::shared_ptr<Pipeline> Find(uint64_t hash, const Entry& key);
+		std::shared_ptr<Pipeline> Build(const PipelineLayout& layout, VkRenderPass renderPass, uint64_t renderPassHash, const char* name) const;
+		std::shared_ptr<Pipeline> Create(const PipelineLayout& layout, VkRenderPass renderPass, const char* name) const;
+
+		const class Device& device_;
+		const PipelineState state_;
+		std::vector<Stage> stages_;
+
+		static std::mutex mutex_;
+		static std::unordered_multimap<uint64_t, Entry> entries_;
+	};
+}
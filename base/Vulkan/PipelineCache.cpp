@@ -0,0 +1,128 @@
+#include "Vulkan/PipelineCache.h"
+#include "Vulkan/Device.h"
+#include "Vulkan/HostAllocator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace vk {
+
+	namespace
+	{
+		bool IsCompatible(const std::vector<char>& data, VkPhysicalDevice physicalDevice)
+		{
+			VkPipelineCacheHeaderVersionOne header = {};
+
+			if (data.size() < sizeof(header))
+			{
+				return false;
+			}
+
+			std::memcpy(&header, data.data(), sizeof(header));
+
+			VkPhysicalDeviceProperties properties = {};
+			vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+			return
+				header.headerSize >= sizeof(header) &&
+				header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+				header.vendorID == properties.vendorID &&
+				header.deviceID == properties.deviceID &&
+				std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+		}
+	}
+
+	PipelineCache::PipelineCache(const class Device& device, const std::string& filename) :
+		device_(device),
+		filename_(filename)
+	{
+		std::vector<char> data;
+		std::ifstream file(filename_, std::ios::ate | std::ios::binary);
+
+		if (file.is_open())
+		{
+			data.resize(static_cast<size_t>(file.tellg()));
+			file.seekg(0);
+			file.read(data.data(), data.size());
+
+			if (!file || !IsCompatible(data, device.PhysicalDevice()))
+			{
+				data.clear();
+			}
+		}
+
+		warm_ = !data.empty();
+
+		std::cout << "- pipeline cache '" << filename_ << "' " << (warm_ ? "warm, " + std::to_string(data.size()) + " bytes" : std::string("cold")) << std::endl;
+
+		VkPipelineCacheCreateInfo createInfo = {};
+		createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		createInfo.initialDataSize = data.size();
+		createInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+		Check(vkCreatePipelineCache(device.Handle(), &createInfo, device.HostAllocator().Callbacks(VK_OBJECT_TYPE_PIPELINE_CACHE), &pipelineCache_),
+			"create pipeline cache");
+	}
+
+	PipelineCache::~PipelineCache()
+	{
+		if (pipelineCache_ != nullptr)
+		{
+			Save();
+			vkDestroyPipelineCache(device_.Handle(), pipelineCache_, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_PIPELINE_CACHE));
+			pipelineCache_ = nullptr;
+		}
+	}
+
+	VkPipeline PipelineCache::CreateGraphicsPipeline(const VkGraphicsPipelineCreateInfo& createInfo, const char* name) const
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		VkPipeline pipeline{};
+		Check(vkCreateGraphicsPipelines(device_.Handle(), pipelineCache_, 1, &createInfo, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_PIPELINE), &pipeline),
+			"create graphics pipeline");
+
+		const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		// Pipelines may be built on several threads at once, keep their log lines whole.
+		static std::mutex logMutex;
+		std::lock_guard<std::mutex> lock(logMutex);
+		std::cout << "- creating pipeline '" << name << "' (" << (warm_ ? "warm" : "cold") << " cache)... " << elapsed << "ms" << std::endl;
+
+		return pipeline;
+	}
+
+	void PipelineCache::Save() const
+	{
+		// Saving is best effort, a missing cache only costs compile time on the next launch.
+		size_t size = 0;
+		if (vkGetPipelineCacheData(device_.Handle(), pipelineCache_, &size, nullptr) != VK_SUCCESS || size == 0)
+		{
+			return;
+		}
+
+		std::vector<char> data(size);
+		if (vkGetPipelineCacheData(device_.Handle(), pipelineCache_, &size, data.data()) != VK_SUCCESS)
+		{
+			return;
+		}
+
+		// Write through a temporary file so an interrupted save never leaves a truncated cache behind.
+		const std::string temporary = filename_ + ".tmp";
+		{
+			std::ofstream file(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!file.write(data.data(), size))
+			{
+				return;
+			}
+		}
+
+		std::remove(filename_.c_str());
+		std::rename(temporary.c_str(), filename_.c_str());
+	}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Vulkan/VkConfig.h"
+#include <string>
+
+namespace vk
+{
+	class Device;
+
+	// Device wide VkPipelineCache persisted to disk. The file is only reused when its header matches the
+	// vendor, device and pipeline cache UUID of the current physical device; it is written back on destruction.
+	class PipelineCache final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(PipelineCache)
+
+		PipelineCache(const Device& device, const std::string& filename);
+		~PipelineCache();
+
+		const class Device& Device() const { return device_; }
+
+		// True if the cache was seeded from a valid file.
+		bool IsWarm() const { return warm_; }
+
+		// Creates a graphics pipeline through the cache and logs how long the driver took.
+		VkPipeline CreateGraphicsPipeline(const VkGraphicsPipelineCreateInfo& createInfo, const char* name) const;
+
+		void Save() const;
+
+	private:
+
+		const class Device& device_;
+		const std::string filename_;
+		bool warm_{};
+
+		VULKAN_HANDLE(VkPipelineCache, pipelineCache_)
+	};
+
+}
@@ -1,11 +1,15 @@
 #include "Vulkan/PipelineLayout.h"
 #include "Vulkan/DescriptorSetLayout.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/HostAllocator.h"
+#include "Vulkan/ShaderReflection.h"
+#include "Utilities/Hash.h"
 
 namespace vk {
 
 	PipelineLayout::PipelineLayout(const Device& device, const DescriptorSetLayout& descriptorSetLayout) :
-		device_(device)
+		device_(device),
+		hash_(descriptorSetLayout.Hash())
 	{
 		VkDescriptorSetLayout descriptorSetLayouts[] = { descriptorSetLayout.Handle() };
 
@@ -16,31 +20,48 @@ namespace vk {
 		pipelineLayoutInfo.pushConstantRangeCount = 0; // Optional
 		pipelineLayoutInfo.pPushConstantRanges = nullptr; // Optional
 
-		Check(vkCreatePipelineLayout(device_.Handle(), &pipelineLayoutInfo, nullptr, &pipelineLayout_),
+		Check(vkCreatePipelineLayout(device_.Handle(), &pipelineLayoutInfo, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT), &pipelineLayout_),
 			"create pipeline layout");
 	}
 
 	PipelineLayout::PipelineLayout(const Device& device, const DescriptorSetLayout& descriptorSetLayout, const VkPushConstantRange& pushConstantRange) :
-		device_(device)
+		device_(device),
+		hash_(descriptorSetLayout.Hash()),
+		pushConstantStages_(pushConstantRange.stageFlags)
 	{
+		// An empty range (shaders without push constants) creates the same layout as no range.
+		const uint32_t rangeCount = pushConstantRange.size != 0 ? 1 : 0;
+
+		if (rangeCount != 0)
+		{
+			hash_ = Utilities::Hash::Combine(hash_, Utilities::Hash::Value(pushConstantRange.stageFlags));
+			hash_ = Utilities::Hash::Combine(hash_, Utilities::Hash::Value(pushConstantRange.offset));
+			hash_ = Utilities::Hash::Combine(hash_, Utilities::Hash::Value(pushConstantRange.size));
+		}
+
 		VkDescriptorSetLayout descriptorSetLayouts[] = { descriptorSetLayout.Handle() };
 
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
 		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 		pipelineLayoutInfo.setLayoutCount = 1;
 		pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts;
-		pipelineLayoutInfo.pushConstantRangeCount = 1; 
-		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange; 
+		pipelineLayoutInfo.pushConstantRangeCount = rangeCount;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-		Check(vkCreatePipelineLayout(device_.Handle(), &pipelineLayoutInfo, nullptr, &pipelineLayout_),
+		Check(vkCreatePipelineLayout(device_.Handle(), &pipelineLayoutInfo, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT), &pipelineLayout_),
 			"create pipeline layout");
 	}
 
+	PipelineLayout::PipelineLayout(const Device& device, const DescriptorSetLayout& descriptorSetLayout, const ShaderReflection& reflection) :
+		PipelineLayout(device, descriptorSetLayout, reflection.PushConstantRange())
+	{
+	}
+
 	PipelineLayout::~PipelineLayout()
 	{
 		if (pipelineLayout_ != nullptr)
 		{
-			vkDestroyPipelineLayout(device_.Handle(), pipelineLayout_, nullptr);
+			vkDestroyPipelineLayout(device_.Handle(), pipelineLayout_, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_PIPELINE_LAYOUT));
 			pipelineLayout_ = nullptr;
 		}
 	}
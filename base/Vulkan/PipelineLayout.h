@@ -6,6 +6,7 @@ namespace vk
 {
 	class DescriptorSetLayout;
 	class Device;
+	class ShaderReflection;
 
 	class PipelineLayout final
 	{
@@ -15,11 +16,22 @@ namespace vk
 
 		PipelineLayout(const Device& device, const DescriptorSetLayout& descriptorSetLayout);
 		PipelineLayout(const Device& device, const DescriptorSetLayout& descriptorSetLayout, const VkPushConstantRange& pushConstantRange);
+		// Uses the push constant range of the reflected shaders, if they declare any.
+		PipelineLayout(const Device& device, const DescriptorSetLayout& descriptorSetLayout, const ShaderReflection& reflection);
 		~PipelineLayout();
 
+		// Hash of the set layout and push constant description, pipelines built against layouts with equal
+		// hashes are interchangeable.
+		uint64_t Hash() const { return hash_; }
+
+		// Stages to pass to vkCmdPushConstants, zero without push constants.
+		VkShaderStageFlags PushConstantStages() const { return pushConstantStages_; }
+
 	private:
 
 		const Device& device_;
+		uint64_t hash_{};
+		VkShaderStageFlags pushConstantStages_{};
 
 		VULKAN_HANDLE(VkPipelineLayout, pipelineLayout_)
 	};
@@ -1,6 +1,8 @@
 #include "Vulkan/RenderPass.h"
 #include "Vulkan/DepthBuffer.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/HostAllocator.h"
+#include "Vulkan/PipelineBuilder.h"
 #include "Vulkan/SwapChain.h"
 #include <array>
 
@@ -70,7 +72,9 @@ namespace vk {
 		renderPassInfo.dependencyCount = 1;
 		renderPassInfo.pDependencies = &dependency;
 
-		Check(vkCreateRenderPass(swapChain_.Device().Handle(), &renderPassInfo, nullptr, &renderPass_),
+		hash_ = PipelineBuilder::HashOf(renderPassInfo);
+
+		Check(vkCreateRenderPass(swapChain_.Device().Handle(), &renderPassInfo, swapChain_.Device().HostAllocator().Callbacks(VK_OBJECT_TYPE_RENDER_PASS), &renderPass_),
 			"create render pass");
 	}
 
@@ -78,7 +82,7 @@ namespace vk {
 	{
 		if (renderPass_ != nullptr)
 		{
-			vkDestroyRenderPass(swapChain_.Device().Handle(), renderPass_, nullptr);
+			vkDestroyRenderPass(swapChain_.Device().Handle(), renderPass_, swapChain_.Device().HostAllocator().Callbacks(VK_OBJECT_TYPE_RENDER_PASS));
 			renderPass_ = nullptr;
 		}
 	}
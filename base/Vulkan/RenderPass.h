@@ -17,11 +17,16 @@ namespace vk {
 		const class SwapChain& SwapChain() const { return swapChain_; }
 		const class DepthBuffer& DepthBuffer() const { return depthBuffer_; }
 
+		// Hash of the render pass description, see PipelineBuilder::HashOf().
+		uint64_t Hash() const { return hash_; }
+
 	private:
 
 		const class SwapChain& swapChain_;
 		const class DepthBuffer& depthBuffer_;
 
+		uint64_t hash_{};
+
 		VULKAN_HANDLE(VkRenderPass, renderPass_)
 	};
 }
\ No newline at end of file
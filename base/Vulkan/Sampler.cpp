@@ -1,5 +1,6 @@
 #include "Vulkan/Sampler.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/HostAllocator.h"
 #include <stdexcept>
 
 namespace vk {
@@ -25,7 +26,7 @@ namespace vk {
 		samplerInfo.minLod = config.MinLod;
 		samplerInfo.maxLod = config.MaxLod;
 
-		if (vkCreateSampler(device.Handle(), &samplerInfo, nullptr, &sampler_) != VK_SUCCESS)
+		if (vkCreateSampler(device.Handle(), &samplerInfo, device.HostAllocator().Callbacks(VK_OBJECT_TYPE_SAMPLER), &sampler_) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to create sampler");
 		}
@@ -35,7 +36,7 @@ namespace vk {
 	{
 		if (sampler_ != nullptr)
 		{
-			vkDestroySampler(device_.Handle(), sampler_, nullptr);
+			vkDestroySampler(device_.Handle(), sampler_, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_SAMPLER));
 			sampler_ = nullptr;
 		}
 	}
@@ -0,0 +1,83 @@
+#include "Vulkan/SamplerCache.h"
+#include "Vulkan/Device.h"
+#include "Utilities/Hash.h"
+
+namespace vk {
+
+	std::mutex SamplerCache::mutex_;
+	std::unordered_multimap<uint64_t, SamplerCache::Entry> SamplerCache::entries_;
+
+	std::shared_ptr<Sampler> SamplerCache::Acquire(const class Device& device, const SamplerConfig& config)
+	{
+		const auto hash = Utilities::Hash::Combine(HashOf(config), Utilities::Hash::Value(device.Handle()));
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		const auto range = entries_.equal_range(hash);
+		for (auto it = range.first; it != range.second; )
+		{
+			auto sampler = it->second.Instance.lock();
+
+			if (!sampler)
+			{
+				it = entries_.erase(it);
+				continue;
+			}
+
+			if (it->second.Device == device.Handle() && Equals(it->second.Config, config))
+			{
+				return sampler;
+			}
+
+			++it;
+		}
+
+		auto sampler = std::make_shared<Sampler>(device, config);
+		entries_.emplace(hash, Entry{ device.Handle(), config, sampler });
+
+		return sampler;
+	}
+
+	uint64_t SamplerCache::HashOf(const SamplerConfig& config)
+	{
+		// Hash field by field, the struct has padding between the bools and enums.
+		uint64_t hash = 0;
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(config.MagFilter));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(config.MinFilter));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(config.AddressModeU));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(config.AddressModeV));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(config.AddressModeW));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(config.AnisotropyEnable));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(config.MaxAnisotropy));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(config.BorderColor));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(config.UnnormalizedCoordinates));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(config.CompareEnable));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(config.CompareOp));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(config.MipmapMode));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(config.MipLodBias));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(config.MinLod));
+		hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(config.MaxLod));
+
+		return hash;
+	}
+
+	bool SamplerCache::Equals(const SamplerConfig& a, const SamplerConfig& b)
+	{
+		return
+			a.MagFilter == b.MagFilter &&
+			a.MinFilter == b.MinFilter &&
+			a.AddressModeU == b.AddressModeU &&
+			a.AddressModeV == b.AddressModeV &&
+			a.AddressModeW == b.AddressModeW &&
+			a.AnisotropyEnable == b.AnisotropyEnable &&
+			a.MaxAnisotropy == b.MaxAnisotropy &&
+			a.BorderColor == b.BorderColor &&
+			a.UnnormalizedCoordinates == b.UnnormalizedCoordinates &&
+			a.CompareEnable == b.CompareEnable &&
+			a.CompareOp == b.CompareOp &&
+			a.MipmapMode == b.MipmapMode &&
+			a.MipLodBias == b.MipLodBias &&
+			a.MinLod == b.MinLod &&
+			a.MaxLod == b.MaxLod;
+	}
+}
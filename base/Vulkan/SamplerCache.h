@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Vulkan/Sampler.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace vk
+{
+	// Process-wide cache handing out one reference counted sampler per (device, SamplerConfig).
+	// Entries are weak, the sampler is destroyed when its last user releases it.
+	class SamplerCache final
+	{
+	public:
+
+		static std::shared_ptr<Sampler> Acquire(const Device& device, const SamplerConfig& config);
+
+		static uint64_t HashOf(const SamplerConfig& config);
+		static bool Equals(const SamplerConfig& a, const SamplerConfig& b);
+
+	private:
+
+		struct Entry
+		{
+			VkDevice Device;
+			SamplerConfig Config;
+			std::weak_ptr<vk::Sampler> Instance;
+		};
+
+		static std::mutex mutex_;
+		static std::unordered_multimap<uint64_t, Entry> entries_;
+	};
+}
@@ -1,5 +1,6 @@
 #include "Vulkan/Semaphore.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/HostAllocator.h"
 
 namespace vk {
 
@@ -9,7 +10,7 @@ namespace vk {
 		VkSemaphoreCreateInfo semaphoreInfo = {};
 		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-		Check(vkCreateSemaphore(device.Handle(), &semaphoreInfo, nullptr, &semaphore_),
+		Check(vkCreateSemaphore(device.Handle(), &semaphoreInfo, device.HostAllocator().Callbacks(VK_OBJECT_TYPE_SEMAPHORE), &semaphore_),
 			"create semaphores");
 	}
 
@@ -24,7 +25,7 @@ namespace vk {
 	{
 		if (semaphore_ != nullptr)
 		{
-			vkDestroySemaphore(device_.Handle(), semaphore_, nullptr);
+			vkDestroySemaphore(device_.Handle(), semaphore_, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_SEMAPHORE));
 			semaphore_ = nullptr;
 		}
 	}
@@ -1,14 +1,207 @@
 #include "Vulkan/ShaderModule.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/HostAllocator.h"
+#include "Utilities/Hash.h"
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <fstream>
 #include <sstream>
+#include <unordered_map>
+
+#ifdef VULKAN_RUNTIME_SHADERS
+#include <shaderc/shaderc.hpp>
+#endif
 
 namespace vk {
 
+	namespace
+	{
+		std::unordered_map<std::string, EmbeddedShader>& EmbeddedShaders()
+		{
+			static std::unordered_map<std::string, EmbeddedShader> shaders;
+			return shaders;
+		}
+
+#ifdef VULKAN_RUNTIME_SHADERS
+		// Bump when the cached binaries must be invalidated without any source change.
+		const uint32_t SpirvCacheVersion = 1;
+		const uint32_t SpirvMagic = 0x07230203;
+
+		std::string ReadText(const std::string& filename)
+		{
+			std::ifstream fin(filename, std::ios::in | std::ios::binary);
+
+			if (!fin.is_open()) {
+				throw std::runtime_error("failed to open shader file '" + filename + "'");
+			}
+
+			std::stringstream ss;
+			ss << fin.rdbuf();
+
+			return ss.str();
+		}
+
+		// Returns an empty vector if the file is missing or is not a SPIR-V module.
+		std::vector<uint32_t> ReadSpirv(const std::filesystem::path& path)
+		{
+			std::ifstream fin(path, std::ios::ate | std::ios::binary);
+
+			if (!fin.is_open()) {
+				return {};
+			}
+
+			const auto size = static_cast<size_t>(fin.tellg());
+			if (size < 5 * sizeof(uint32_t) || size % sizeof(uint32_t) != 0) {
+				return {};
+			}
+
+			std::vector<uint32_t> code(size / sizeof(uint32_t));
+			fin.seekg(0);
+			fin.read(reinterpret_cast<char*>(code.data()), size);
+
+			if (!fin || code[0] != SpirvMagic) {
+				return {};
+			}
+
+			return code;
+		}
+
+		// Writes through a temporary file so a concurrent reader never sees a partial module.
+		// The cache is an optimization only, failing to write it is not an error.
+		void WriteSpirv(const std::filesystem::path& directory, const std::filesystem::path& path, const std::vector<uint32_t>& code)
+		{
+			std::error_code error;
+			std::filesystem::create_directories(directory, error);
+
+			auto temporary = path;
+			temporary += ".tmp";
+
+			{
+				std::ofstream fout(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+				if (!fout.write(reinterpret_cast<const char*>(code.data()), code.size() * sizeof(uint32_t))) {
+					return;
+				}
+			}
+
+			std::filesystem::rename(temporary, path, error);
+		}
+
+		// A file the compiled code depends on, with its modification time when it was read.
+		struct Dependency
+		{
+			std::filesystem::path Path;
+			std::filesystem::file_time_type Time;
+		};
+
+		std::filesystem::file_time_type WriteTime(const std::filesystem::path& path)
+		{
+			std::error_code error;
+			const auto time = std::filesystem::last_write_time(path, error);
+
+			return error ? std::filesystem::file_time_type::min() : time;
+		}
+
+		bool IsCurrent(const std::vector<Dependency>& dependencies)
+		{
+			for (const auto& dependency : dependencies) {
+				if (WriteTime(dependency.Path) != dependency.Time) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		// Resolves #include relative to the including file, then relative to the working directory. Every file
+		// it is asked for is added to dependencies, missing ones included.
+		class Includer final : public shaderc::CompileOptions::IncluderInterface
+		{
+		public:
+
+			explicit Includer(std::vector<Dependency>& dependencies) :
+				dependencies_(dependencies)
+			{
+			}
+
+			shaderc_include_result* GetInclude(const char* requestedSource, shaderc_include_type type, const char* requestingSource, size_t) override
+			{
+				auto include = std::make_unique<Include>();
+
+				auto path = std::filesystem::path(requestedSource);
+				if (type == shaderc_include_type_relative) {
+					path = std::filesystem::path(requestingSource).parent_path() / path;
+				}
+
+				// Taken before reading, a change made meanwhile invalidates the memo.
+				dependencies_.push_back({ path, WriteTime(path) });
+
+				std::ifstream fin(path, std::ios::in | std::ios::binary);
+				if (fin.is_open()) {
+					std::stringstream ss;
+					ss << fin.rdbuf();
+
+					include->Name = path.generic_string();
+					include->Content = ss.str();
+				}
+				else {
+					// An empty name tells shaderc the include failed, the content is the error message.
+					include->Content = "cannot open include file '" + path.generic_string() + "'";
+				}
+
+				include->Result.source_name = include->Name.c_str();
+				include->Result.source_name_length = include->Name.size();
+				include->Result.content = include->Content.c_str();
+				include->Result.content_length = include->Content.size();
+				include->Result.user_data = include.get();
+
+				return &include.release()->Result;
+			}
+
+			void ReleaseInclude(shaderc_include_result* data) override
+			{
+				delete static_cast<Include*>(data->user_data);
+			}
+
+		private:
+
+			struct Include
+			{
+				std::string Name;
+				std::string Content;
+				shaderc_include_result Result{};
+			};
+
+			std::vector<Dependency>& dependencies_;
+		};
+
+		shaderc_shader_kind ShaderKind(const std::string& filename)
+		{
+			static const std::unordered_map<std::string, shaderc_shader_kind> kinds =
+			{
+				{".vert", shaderc_glsl_vertex_shader},
+				{".frag", shaderc_glsl_fragment_shader},
+				{".comp", shaderc_glsl_compute_shader},
+				{".geom", shaderc_glsl_geometry_shader},
+				{".tesc", shaderc_glsl_tess_control_shader},
+				{".tese", shaderc_glsl_tess_evaluation_shader}
+			};
+
+			const auto kind = kinds.find(std::filesystem::path(filename).extension().string());
+			if (kind == kinds.end()) {
+				throw std::runtime_error("unknown shader stage for '" + filename + "'");
+			}
+
+			return kind->second;
+		}
+#endif
+	}
+
 	// for .spv
 	ShaderModule::ShaderModule(const class Device& device, const std::string& filename) :
-		ShaderModule(device, ReadFile(filename))
+		ShaderModule(device, ReadBinaryFile(filename))
 	{
 	}
 
@@ -20,7 +213,7 @@ namespace vk {
 		createInfo.codeSize = code.size();
 		createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
 
-		Check(vkCreateShaderModule(device.Handle(), &createInfo, nullptr, &shaderModule_),
+		Check(vkCreateShaderModule(device.Handle(), &createInfo, device.HostAllocator().Callbacks(VK_OBJECT_TYPE_SHADER_MODULE), &shaderModule_),
 			"create shader module");
 	}
 
@@ -33,7 +226,7 @@ namespace vk {
 		createInfo.codeSize = code.size() * 4;
 		createInfo.pCode = code.data();
 
-		Check(vkCreateShaderModule(device.Handle(), &createInfo, nullptr, &shaderModule_),
+		Check(vkCreateShaderModule(device.Handle(), &createInfo, device.HostAllocator().Callbacks(VK_OBJECT_TYPE_SHADER_MODULE), &shaderModule_),
 			"create shader module");
 	}
 
@@ -41,7 +234,7 @@ namespace vk {
 	{
 		if (shaderModule_ != nullptr)
 		{
-			vkDestroyShaderModule(device_.Handle(), shaderModule_, nullptr);
+			vkDestroyShaderModule(device_.Handle(), shaderModule_, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_SHADER_MODULE));
 			shaderModule_ = nullptr;
 		}
 	}
@@ -57,7 +250,7 @@ namespace vk {
 		return createInfo;
 	}
 
-	std::vector<char> ShaderModule::ReadFile(const std::string& filename)
+	std::vector<char> ShaderModule::ReadBinaryFile(const std::string& filename)
 	{
 		std::ifstream file(filename, std::ios::ate | std::ios::binary);
 
@@ -76,24 +269,56 @@ namespace vk {
 		return buffer;
 	}
 
-	std::vector<uint32_t> ShaderModule::ReadFile(const std::string& filename,
-		shaderc_shader_kind kind,
-		bool optimize)
+	void ShaderModule::RegisterEmbedded(const EmbeddedShader* shaders, const size_t count)
 	{
-		static auto read_file = [](const std::string& fn)->std::string {
-			std::ifstream fin(fn, std::ios::in | std::ios::binary);
+		for (size_t i = 0; i != count; ++i)
+		{
+			EmbeddedShaders()[shaders[i].Name] = shaders[i];
+		}
+	}
 
-			if (!fin.is_open()) {
-                            throw std::runtime_error("failed to open shader file '" + fn + "'");
-                        }
+#ifndef VULKAN_RUNTIME_SHADERS
 
-			std::stringstream ss;
-			ss << fin.rdbuf();
+	std::vector<uint32_t> ShaderModule::ReadFile(const std::string& filename, bool)
+	{
+		const auto shader = EmbeddedShaders().find(std::filesystem::path(filename).filename().string());
 
-			return ss.str();
+		if (shader == EmbeddedShaders().end())
+		{
+			throw std::runtime_error("shader '" + filename + "' is not embedded (build with the runtime_shaders option to compile it from source)");
+		}
+
+		return std::vector<uint32_t>(shader->second.Code, shader->second.Code + shader->second.Size);
+	}
+
+#else
+
+	std::vector<uint32_t> ShaderModule::ReadFile(const std::string& filename, bool optimize)
+	{
+		const shaderc_shader_kind kind = ShaderKind(filename);
+
+		struct Memo
+		{
+			std::vector<Dependency> Dependencies;
+			std::vector<uint32_t> Code;
 		};
 
-		std::string source = read_file(filename);
+		static std::mutex mutex;
+		static std::unordered_map<std::string, Memo> memoized;
+
+		const std::string memoKey = filename + (optimize ? "|optimized" : "|");
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			const auto found = memoized.find(memoKey);
+			if (found != memoized.end() && IsCurrent(found->second.Dependencies)) {
+				return found->second.Code;
+			}
+		}
+
+		std::vector<Dependency> dependencies = { { filename, WriteTime(filename) } };
+		const std::string source = ReadText(filename);
 
 		shaderc::Compiler compiler;
 		shaderc::CompileOptions options;
@@ -104,14 +329,52 @@ namespace vk {
 			options.SetOptimizationLevel(shaderc_optimization_level_size);
 		}
 
-		shaderc::SpvCompilationResult module =
-			compiler.CompileGlslToSpv(source, kind, filename.c_str(), options);
+		options.SetIncluder(std::make_unique<Includer>(dependencies));
+
+		// Expand includes and macros first so the key changes whenever any input does.
+		shaderc::PreprocessedSourceCompilationResult preprocessed =
+			compiler.PreprocessGlsl(source, kind, filename.c_str(), options);
+
+		if (preprocessed.GetCompilationStatus() != shaderc_compilation_status_success) {
+			throw std::runtime_error("failed to preprocess shader '" + filename + "':\n" + preprocessed.GetErrorMessage());
+		}
+
+		const std::string expanded(preprocessed.cbegin(), preprocessed.cend());
+
+		uint64_t key = Utilities::Hash::Bytes(expanded.data(), expanded.size());
+		key = Utilities::Hash::Combine(key, Utilities::Hash::Value(static_cast<uint32_t>(kind)));
+		key = Utilities::Hash::Combine(key, Utilities::Hash::Value(static_cast<uint32_t>(optimize)));
+		key = Utilities::Hash::Combine(key, Utilities::Hash::Value(SpirvCacheVersion));
+
+		char name[17];
+		std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+
+		const auto cacheDirectory = std::filesystem::path(filename).parent_path() / ".spirv-cache";
+		const auto cachePath = cacheDirectory / (std::string(name) + ".spv");
 
-		if (module.GetCompilationStatus() != shaderc_compilation_status_success) {
-			return std::vector<uint32_t>();
+		std::vector<uint32_t> code = ReadSpirv(cachePath);
+
+		if (code.empty()) {
+			shaderc::SpvCompilationResult module =
+				compiler.CompileGlslToSpv(expanded, kind, filename.c_str(), options);
+
+			if (module.GetCompilationStatus() != shaderc_compilation_status_success) {
+				throw std::runtime_error("failed to compile shader '" + filename + "':\n" + module.GetErrorMessage());
+			}
+
+			code.assign(module.cbegin(), module.cend());
+			WriteSpirv(cacheDirectory, cachePath, code);
 		}
 
-		return { module.cbegin(), module.cend() };
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto& memo = memoized[memoKey];
+		memo.Dependencies = std::move(dependencies);
+		memo.Code = std::move(code);
+
+		return memo.Code;
 	}
 
+#endif
+
 }
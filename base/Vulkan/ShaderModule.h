@@ -1,7 +1,7 @@
 #pragma once
 
 #include "Vulkan/VkConfig.h"
-#include <shaderc/shaderc.hpp>
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -9,6 +9,14 @@ namespace vk
 {
 	class Device;
 
+	// SPIR-V compiled at build time by the embed_spirv rule, Name is the GLSL file name (e.g. "scene.frag").
+	struct EmbeddedShader
+	{
+		const char* Name;
+		const uint32_t* Code;
+		size_t Size;
+	};
+
 	class ShaderModule final
 	{
 	public:
@@ -23,11 +31,21 @@ namespace vk
 		const class Device& Device() const { return device_; }
 
 		VkPipelineShaderStageCreateInfo CreateShaderStage(VkShaderStageFlagBits stage) const;
-		static std::vector<uint32_t> ReadFile(const std::string& filename, shaderc_shader_kind kind, bool optimize = false);
+
+		// Returns the SPIR-V of a GLSL stage, the stage kind follows the file extension. By default this is the
+		// embedded copy registered under the file name of filename. Building with VULKAN_RUNTIME_SHADERS compiles
+		// the file with shaderc instead; results are then memoized per file and options for as long as the file
+		// and its includes keep their modification times, so a hit skips preprocessing, and cached on disk in a
+		// .spirv-cache directory next to the source, keyed by the preprocessed source (includes expanded), the
+		// shader kind and the compile options. Throws if the shader is missing or fails to compile.
+		static std::vector<uint32_t> ReadFile(const std::string& filename, bool optimize = false);
+
+		// Makes build time compiled shaders available to ReadFile(), call before creating any pipeline.
+		static void RegisterEmbedded(const EmbeddedShader* shaders, size_t count);
 
 	private:
 
-		static std::vector<char> ReadFile(const std::string& filename);
+		static std::vector<char> ReadBinaryFile(const std::string& filename);
 
 		const class Device& device_;
 
@@ -0,0 +1,433 @@
+#include "Vulkan/ShaderReflection.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace vk {
+
+	namespace
+	{
+		// The subset of the SPIR-V specification needed to find descriptors and push constants.
+		const uint32_t SpirvMagic = 0x07230203;
+
+		enum Opcode : uint32_t
+		{
+			OpTypeBool = 20,
+			OpTypeInt = 21,
+			OpTypeFloat = 22,
+			OpTypeVector = 23,
+			OpTypeMatrix = 24,
+			OpTypeImage = 25,
+			OpTypeSampler = 26,
+			OpTypeSampledImage = 27,
+			OpTypeArray = 28,
+			OpTypeRuntimeArray = 29,
+			OpTypeStruct = 30,
+			OpTypePointer = 32,
+			OpConstant = 43,
+			OpSpecConstant = 50,
+			OpVariable = 59,
+			OpDecorate = 71,
+			OpMemberDecorate = 72,
+			OpTypeAccelerationStructureKHR = 5341
+		};
+
+		enum Decoration : uint32_t
+		{
+			DecorationBufferBlock = 3,
+			DecorationArrayStride = 6,
+			DecorationMatrixStride = 7,
+			DecorationBinding = 33,
+			DecorationDescriptorSet = 34,
+			DecorationOffset = 35
+		};
+
+		enum StorageClass : uint32_t
+		{
+			StorageClassUniformConstant = 0,
+			StorageClassUniform = 2,
+			StorageClassPushConstant = 9,
+			StorageClassStorageBuffer = 12
+		};
+
+		const uint32_t DimBuffer = 5;
+		const uint32_t DimSubpassData = 6;
+
+		class Module final
+		{
+		public:
+
+			explicit Module(const std::vector<uint32_t>& code)
+			{
+				if (code.size() < 5 || code[0] != SpirvMagic)
+				{
+					throw std::runtime_error("shader reflection: not a SPIR-V module");
+				}
+
+				for (size_t i = 5; i < code.size(); )
+				{
+					const uint32_t opcode = code[i] & 0xffff;
+					const uint32_t wordCount = code[i] >> 16;
+
+					if (wordCount == 0 || i + wordCount > code.size())
+					{
+						throw std::runtime_error("shader reflection: truncated SPIR-V module");
+					}
+
+					const uint32_t* words = code.data() + i;
+
+					switch (opcode)
+					{
+					case OpDecorate:
+						decorations_[words[1]][words[2]] = wordCount > 3 ? words[3] : 0;
+						break;
+
+					case OpMemberDecorate:
+						memberDecorations_[{ words[1], words[2] }][words[3]] = wordCount > 4 ? words[4] : 0;
+						break;
+
+					case OpConstant:
+					case OpSpecConstant:
+						// Spec constants used as array lengths count with their default value.
+						constants_[words[2]] = words[3];
+						break;
+
+					case OpVariable:
+						variables_.push_back({ words[2], words[1], words[3] });
+						break;
+
+					case OpTypeBool:
+					case OpTypeInt:
+					case OpTypeFloat:
+					case OpTypeVector:
+					case OpTypeMatrix:
+					case OpTypeImage:
+					case OpTypeSampler:
+					case OpTypeSampledImage:
+					case OpTypeArray:
+					case OpTypeRuntimeArray:
+					case OpTypeStruct:
+					case OpTypePointer:
+					case OpTypeAccelerationStructureKHR:
+						types_[words[1]] = { opcode, std::vector<uint32_t>(words + 2, words + wordCount) };
+						break;
+
+					default:
+						break;
+					}
+
+					i += wordCount;
+				}
+			}
+
+			struct Variable
+			{
+				uint32_t Id;
+				uint32_t PointerType;
+				uint32_t StorageClass;
+			};
+
+			struct Type
+			{
+				uint32_t Opcode;
+				std::vector<uint32_t> Operands;
+			};
+
+			const std::vector<Variable>& Variables() const { return variables_; }
+
+			const Type& TypeOf(const uint32_t id) const
+			{
+				const auto type = types_.find(id);
+
+				if (type == types_.end())
+				{
+					throw std::runtime_error("shader reflection: undefined type %" + std::to_string(id));
+				}
+
+				return type->second;
+			}
+
+			bool HasDecoration(const uint32_t id, const uint32_t decoration) const
+			{
+				const auto found = decorations_.find(id);
+				return found != decorations_.end() && found->second.count(decoration) != 0;
+			}
+
+			uint32_t DecorationOf(const uint32_t id, const uint32_t decoration, const uint32_t fallback = 0) const
+			{
+				const auto found = decorations_.find(id);
+				if (found == decorations_.end()) return fallback;
+
+				const auto value = found->second.find(decoration);
+				return value == found->second.end() ? fallback : value->second;
+			}
+
+			uint32_t MemberDecorationOf(const uint32_t id, const uint32_t member, const uint32_t decoration, const uint32_t fallback = 0) const
+			{
+				const auto found = memberDecorations_.find({ id, member });
+				if (found == memberDecorations_.end()) return fallback;
+
+				const auto value = found->second.find(decoration);
+				return value == found->second.end() ? fallback : value->second;
+			}
+
+			uint32_t ConstantOf(const uint32_t id) const
+			{
+				const auto constant = constants_.find(id);
+
+				if (constant == constants_.end())
+				{
+					throw std::runtime_error("shader reflection: array length %" + std::to_string(id) + " is not a constant");
+				}
+
+				return constant->second;
+			}
+
+			// Size in bytes of a type inside an explicitly laid out block.
+			uint32_t SizeOf(const uint32_t id, const uint32_t matrixStride = 0) const
+			{
+				const auto& type = TypeOf(id);
+
+				switch (type.Opcode)
+				{
+				case OpTypeBool:
+					return 4;
+
+				case OpTypeInt:
+				case OpTypeFloat:
+					return type.Operands[0] / 8;
+
+				case OpTypeVector:
+					return type.Operands[1] * SizeOf(type.Operands[0]);
+
+				case OpTypeMatrix:
+					return type.Operands[1] * (matrixStride != 0 ? matrixStride : SizeOf(type.Operands[0]));
+
+				case OpTypeArray:
+					return ConstantOf(type.Operands[1]) * DecorationOf(id, DecorationArrayStride, SizeOf(type.Operands[0], matrixStride));
+
+				case OpTypeStruct:
+				{
+					uint32_t size = 0;
+
+					for (uint32_t member = 0; member != type.Operands.size(); ++member)
+					{
+						const uint32_t offset = MemberDecorationOf(id, member, DecorationOffset);
+						size = std::max(size, offset + SizeOf(type.Operands[member], MemberDecorationOf(id, member, DecorationMatrixStride)));
+					}
+
+					return size;
+				}
+
+				default:
+					throw std::runtime_error("shader reflection: type %" + std::to_string(id) + " has no size in a block");
+				}
+			}
+
+		private:
+
+			std::unordered_map<uint32_t, Type> types_;
+			std::unordered_map<uint32_t, uint32_t> constants_;
+			std::unordered_map<uint32_t, std::unordered_map<uint32_t, uint32_t>> decorations_;
+			std::map<std::pair<uint32_t, uint32_t>, std::unordered_map<uint32_t, uint32_t>> memberDecorations_;
+			std::vector<Variable> variables_;
+		};
+
+		VkDescriptorType DescriptorTypeOf(const Module& module, const uint32_t storageClass, const uint32_t typeId, const Module::Type& type)
+		{
+			if (storageClass == StorageClassStorageBuffer)
+			{
+				return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			}
+
+			if (storageClass == StorageClassUniform)
+			{
+				return module.HasDecoration(typeId, DecorationBufferBlock) ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			}
+
+			switch (type.Opcode)
+			{
+			case OpTypeSampledImage:
+				return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+			case OpTypeSampler:
+				return VK_DESCRIPTOR_TYPE_SAMPLER;
+
+			case OpTypeAccelerationStructureKHR:
+				return VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+
+			case OpTypeImage:
+			{
+				// Operands: sampled type, dim, depth, arrayed, multisampled, sampled (1 = sampled, 2 = storage).
+				const uint32_t dim = type.Operands[1];
+				const bool storage = type.Operands[5] == 2;
+
+				if (dim == DimSubpassData) return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+				if (dim == DimBuffer) return storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+
+				return storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+			}
+
+			default:
+				throw std::runtime_error("shader reflection: unsupported resource type %" + std::to_string(typeId));
+			}
+		}
+	}
+
+	void ShaderReflection::AddStage(const VkShaderStageFlagBits stage, const std::vector<uint32_t>& code)
+	{
+		const Module module(code);
+
+		for (const auto& variable : module.Variables())
+		{
+			const auto storageClass = variable.StorageClass;
+
+			if (storageClass != StorageClassUniformConstant &&
+				storageClass != StorageClassUniform &&
+				storageClass != StorageClassStorageBuffer &&
+				storageClass != StorageClassPushConstant)
+			{
+				continue;
+			}
+
+			uint32_t typeId = module.TypeOf(variable.PointerType).Operands[1];
+
+			if (storageClass == StorageClassPushConstant)
+			{
+				const auto& block = module.TypeOf(typeId);
+				uint32_t begin = UINT32_MAX;
+				uint32_t end = 0;
+
+				for (uint32_t member = 0; member != block.Operands.size(); ++member)
+				{
+					const uint32_t offset = module.MemberDecorationOf(typeId, member, DecorationOffset);
+					const uint32_t size = module.SizeOf(block.Operands[member], module.MemberDecorationOf(typeId, member, DecorationMatrixStride));
+
+					begin = std::min(begin, offset);
+					end = std::max(end, offset + size);
+				}
+
+				if (begin >= end)
+				{
+					continue;
+				}
+
+				if (pushConstantRange_.size != 0)
+				{
+					end = std::max(end, pushConstantRange_.offset + pushConstantRange_.size);
+					begin = std::min(begin, pushConstantRange_.offset);
+				}
+
+				pushConstantRange_.stageFlags |= stage;
+				pushConstantRange_.offset = begin;
+				pushConstantRange_.size = end - begin;
+				continue;
+			}
+
+			if (module.DecorationOf(variable.Id, DecorationDescriptorSet) != 0)
+			{
+				throw std::runtime_error("shader reflection: only descriptor set 0 is supported");
+			}
+
+			// Arrays of resources become the descriptor count, runtime arrays have none until SetDescriptorCount().
+			uint32_t count = 1;
+
+			for (;;)
+			{
+				const auto& type = module.TypeOf(typeId);
+
+				if (type.Opcode == OpTypeArray)
+				{
+					count *= module.ConstantOf(type.Operands[1]);
+				}
+				else if (type.Opcode == OpTypeRuntimeArray)
+				{
+					count = 0;
+				}
+				else
+				{
+					break;
+				}
+
+				typeId = type.Operands[0];
+			}
+
+			const uint32_t binding = module.DecorationOf(variable.Id, DecorationBinding);
+			const auto type = DescriptorTypeOf(module, storageClass, typeId, module.TypeOf(typeId));
+
+			const auto inserted = bindings_.insert({ binding, DescriptorBinding{ binding, count, type, static_cast<VkShaderStageFlags>(stage) } });
+
+			if (!inserted.second)
+			{
+				auto& existing = inserted.first->second;
+
+				if (existing.Type != type)
+				{
+					throw std::runtime_error("shader reflection: stages disagree on the type of binding " + std::to_string(binding));
+				}
+
+				existing.DescriptorCount = existing.DescriptorCount == 0 || count == 0 ? 0 : std::max(existing.DescriptorCount, count);
+				existing.Stage |= stage;
+			}
+		}
+	}
+
+	void ShaderReflection::SetDescriptorCount(const uint32_t binding, const uint32_t count)
+	{
+		descriptorCounts_[binding] = count;
+	}
+
+	void ShaderReflection::SetDynamic(const uint32_t binding)
+	{
+		dynamicBindings_.insert(binding);
+	}
+
+	std::vector<DescriptorBinding> ShaderReflection::DescriptorBindings() const
+	{
+		std::vector<DescriptorBinding> bindings;
+		bindings.reserve(bindings_.size());
+
+		for (const auto& entry : bindings_)
+		{
+			auto binding = entry.second;
+			const auto count = descriptorCounts_.find(binding.Binding);
+
+			if (count != descriptorCounts_.end())
+			{
+				binding.DescriptorCount = count->second;
+			}
+
+			if (dynamicBindings_.count(binding.Binding) != 0)
+			{
+				if (binding.Type != VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+				{
+					throw std::runtime_error("shader reflection: binding " + std::to_string(binding.Binding) + " is not a uniform buffer and cannot be dynamic");
+				}
+
+				binding.Type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+			}
+
+			if (binding.DescriptorCount == 0)
+			{
+				throw std::runtime_error("shader reflection: binding " + std::to_string(binding.Binding) + " is a runtime array without a descriptor count");
+			}
+
+			bindings.push_back(binding);
+		}
+
+		return bindings;
+	}
+
+	void ShaderReflection::CheckPushConstantSize(const size_t size) const
+	{
+		const size_t end = pushConstantRange_.offset + pushConstantRange_.size;
+
+		if (end != size)
+		{
+			throw std::runtime_error("shader reflection: push constants end at byte " + std::to_string(end) + " in the shaders but the host block is " + std::to_string(size) + " bytes");
+		}
+	}
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Vulkan/DescriptorBinding.h"
+#include <map>
+#include <set>
+#include <vector>
+
+namespace vk
+{
+	// Descriptor bindings and push constants declared by a set of SPIR-V stages. Bindings used by several
+	// stages are merged into one with the union of their stage flags, and all push constant blocks into a
+	// single range. Only descriptor set 0 is supported, like the rest of the pipelines.
+	class ShaderReflection final
+	{
+	public:
+
+		// Throws if the module is not valid SPIR-V, uses another descriptor set, or declares a binding with
+		// a different type than an earlier stage.
+		void AddStage(VkShaderStageFlagBits stage, const std::vector<uint32_t>& code);
+
+		// Overrides the array size of a binding, for texture arrays whose length is only known at run time
+		// (unsized or implicitly sized by the indices the shader uses).
+		void SetDescriptorCount(uint32_t binding, uint32_t count);
+
+		// Turns a uniform buffer binding into VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, e.g. for UniformRing
+		// data. Shaders declare both the same way.
+		void SetDynamic(uint32_t binding);
+
+		// Sorted by binding. Throws if a runtime sized array was not given a count.
+		std::vector<DescriptorBinding> DescriptorBindings() const;
+
+		// Covers every push constant member of every stage, size zero if there are none.
+		const VkPushConstantRange& PushConstantRange() const { return pushConstantRange_; }
+
+		// Throws unless the push constant blocks end exactly at size, the size of the host side struct.
+		void CheckPushConstantSize(size_t size) const;
+
+	private:
+
+		std::map<uint32_t, DescriptorBinding> bindings_;
+		std::map<uint32_t, uint32_t> descriptorCounts_;
+		std::set<uint32_t> dynamicBindings_;
+		VkPushConstantRange pushConstantRange_{};
+	};
+
+}
@@ -0,0 +1,125 @@
+#include "Vulkan/ShaderReloader.h"
+#include "Utilities/FileWatcher.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <initializer_list>
+#include <iostream>
+#include <stdexcept>
+
+namespace vk {
+
+	namespace
+	{
+		bool HasExtension(const std::filesystem::path& path, std::initializer_list<const char*> extensions)
+		{
+			const auto extension = path.extension().string();
+
+			return std::find_if(extensions.begin(), extensions.end(), [&](const char* candidate) { return extension == candidate; }) != extensions.end();
+		}
+	}
+
+	// A single worker: reloads are rare and should not compete with the render thread.
+	ShaderReloader::ShaderReloader(const std::vector<std::string>& directories, const uint32_t framesInFlight) :
+		framesInFlight_(framesInFlight),
+		threadPool_(1)
+	{
+#ifdef VULKAN_RUNTIME_SHADERS
+		watcher_.reset(new Utilities::FileWatcher(directories));
+#endif
+	}
+
+	ShaderReloader::~ShaderReloader()
+	{
+	}
+
+	bool ShaderReloader::Update()
+	{
+		++frame_;
+
+		// Nothing references a retired pipeline once the frames recorded before its replacement have completed.
+		retired_.erase(std::remove_if(retired_.begin(), retired_.end(), [this](const Retired& retired)
+			{
+				return frame_ - retired.Frame >= framesInFlight_;
+			}), retired_.end());
+
+		if (watcher_)
+		{
+			for (const auto& path : watcher_->TakeChanges())
+			{
+				MarkDirty(path);
+			}
+		}
+
+		bool replaced = false;
+
+		for (auto& entry : entries_)
+		{
+			if (entry.Pending.valid())
+			{
+				if (entry.Pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				{
+					continue;
+				}
+
+				try
+				{
+					const auto install = entry.Pending.get();
+					retired_.push_back({ frame_, install() });
+					replaced = true;
+				}
+				catch (const std::exception& exception)
+				{
+					// Keep drawing with the previous pipeline until the shader is fixed.
+					std::cerr << "ERROR: shader reload: " << exception.what() << std::endl;
+				}
+			}
+
+			if (entry.Dirty)
+			{
+				entry.Dirty = false;
+				entry.Pending = threadPool_.Submit(entry.Rebuild);
+			}
+		}
+
+		return replaced;
+	}
+
+	void ShaderReloader::Drain()
+	{
+		for (auto& entry : entries_)
+		{
+			if (entry.Pending.valid())
+			{
+				entry.Pending.wait();
+				entry.Pending = std::future<Install>();
+				entry.Dirty = true;
+			}
+		}
+
+		retired_.clear();
+	}
+
+	void ShaderReloader::Clear()
+	{
+		Drain();
+		entries_.clear();
+	}
+
+	void ShaderReloader::MarkDirty(const std::string& path)
+	{
+		// Includes are not tracked per shader, a change to one rebuilds everything.
+		const std::filesystem::path changed(path);
+		const bool isInclude = HasExtension(changed, { ".glsl", ".h", ".inc" });
+		const auto name = changed.filename().string();
+
+		for (auto& entry : entries_)
+		{
+			if (isInclude || std::find(entry.Shaders.begin(), entry.Shaders.end(), name) != entry.Shaders.end())
+			{
+				entry.Dirty = true;
+			}
+		}
+	}
+
+}
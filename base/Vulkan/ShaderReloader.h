@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Vulkan/VkConfig.h"
+#include "Utilities/ThreadPool.h"
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Utilities
+{
+	class FileWatcher;
+}
+
+namespace vk
+{
+	// Rebuilds pipelines whose GLSL sources change while the application runs. Shaders are recompiled and the
+	// pipelines recreated on a worker thread; Update() installs the results at a frame boundary and keeps the
+	// pipelines they replace alive until every frame that could still reference them has completed.
+	// Only active when building with VULKAN_RUNTIME_SHADERS, embedded SPIR-V never changes.
+	class ShaderReloader final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(ShaderReloader)
+
+		ShaderReloader(const std::vector<std::string>& directories, uint32_t framesInFlight);
+		~ShaderReloader();
+
+		// Rebuilds with create() on a worker when one of the shader files (names such as "scene.frag") or an
+		// include changes, then hands the result to replace() on the render thread, which returns what it
+		// replaced. create() must only read state that the render thread does not modify between frames.
+		template <class Pipelines>
+		void Watch(std::vector<std::string> shaders, std::function<Pipelines()> create, std::function<Pipelines(Pipelines)> replace)
+		{
+			Entry entry;
+			entry.Shaders = std::move(shaders);
+			entry.Rebuild = [create = std::move(create), replace = std::move(replace)]()
+			{
+				auto pipelines = std::make_shared<Pipelines>(create());
+
+				return Install([replace, pipelines]()
+					{
+						return std::shared_ptr<const void>(std::make_shared<Pipelines>(replace(std::move(*pipelines))));
+					});
+			};
+
+			entries_.push_back(std::move(entry));
+		}
+
+		// Call once per frame on the render thread, after waiting for the fence of the frame about to be
+		// recorded. Returns true if any pipeline was replaced.
+		bool Update();
+
+		// Waits for the rebuilds in flight and discards them, they are retried on the next Update(). Also
+		// releases every retired pipeline, so the device must be idle (e.g. before recreating the swap chain).
+		void Drain();
+
+		// Drain() and forget all watches.
+		void Clear();
+
+	private:
+
+		using Install = std::function<std::shared_ptr<const void>()>;
+
+		struct Entry
+		{
+			std::vector<std::string> Shaders;
+			std::function<Install()> Rebuild;
+			std::future<Install> Pending;
+			bool Dirty{};
+		};
+
+		struct Retired
+		{
+			uint64_t Frame;
+			std::shared_ptr<const void> Pipelines;
+		};
+
+		void MarkDirty(const std::string& path);
+
+		const uint32_t framesInFlight_;
+		uint64_t frame_{};
+
+		std::vector<Entry> entries_;
+		std::vector<Retired> retired_;
+
+		std::unique_ptr<Utilities::FileWatcher> watcher_;
+		Utilities::ThreadPool threadPool_;
+	};
+
+}
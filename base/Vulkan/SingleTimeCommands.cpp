@@ -0,0 +1,46 @@
+#include "Vulkan/SingleTimeCommands.h"
+#include "Vulkan/CommandPool.h"
+#include "Vulkan/Device.h"
+#include "Vulkan/UploadManager.h"
+
+namespace vk {
+	SingleTimeCommands::SingleTimeCommands(CommandPool& commandPool) :
+		device_(commandPool.Device())
+	{
+		commandBuffer_ = device_.SubmissionPool().Begin(slot_);
+	}
+
+	SingleTimeCommands::~SingleTimeCommands()
+	{
+		if (!submitted_)
+		{
+			device_.SubmissionPool().Discard(slot_);
+		}
+	}
+
+	SingleTimeCommands& SingleTimeCommands::Record(const std::function<void(VkCommandBuffer)>& action)
+	{
+		action(commandBuffer_);
+		return *this;
+	}
+
+	Submission SingleTimeCommands::SubmitAsync()
+	{
+		// Pending uploads go first, so the commands can read what they wrote.
+		device_.UploadManager().Submit();
+
+		submitted_ = true;
+		return device_.SubmissionPool().Submit(slot_);
+	}
+
+	void SingleTimeCommands::Submit(CommandPool& commandPool, const std::function<void(VkCommandBuffer)>& action)
+	{
+		SubmitAsync(commandPool, action).Wait();
+	}
+
+	Submission SingleTimeCommands::SubmitAsync(CommandPool& commandPool, const std::function<void(VkCommandBuffer)>& action)
+	{
+		SingleTimeCommands commands(commandPool);
+		return commands.Record(action).SubmitAsync();
+	}
+}
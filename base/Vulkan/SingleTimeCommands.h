@@ -1,37 +1,36 @@
 #pragma once
 
 #include "Vulkan/VkConfig.h"
-#include "Vulkan/CommandBuffers.h"
-#include "Vulkan/CommandPool.h"
-#include "Vulkan/Device.h"
+#include "Vulkan/SubmissionPool.h"
 #include <functional>
 
 namespace vk{
+	class CommandPool;
+	class Device;
+
+	// Records one or more actions into a recycled command buffer and submits them together on the graphics
+	// queue, after any pending uploads. Waiting only ever blocks on the submission's own fence.
 	class SingleTimeCommands final {
 	public:
-		static void Submit(CommandPool& commandPool, const std::function<void(VkCommandBuffer)>& action)
-		{
-			CommandBuffers commandBuffers(commandPool, 1);
-
-			VkCommandBufferBeginInfo beginInfo = {};
-			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		VULKAN_NON_COPIABLE(SingleTimeCommands)
 
-			vkBeginCommandBuffer(commandBuffers[0], &beginInfo);
+		explicit SingleTimeCommands(CommandPool& commandPool);
+		// Drops the recorded commands unless they were submitted.
+		~SingleTimeCommands();
 
-			action(commandBuffers[0]);
+		VkCommandBuffer CommandBuffer() const { return commandBuffer_; }
 
-			vkEndCommandBuffer(commandBuffers[0]);
+		SingleTimeCommands& Record(const std::function<void(VkCommandBuffer)>& action);
+		Submission SubmitAsync();
 
-			VkSubmitInfo submitInfo = {};
-			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-			submitInfo.commandBufferCount = 1;
-			submitInfo.pCommandBuffers = &commandBuffers[0];
+		static void Submit(CommandPool& commandPool, const std::function<void(VkCommandBuffer)>& action);
+		static Submission SubmitAsync(CommandPool& commandPool, const std::function<void(VkCommandBuffer)>& action);
 
-			const auto graphicsQueue = commandPool.Device().GraphicsQueue();
+	private:
+		const class Device& device_;
 
-			vkQueueSubmit(graphicsQueue, 1, &submitInfo, nullptr);
-			vkQueueWaitIdle(graphicsQueue);
-		}
+		size_t slot_{};
+		VkCommandBuffer commandBuffer_{};
+		bool submitted_{};
 	};
 }
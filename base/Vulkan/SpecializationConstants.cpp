@@ -0,0 +1,77 @@
+#include "Vulkan/SpecializationConstants.h"
+#include "Utilities/Hash.h"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace vk {
+
+	SpecializationConstants& SpecializationConstants::Set(const uint32_t constantId, const int32_t value)
+	{
+		return Set(constantId, &value, sizeof(value));
+	}
+
+	SpecializationConstants& SpecializationConstants::Set(const uint32_t constantId, const uint32_t value)
+	{
+		return Set(constantId, &value, sizeof(value));
+	}
+
+	SpecializationConstants& SpecializationConstants::Set(const uint32_t constantId, const float value)
+	{
+		return Set(constantId, &value, sizeof(value));
+	}
+
+	SpecializationConstants& SpecializationConstants::Set(const uint32_t constantId, const bool value)
+	{
+		// GLSL bool constants are 32 bit.
+		const VkBool32 bool32 = value ? VK_TRUE : VK_FALSE;
+		return Set(constantId, &bool32, sizeof(bool32));
+	}
+
+	SpecializationConstants& SpecializationConstants::Set(const uint32_t constantId, const void* value, const size_t size)
+	{
+		for (const auto& entry : entries_)
+		{
+			if (entry.constantID == constantId)
+			{
+				if (entry.size != size)
+				{
+					throw std::runtime_error("specialization constant " + std::to_string(constantId) + " set with a different size");
+				}
+
+				std::memcpy(data_.data() + entry.offset, value, size);
+				return *this;
+			}
+		}
+
+		entries_.push_back(VkSpecializationMapEntry{ constantId, static_cast<uint32_t>(data_.size()), size });
+		data_.insert(data_.end(), static_cast<const uint8_t*>(value), static_cast<const uint8_t*>(value) + size);
+
+		return *this;
+	}
+
+	uint64_t SpecializationConstants::Hash() const
+	{
+		uint64_t hash = Utilities::Hash::Bytes(data_.data(), data_.size());
+
+		for (const auto& entry : entries_)
+		{
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(entry.constantID));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(entry.offset));
+			hash = Utilities::Hash::Combine(hash, Utilities::Hash::Value(entry.size));
+		}
+
+		return hash;
+	}
+
+	VkSpecializationInfo SpecializationConstants::Info() const
+	{
+		VkSpecializationInfo info = {};
+		info.mapEntryCount = static_cast<uint32_t>(entries_.size());
+		info.pMapEntries = entries_.data();
+		info.dataSize = data_.size();
+		info.pData = data_.data();
+
+		return info;
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Vulkan/VkConfig.h"
+#include <cstdint>
+#include <vector>
+
+namespace vk
+{
+	// Values for a shader's layout(constant_id = N) constants. One SPIR-V module then yields a pipeline per
+	// set of values, with branches on the constants folded away by the driver. Constants the shader does not
+	// declare are ignored, so one set can be shared across stages.
+	class SpecializationConstants final
+	{
+	public:
+
+		SpecializationConstants& Set(uint32_t constantId, int32_t value);
+		SpecializationConstants& Set(uint32_t constantId, uint32_t value);
+		SpecializationConstants& Set(uint32_t constantId, float value);
+		SpecializationConstants& Set(uint32_t constantId, bool value);
+
+		bool Empty() const { return entries_.empty(); }
+		uint64_t Hash() const;
+
+		// The returned info points into this object.
+		VkSpecializationInfo Info() const;
+
+	private:
+
+		SpecializationConstants& Set(uint32_t constantId, const void* value, size_t size);
+
+		std::vector<VkSpecializationMapEntry> entries_;
+		std::vector<uint8_t> data_;
+	};
+}
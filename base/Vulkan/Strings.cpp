@@ -42,4 +42,88 @@ namespace vk {
 		}
 	}
 
+	const char* Strings::ObjectType(const VkObjectType objectType)
+	{
+		switch (objectType)
+		{
+		case VK_OBJECT_TYPE_INSTANCE:
+			return "Instance";
+		case VK_OBJECT_TYPE_PHYSICAL_DEVICE:
+			return "PhysicalDevice";
+		case VK_OBJECT_TYPE_DEVICE:
+			return "Device";
+		case VK_OBJECT_TYPE_QUEUE:
+			return "Queue";
+		case VK_OBJECT_TYPE_SEMAPHORE:
+			return "Semaphore";
+		case VK_OBJECT_TYPE_COMMAND_BUFFER:
+			return "CommandBuffer";
+		case VK_OBJECT_TYPE_FENCE:
+			return "Fence";
+		case VK_OBJECT_TYPE_DEVICE_MEMORY:
+			return "DeviceMemory";
+		case VK_OBJECT_TYPE_BUFFER:
+			return "Buffer";
+		case VK_OBJECT_TYPE_IMAGE:
+			return "Image";
+		case VK_OBJECT_TYPE_EVENT:
+			return "Event";
+		case VK_OBJECT_TYPE_QUERY_POOL:
+			return "QueryPool";
+		case VK_OBJECT_TYPE_BUFFER_VIEW:
+			return "BufferView";
+		case VK_OBJECT_TYPE_IMAGE_VIEW:
+			return "ImageView";
+		case VK_OBJECT_TYPE_SHADER_MODULE:
+			return "ShaderModule";
+		case VK_OBJECT_TYPE_PIPELINE_CACHE:
+			return "PipelineCache";
+		case VK_OBJECT_TYPE_PIPELINE_LAYOUT:
+			return "PipelineLayout";
+		case VK_OBJECT_TYPE_RENDER_PASS:
+			return "RenderPass";
+		case VK_OBJECT_TYPE_PIPELINE:
+			return "Pipeline";
+		case VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT:
+			return "DescriptorSetLayout";
+		case VK_OBJECT_TYPE_SAMPLER:
+			return "Sampler";
+		case VK_OBJECT_TYPE_DESCRIPTOR_POOL:
+			return "DescriptorPool";
+		case VK_OBJECT_TYPE_DESCRIPTOR_SET:
+			return "DescriptorSet";
+		case VK_OBJECT_TYPE_FRAMEBUFFER:
+			return "Framebuffer";
+		case VK_OBJECT_TYPE_COMMAND_POOL:
+			return "CommandPool";
+		case VK_OBJECT_TYPE_SURFACE_KHR:
+			return "Surface";
+		case VK_OBJECT_TYPE_SWAPCHAIN_KHR:
+			return "Swapchain";
+		case VK_OBJECT_TYPE_DEBUG_UTILS_MESSENGER_EXT:
+			return "DebugUtilsMessenger";
+		default:
+			return "UnknownObjectType";
+		}
+	}
+
+	const char* Strings::AllocationScope(const VkSystemAllocationScope scope)
+	{
+		switch (scope)
+		{
+		case VK_SYSTEM_ALLOCATION_SCOPE_COMMAND:
+			return "Command";
+		case VK_SYSTEM_ALLOCATION_SCOPE_OBJECT:
+			return "Object";
+		case VK_SYSTEM_ALLOCATION_SCOPE_CACHE:
+			return "Cache";
+		case VK_SYSTEM_ALLOCATION_SCOPE_DEVICE:
+			return "Device";
+		case VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE:
+			return "Instance";
+		default:
+			return "UnknownAllocationScope";
+		}
+	}
+
 }
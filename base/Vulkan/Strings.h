@@ -16,6 +16,8 @@ namespace vk
 
 		static const char* DeviceType(VkPhysicalDeviceType deviceType);
 		static const char* VendorId(uint32_t vendorId);
+		static const char* ObjectType(VkObjectType objectType);
+		static const char* AllocationScope(VkSystemAllocationScope scope);
 	};
 
 }
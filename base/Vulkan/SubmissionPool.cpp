@@ -0,0 +1,181 @@
+#include "Vulkan/SubmissionPool.h"
+#include "Vulkan/CommandBuffers.h"
+#include "Vulkan/CommandPool.h"
+#include "Vulkan/Device.h"
+#include "Vulkan/Fence.h"
+#include <limits>
+
+namespace vk {
+
+	namespace
+	{
+		enum class SlotState
+		{
+			Free,
+			Recording,
+			Submitted
+		};
+	}
+
+	struct SubmissionPool::Slot
+	{
+		std::unique_ptr<class CommandBuffers> CommandBuffers;
+		std::unique_ptr<class Fence> Fence; // Unsignalled unless submitted.
+		uint64_t Generation{};
+		SlotState State{};
+	};
+
+	Submission::Submission(SubmissionPool* const pool, const size_t slot, const uint64_t generation) :
+		pool_(pool),
+		slot_(slot),
+		generation_(generation)
+	{
+	}
+
+	void Submission::Wait() const
+	{
+		if (pool_ != nullptr)
+		{
+			pool_->Wait(slot_, generation_);
+		}
+	}
+
+	bool Submission::IsComplete() const
+	{
+		return pool_ == nullptr || pool_->IsComplete(slot_, generation_);
+	}
+
+	SubmissionPool::SubmissionPool(const class Device& device) :
+		device_(device)
+	{
+		commandPool_.reset(new CommandPool(device, device.GraphicsFamilyIndex(), true));
+	}
+
+	SubmissionPool::~SubmissionPool()
+	{
+		for (auto& slot : slots_)
+		{
+			if (slot->State == SlotState::Submitted)
+			{
+				slot->Fence->Wait(std::numeric_limits<uint64_t>::max());
+			}
+		}
+
+		slots_.clear();
+		commandPool_.reset();
+	}
+
+	VkCommandBuffer SubmissionPool::Begin(size_t& slot)
+	{
+		slot = slots_.size();
+
+		for (size_t i = 0; i != slots_.size(); ++i)
+		{
+			auto& candidate = *slots_[i];
+
+			if (candidate.State == SlotState::Submitted && vkGetFenceStatus(device_.Handle(), candidate.Fence->Handle()) == VK_SUCCESS)
+			{
+				Recycle(candidate);
+			}
+
+			if (candidate.State == SlotState::Free)
+			{
+				slot = i;
+				break;
+			}
+		}
+
+		if (slot == slots_.size())
+		{
+			slots_.emplace_back(new Slot());
+			slots_.back()->CommandBuffers.reset(new class CommandBuffers(*commandPool_, 1));
+			slots_.back()->Fence.reset(new class Fence(device_, false));
+		}
+
+		auto& begun = *slots_[slot];
+		const auto commandBuffer = (*begun.CommandBuffers)[0];
+
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		Check(vkBeginCommandBuffer(commandBuffer, &beginInfo),
+			"begin recording command buffer");
+
+		begun.State = SlotState::Recording;
+
+		return commandBuffer;
+	}
+
+	Submission SubmissionPool::Submit(const size_t slot)
+	{
+		auto& submitted = *slots_[slot];
+		const auto commandBuffer = (*submitted.CommandBuffers)[0];
+
+		Check(vkEndCommandBuffer(commandBuffer),
+			"record command buffer");
+
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+
+		Check(vkQueueSubmit(device_.GraphicsQueue(), 1, &submitInfo, submitted.Fence->Handle()),
+			"submit single time commands");
+
+		submitted.State = SlotState::Submitted;
+
+		return Submission(this, slot, submitted.Generation);
+	}
+
+	void SubmissionPool::Discard(const size_t slot)
+	{
+		auto& discarded = *slots_[slot];
+
+		// Ended so the next Begin() can reset it, the fence was never submitted.
+		vkEndCommandBuffer((*discarded.CommandBuffers)[0]);
+
+		discarded.State = SlotState::Free;
+		++discarded.Generation;
+	}
+
+	void SubmissionPool::Wait(const size_t slot, const uint64_t generation)
+	{
+		auto& waited = *slots_[slot];
+
+		// An older generation has completed already, its slot has been recycled since.
+		if (waited.Generation != generation || waited.State != SlotState::Submitted)
+		{
+			return;
+		}
+
+		waited.Fence->Wait(std::numeric_limits<uint64_t>::max());
+		Recycle(waited);
+	}
+
+	bool SubmissionPool::IsComplete(const size_t slot, const uint64_t generation)
+	{
+		auto& polled = *slots_[slot];
+
+		if (polled.Generation != generation || polled.State != SlotState::Submitted)
+		{
+			return true;
+		}
+
+		if (vkGetFenceStatus(device_.Handle(), polled.Fence->Handle()) != VK_SUCCESS)
+		{
+			return false;
+		}
+
+		Recycle(polled);
+		return true;
+	}
+
+	void SubmissionPool::Recycle(Slot& slot)
+	{
+		slot.Fence->Reset();
+		slot.State = SlotState::Free;
+		++slot.Generation;
+	}
+
+}
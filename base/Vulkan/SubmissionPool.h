@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Vulkan/VkConfig.h"
+#include <memory>
+#include <vector>
+
+namespace vk
+{
+	class CommandPool;
+	class Device;
+	class SubmissionPool;
+
+	// Completion of a SubmissionPool submission, cheap to copy. A default constructed one is complete.
+	class Submission final
+	{
+	public:
+
+		Submission() = default;
+
+		// Blocks on the submission's own fence, not on the queue.
+		void Wait() const;
+		bool IsComplete() const;
+
+	private:
+
+		friend class SubmissionPool;
+
+		Submission(SubmissionPool* pool, size_t slot, uint64_t generation);
+
+		SubmissionPool* pool_{};
+		size_t slot_{};
+		uint64_t generation_{};
+	};
+
+	// One time command buffers and their fences for SingleTimeCommands, allocated from a graphics command pool
+	// of its own and recycled once the fence has signalled. A Submission names a slot and the generation it was
+	// submitted in, so it stays valid after the slot has been reused. Not thread safe, like command pools.
+	class SubmissionPool final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(SubmissionPool)
+
+		explicit SubmissionPool(const Device& device);
+		~SubmissionPool();
+
+		// Returns a command buffer in the recording state, slot is then passed to Submit() or Discard().
+		VkCommandBuffer Begin(size_t& slot);
+		Submission Submit(size_t slot);
+		void Discard(size_t slot);
+
+	private:
+
+		friend class Submission;
+
+		struct Slot;
+
+		void Wait(size_t slot, uint64_t generation);
+		bool IsComplete(size_t slot, uint64_t generation);
+		void Recycle(Slot& slot);
+
+		const class Device& device_;
+
+		std::unique_ptr<CommandPool> commandPool_;
+		std::vector<std::unique_ptr<Slot>> slots_;
+	};
+
+}
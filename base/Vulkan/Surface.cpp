@@ -1,17 +1,18 @@
 #include "Vulkan/Surface.h"
+#include "Vulkan/HostAllocator.h"
 #include "Vulkan/Instance.h"
 #include "Vulkan/Window.h"
 
 namespace vk {
 	Surface::Surface(const class Instance& instance) : instance_(instance) {
-		Check(glfwCreateWindowSurface(instance.Handle(), instance.Window().Handle(), nullptr, &surface_),
+		Check(glfwCreateWindowSurface(instance.Handle(), instance.Window().Handle(), instance.HostAllocator().Callbacks(VK_OBJECT_TYPE_SURFACE_KHR), &surface_),
 			"create window surface");
 	}
 
 	Surface::~Surface() {
 		if (surface_ != nullptr)
 		{
-			vkDestroySurfaceKHR(instance_.Handle(), surface_, nullptr);
+			vkDestroySurfaceKHR(instance_.Handle(), surface_, instance_.HostAllocator().Callbacks(VK_OBJECT_TYPE_SURFACE_KHR));
 			surface_ = nullptr;
 		}
 	}
@@ -1,6 +1,7 @@
 #include "Vulkan/SwapChain.h"
 #include "Vulkan/Device.h"
 #include "Vulkan/Enumerate.h"
+#include "Vulkan/HostAllocator.h"
 #include "Vulkan/ImageView.h"
 #include "Vulkan/Instance.h"
 #include "Vulkan/Surface.h"
@@ -58,7 +59,7 @@ namespace vk {
 			createInfo.pQueueFamilyIndices = nullptr; // Optional
 		}
 
-		Check(vkCreateSwapchainKHR(device.Handle(), &createInfo, nullptr, &swapChain_),
+		Check(vkCreateSwapchainKHR(device.Handle(), &createInfo, device.HostAllocator().Callbacks(VK_OBJECT_TYPE_SWAPCHAIN_KHR), &swapChain_),
 			"create swap chain!");
 
 		minImageCount_ = std::max(2u, details.Capabilities.minImageCount);
@@ -88,7 +89,7 @@ namespace vk {
 
 		if (swapChain_ != nullptr)
 		{
-			vkDestroySwapchainKHR(device_.Handle(), swapChain_, nullptr);
+			vkDestroySwapchainKHR(device_.Handle(), swapChain_, device_.HostAllocator().Callbacks(VK_OBJECT_TYPE_SWAPCHAIN_KHR));
 			swapChain_ = nullptr;
 		}
 	}
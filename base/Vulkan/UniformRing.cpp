@@ -0,0 +1,78 @@
+#include "Vulkan/UniformRing.h"
+#include "Vulkan/Buffer.h"
+#include "Vulkan/Device.h"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace vk {
+
+	namespace
+	{
+		VkDeviceSize MinUniformBufferOffsetAlignment(const Device& device)
+		{
+			VkPhysicalDeviceProperties properties;
+			vkGetPhysicalDeviceProperties(device.PhysicalDevice(), &properties);
+
+			return properties.limits.minUniformBufferOffsetAlignment;
+		}
+
+		VkDeviceSize AlignUp(const VkDeviceSize value, const VkDeviceSize alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+	}
+
+	UniformRing::UniformRing(const class Device& device, const VkDeviceSize frameSize, const uint32_t frameCount) :
+		alignment_(MinUniformBufferOffsetAlignment(device)),
+		frameSize_(AlignUp(frameSize, alignment_)),
+		frameCount_(frameCount)
+	{
+		const auto size = frameSize_ * frameCount_;
+
+		buffer_.reset(new class Buffer(device, size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT));
+		memory_.reset(new DeviceMemory(buffer_->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)));
+		mapped_ = static_cast<char*>(memory_->Map(0, size));
+
+		device.DebugUtils().SetObjectName(buffer_->Handle(), "Uniform Ring Buffer");
+
+		BeginFrame(0);
+	}
+
+	UniformRing::~UniformRing()
+	{
+		buffer_.reset();
+		memory_.reset(); // release memory after bound buffer has been destroyed
+	}
+
+	VkDescriptorBufferInfo UniformRing::Descriptor(const VkDeviceSize range) const
+	{
+		VkDescriptorBufferInfo info = {};
+		info.buffer = buffer_->Handle();
+		info.offset = 0;
+		info.range = range;
+
+		return info;
+	}
+
+	void UniformRing::BeginFrame(const uint32_t frame)
+	{
+		head_ = frame * frameSize_;
+		end_ = head_ + frameSize_;
+	}
+
+	uint32_t UniformRing::Push(const void* const data, const size_t size)
+	{
+		if (head_ + size > end_)
+		{
+			throw std::runtime_error("uniform ring frame of " + std::to_string(frameSize_) + " bytes is full");
+		}
+
+		const auto offset = head_;
+		std::memcpy(mapped_ + offset, data, size);
+		head_ = AlignUp(offset + size, alignment_);
+
+		return static_cast<uint32_t>(offset);
+	}
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Vulkan/VkConfig.h"
+#include <memory>
+
+namespace vk
+{
+	class Buffer;
+	class Device;
+	class DeviceMemory;
+
+	// Per frame uniform data in one persistently mapped, host visible buffer split into one region per frame in
+	// flight. Push() copies a value at the next aligned offset of the current frame's region and returns it as
+	// the dynamic offset of a VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC binding, so updating constants needs no
+	// driver call and no descriptor update. BeginFrame() rewinds a region once its frame's fence has signalled.
+	class UniformRing final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(UniformRing)
+
+		UniformRing(const Device& device, VkDeviceSize frameSize, uint32_t frameCount);
+		~UniformRing();
+
+		const class Buffer& Buffer() const { return *buffer_; }
+
+		// Descriptor for a dynamic binding of range bytes, the offset comes from Push() at bind time.
+		VkDescriptorBufferInfo Descriptor(VkDeviceSize range) const;
+
+		void BeginFrame(uint32_t frame);
+
+		template <class T>
+		uint32_t Push(const T& value) { return Push(&value, sizeof(T)); }
+		uint32_t Push(const void* data, size_t size);
+
+	private:
+
+		const VkDeviceSize alignment_;
+		const VkDeviceSize frameSize_;
+		const uint32_t frameCount_;
+
+		VkDeviceSize head_{};
+		VkDeviceSize end_{};
+
+		std::unique_ptr<class Buffer> buffer_;
+		std::unique_ptr<DeviceMemory> memory_;
+		char* mapped_{};
+	};
+
+}
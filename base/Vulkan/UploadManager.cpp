@@ -0,0 +1,549 @@
+#include "Vulkan/UploadManager.h"
+#include "Vulkan/Buffer.h"
+#include "Vulkan/CommandBuffers.h"
+#include "Vulkan/CommandPool.h"
+#include "Vulkan/Device.h"
+#include "Vulkan/DeviceMemory.h"
+#include "Vulkan/Fence.h"
+#include "Vulkan/Image.h"
+#include "Vulkan/Semaphore.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace vk {
+
+	namespace
+	{
+		// Multiple of every texel size and of optimalBufferCopyOffsetAlignment on common hardware.
+		const VkDeviceSize StagingAlignment = 16;
+
+		// Whatever may read an upload: vertex and index fetch, uniforms and sampled images in any shader.
+		const VkPipelineStageFlags ReaderStages =
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		const VkAccessFlags ReaderAccess =
+			VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+		VkDeviceSize AlignUp(const VkDeviceSize value, const VkDeviceSize alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		enum class BatchState
+		{
+			Idle,
+			Recording,
+			Transferring, // Copies submitted, the graphics queue has not acquired the resources yet.
+			Pending // Fully submitted, the fence has not been waited on yet.
+		};
+	}
+
+	struct UploadManager::Batch
+	{
+		Token Id{};
+		BatchState State{};
+		bool HasBufferCopies{};
+		VkDeviceSize Head{}; // Bytes used in the batch's staging segment.
+		std::unique_ptr<class Fence> Fence; // Signalled once the whole batch, acquire included, has executed.
+		std::vector<std::pair<std::unique_ptr<DeviceMemory>, std::unique_ptr<Buffer>>> Oversized; // Buffer destroyed first.
+
+		// Dedicated transfer queue only: the copies signal both once done, the acquire waits on the semaphore.
+		std::unique_ptr<class Fence> TransferFence;
+		std::unique_ptr<class Semaphore> Semaphore;
+		std::vector<VkBufferMemoryBarrier> BufferTransfers;
+		std::vector<VkImageMemoryBarrier> ImageTransfers;
+	};
+
+	UploadManager::UploadManager(const class Device& device, const VkDeviceSize segmentSize, const uint32_t segmentCount) :
+		device_(device),
+		segmentSize_(segmentSize),
+		ownershipTransfer_(device.TransferFamilyIndex() != device.GraphicsFamilyIndex()),
+		batches_(segmentCount)
+	{
+		const auto size = segmentSize * segmentCount;
+
+		commandPool_.reset(new CommandPool(device, device.TransferFamilyIndex(), true));
+		commandBuffers_.reset(new CommandBuffers(*commandPool_, segmentCount));
+
+		if (ownershipTransfer_)
+		{
+			acquireCommandPool_.reset(new CommandPool(device, device.GraphicsFamilyIndex(), true));
+			acquireCommandBuffers_.reset(new CommandBuffers(*acquireCommandPool_, segmentCount));
+		}
+
+		stagingBuffer_.reset(new Buffer(device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT));
+		stagingMemory_.reset(new DeviceMemory(stagingBuffer_->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)));
+		mapped_ = static_cast<unsigned char*>(stagingMemory_->Map(0, size));
+
+		device.DebugUtils().SetObjectName(stagingBuffer_->Handle(), "Upload Staging Buffer");
+
+		for (auto& batch : batches_)
+		{
+			batch.Fence.reset(new class Fence(device, true));
+
+			if (ownershipTransfer_)
+			{
+				batch.TransferFence.reset(new class Fence(device, true));
+				batch.Semaphore.reset(new class Semaphore(device));
+			}
+		}
+	}
+
+	UploadManager::~UploadManager()
+	{
+		// Uploads still being recorded are dropped, their resources are being destroyed too.
+		for (auto& batch : batches_)
+		{
+			Acquire(batch);
+
+			if (batch.State == BatchState::Pending)
+			{
+				batch.Fence->Wait(std::numeric_limits<uint64_t>::max());
+				Retire(batch);
+			}
+		}
+
+		batches_.clear();
+		acquireCommandBuffers_.reset();
+		acquireCommandPool_.reset();
+		commandBuffers_.reset();
+		commandPool_.reset();
+		stagingBuffer_.reset();
+		stagingMemory_.reset(); // release memory after bound buffer has been destroyed
+	}
+
+	void UploadManager::CopyToBuffer(Buffer& buffer, const void* const data, const VkDeviceSize size, const VkDeviceSize offset)
+	{
+		if (size == 0)
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		const auto staging = Stage(data, size);
+
+		VkBufferCopy region = {};
+		region.srcOffset = staging.Offset;
+		region.dstOffset = offset;
+		region.size = size;
+
+		vkCmdCopyBuffer((*commandBuffers_)[current_], staging.Buffer, buffer.Handle(), 1, &region);
+
+		auto& batch = batches_[current_];
+		batch.HasBufferCopies = true;
+
+		if (ownershipTransfer_)
+		{
+			VkBufferMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			barrier.srcQueueFamilyIndex = device_.TransferFamilyIndex();
+			barrier.dstQueueFamilyIndex = device_.GraphicsFamilyIndex();
+			barrier.buffer = buffer.Handle();
+			barrier.offset = offset;
+			barrier.size = size;
+
+			batch.BufferTransfers.push_back(barrier);
+		}
+	}
+
+	void UploadManager::CopyToImage(
+		Image& image,
+		const void* const data,
+		const VkDeviceSize size,
+		const std::vector<VkBufferImageCopy>& regions,
+		const uint32_t levelCount,
+		const uint32_t layerCount)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		RecordImageCopy(image, Stage(data, size), regions, levelCount, layerCount);
+	}
+
+	void UploadManager::CopyToImage(Image& image, const void* const data, const VkDeviceSize size, const uint32_t layerCount)
+	{
+		VkBufferImageCopy region = {};
+		region.bufferOffset = 0;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = 0;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = layerCount;
+		region.imageExtent = { image.Extent().width, image.Extent().height, 1 };
+
+		CopyToImage(image, data, size, { region }, 1, layerCount);
+	}
+
+	void UploadManager::CopyToImage(
+		Image& image,
+		const std::vector<std::pair<const void*, VkDeviceSize>>& sources,
+		const std::vector<VkBufferImageCopy>& regions,
+		const uint32_t levelCount,
+		const uint32_t layerCount)
+	{
+		VkDeviceSize size = 0;
+
+		for (const auto& source : sources)
+		{
+			size += source.second;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		const auto staging = Reserve(size);
+		std::vector<VkBufferImageCopy> packedRegions(regions);
+		VkDeviceSize offset = 0;
+
+		for (size_t i = 0; i != sources.size(); ++i)
+		{
+			std::memcpy(staging.Mapped + offset, sources[i].first, sources[i].second);
+			packedRegions[i].bufferOffset = offset;
+			offset += sources[i].second;
+		}
+
+		RecordImageCopy(image, staging, packedRegions, levelCount, layerCount);
+	}
+
+	UploadManager::Token UploadManager::Submit()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		AcquireFinished();
+
+		return batches_[current_].State == BatchState::Recording ? SubmitCurrent(false) : nextToken_ - 1;
+	}
+
+	UploadManager::Token UploadManager::SubmitAsync()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		AcquireFinished();
+
+		return batches_[current_].State == BatchState::Recording ? SubmitCurrent(true) : nextToken_ - 1;
+	}
+
+	void UploadManager::Wait(const Token token)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		if (token <= completedToken_)
+		{
+			return;
+		}
+
+		auto& current = batches_[current_];
+
+		if (current.State == BatchState::Recording && current.Id <= token)
+		{
+			SubmitCurrent(false);
+		}
+
+		for (auto& batch : batches_)
+		{
+			if (batch.Id <= token)
+			{
+				Acquire(batch);
+			}
+
+			if (batch.State == BatchState::Pending && batch.Id <= token)
+			{
+				batch.Fence->Wait(std::numeric_limits<uint64_t>::max());
+				Retire(batch);
+			}
+		}
+
+		completedToken_ = std::max(completedToken_, token);
+	}
+
+	bool UploadManager::IsComplete(const Token token)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		if (token <= completedToken_)
+		{
+			return true;
+		}
+
+		AcquireFinished();
+
+		for (auto& batch : batches_)
+		{
+			if (batch.Id > token)
+			{
+				continue;
+			}
+
+			if (batch.State == BatchState::Recording ||
+				batch.State == BatchState::Transferring ||
+				(batch.State == BatchState::Pending && vkGetFenceStatus(device_.Handle(), batch.Fence->Handle()) != VK_SUCCESS))
+			{
+				return false;
+			}
+		}
+
+		for (auto& batch : batches_)
+		{
+			if (batch.State == BatchState::Pending && batch.Id <= token)
+			{
+				Retire(batch);
+			}
+		}
+
+		completedToken_ = std::max(completedToken_, token);
+		return true;
+	}
+
+	UploadManager::Batch& UploadManager::Begin()
+	{
+		auto& batch = batches_[current_];
+
+		if (batch.State == BatchState::Recording)
+		{
+			return batch;
+		}
+
+		// The segment is about to be overwritten, wait for the batch that used it last.
+		Acquire(batch);
+
+		if (batch.State == BatchState::Pending)
+		{
+			batch.Fence->Wait(std::numeric_limits<uint64_t>::max());
+			Retire(batch);
+		}
+
+		batch.Fence->Reset();
+
+		if (ownershipTransfer_)
+		{
+			batch.TransferFence->Reset();
+		}
+
+		batch.Id = nextToken_++;
+		batch.State = BatchState::Recording;
+		batch.HasBufferCopies = false;
+		batch.Head = 0;
+
+		commandBuffers_->Begin(current_);
+
+		return batch;
+	}
+
+	void UploadManager::RecordImageCopy(
+		Image& image,
+		const Staging& staging,
+		const std::vector<VkBufferImageCopy>& regions,
+		const uint32_t levelCount,
+		const uint32_t layerCount)
+	{
+		const auto commandBuffer = (*commandBuffers_)[current_];
+
+		std::vector<VkBufferImageCopy> stagedRegions(regions);
+
+		for (auto& region : stagedRegions)
+		{
+			region.bufferOffset += staging.Offset;
+		}
+
+		image.TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, levelCount, layerCount);
+		vkCmdCopyBufferToImage(commandBuffer, staging.Buffer, image.Handle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(stagedRegions.size()), stagedRegions.data());
+
+		if (!ownershipTransfer_)
+		{
+			image.TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, levelCount, layerCount);
+			return;
+		}
+
+		// Fragment shader stages do not exist on a transfer queue, the ownership transfer changes the layout instead.
+		VkImageMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcQueueFamilyIndex = device_.TransferFamilyIndex();
+		barrier.dstQueueFamilyIndex = device_.GraphicsFamilyIndex();
+		barrier.image = image.Handle();
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = levelCount;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = layerCount;
+
+		batches_[current_].ImageTransfers.push_back(barrier);
+		image.SetImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}
+
+	UploadManager::Staging UploadManager::Reserve(const VkDeviceSize size)
+	{
+		if (size > segmentSize_)
+		{
+			auto& batch = Begin();
+
+			std::unique_ptr<Buffer> buffer(new Buffer(device_, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT));
+			std::unique_ptr<DeviceMemory> memory(new DeviceMemory(buffer->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)));
+
+			const Staging staging{ buffer->Handle(), 0, static_cast<unsigned char*>(memory->Map(0, size)) };
+			batch.Oversized.emplace_back(std::move(memory), std::move(buffer));
+
+			return staging;
+		}
+
+		auto* batch = &Begin();
+		auto head = AlignUp(batch->Head, StagingAlignment);
+
+		if (head + size > segmentSize_)
+		{
+			SubmitCurrent(false);
+			batch = &Begin();
+			head = 0;
+		}
+
+		const auto offset = current_ * segmentSize_ + head;
+		batch->Head = head + size;
+
+		return Staging{ stagingBuffer_->Handle(), offset, mapped_ + offset };
+	}
+
+	UploadManager::Staging UploadManager::Stage(const void* const data, const VkDeviceSize size)
+	{
+		const auto staging = Reserve(size);
+		std::memcpy(staging.Mapped, data, size);
+
+		return staging;
+	}
+
+	UploadManager::Token UploadManager::SubmitCurrent(const bool async)
+	{
+		auto& batch = batches_[current_];
+		const auto commandBuffer = (*commandBuffers_)[current_];
+
+		if (ownershipTransfer_)
+		{
+			// Release half of the ownership transfers, the graphics queue acquires with the same barriers.
+			for (auto& barrier : batch.BufferTransfers)
+			{
+				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				barrier.dstAccessMask = 0;
+			}
+
+			for (auto& barrier : batch.ImageTransfers)
+			{
+				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				barrier.dstAccessMask = 0;
+			}
+
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr,
+				static_cast<uint32_t>(batch.BufferTransfers.size()), batch.BufferTransfers.data(),
+				static_cast<uint32_t>(batch.ImageTransfers.size()), batch.ImageTransfers.data());
+		}
+		else if (batch.HasBufferCopies)
+		{
+			// Images are transitioned one by one, a single barrier covers every buffer written by the batch.
+			VkMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = ReaderAccess;
+
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, ReaderStages, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+		}
+
+		commandBuffers_->End(current_);
+
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+
+		if (!ownershipTransfer_)
+		{
+			Check(vkQueueSubmit(device_.TransferQueue(), 1, &submitInfo, batch.Fence->Handle()),
+				"submit uploads");
+
+			batch.State = BatchState::Pending;
+			current_ = (current_ + 1) % batches_.size();
+
+			return batch.Id;
+		}
+
+		const auto semaphore = batch.Semaphore->Handle();
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &semaphore;
+
+		Check(vkQueueSubmit(device_.TransferQueue(), 1, &submitInfo, batch.TransferFence->Handle()),
+			"submit uploads");
+
+		// Record the acquire half now, it is submitted to the graphics queue by Acquire().
+		for (auto& barrier : batch.BufferTransfers)
+		{
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = ReaderAccess;
+		}
+
+		for (auto& barrier : batch.ImageTransfers)
+		{
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = ReaderAccess;
+		}
+
+		const auto acquireCommandBuffer = acquireCommandBuffers_->Begin(current_);
+
+		vkCmdPipelineBarrier(acquireCommandBuffer, ReaderStages, ReaderStages, 0, 0, nullptr,
+			static_cast<uint32_t>(batch.BufferTransfers.size()), batch.BufferTransfers.data(),
+			static_cast<uint32_t>(batch.ImageTransfers.size()), batch.ImageTransfers.data());
+
+		acquireCommandBuffers_->End(current_);
+
+		batch.State = BatchState::Transferring;
+		current_ = (current_ + 1) % batches_.size();
+
+		if (!async)
+		{
+			Acquire(batch);
+		}
+
+		return batch.Id;
+	}
+
+	void UploadManager::Acquire(Batch& batch)
+	{
+		if (batch.State != BatchState::Transferring)
+		{
+			return;
+		}
+
+		// The semaphore wait blocks the stages the acquire barriers start from, which chains them to the copies.
+		const auto commandBuffer = (*acquireCommandBuffers_)[&batch - batches_.data()];
+		const auto semaphore = batch.Semaphore->Handle();
+		const VkPipelineStageFlags waitStage = ReaderStages;
+
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.pWaitSemaphores = &semaphore;
+		submitInfo.pWaitDstStageMask = &waitStage;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+
+		Check(vkQueueSubmit(device_.GraphicsQueue(), 1, &submitInfo, batch.Fence->Handle()),
+			"submit upload acquire");
+
+		batch.State = BatchState::Pending;
+	}
+
+	void UploadManager::AcquireFinished()
+	{
+		for (auto& batch : batches_)
+		{
+			if (batch.State == BatchState::Transferring && vkGetFenceStatus(device_.Handle(), batch.TransferFence->Handle()) == VK_SUCCESS)
+			{
+				Acquire(batch);
+			}
+		}
+	}
+
+	void UploadManager::Retire(Batch& batch)
+	{
+		batch.State = BatchState::Idle;
+		batch.Oversized.clear();
+		batch.BufferTransfers.clear();
+		batch.ImageTransfers.clear();
+	}
+
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Vulkan/VkConfig.h"
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace vk
+{
+	class Buffer;
+	class CommandBuffers;
+	class CommandPool;
+	class Device;
+	class DeviceMemory;
+	class Fence;
+	class Image;
+	class Semaphore;
+
+	// Records buffer and image uploads into a shared command buffer and submits them in batches, so loading
+	// a scene costs one submission instead of a staging buffer and a queue drain per resource. Source data is
+	// copied into a persistently mapped staging ring split into one segment per batch; a segment is reused
+	// once its batch's fence has signalled, and data larger than a segment gets a staging buffer of its own
+	// for the lifetime of the batch.
+	//
+	// Copies run on the device's transfer queue. When that is a dedicated family, each batch releases its
+	// resources to the graphics family and a second submission on the graphics queue, chained to the first
+	// by a semaphore, acquires them; graphics submissions made after the acquire see the uploads without
+	// waiting. Submit() queues the acquire right away, SubmitAsync() only once the copies have finished so
+	// rendering never waits on them. Destination resources must not have been used by another queue family
+	// yet. Wait() is only needed to read results on the host. Thread safe.
+	class UploadManager final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(UploadManager)
+
+		// Identifies a batch, later batches have larger tokens.
+		using Token = uint64_t;
+
+		UploadManager(const Device& device, VkDeviceSize segmentSize, uint32_t segmentCount);
+		~UploadManager();
+
+		// Both copy data into staging memory right away, the source can be released when they return.
+		void CopyToBuffer(Buffer& buffer, const void* data, VkDeviceSize size, VkDeviceSize offset = 0);
+
+		// Uploads every region (bufferOffset relative to data) and leaves levels [0, levelCount) and layers
+		// [0, layerCount) of the image in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+		void CopyToImage(Image& image, const void* data, VkDeviceSize size, const std::vector<VkBufferImageCopy>& regions, uint32_t levelCount, uint32_t layerCount);
+		// Tightly packed layers of the first level.
+		void CopyToImage(Image& image, const void* data, VkDeviceSize size, uint32_t layerCount = 1);
+		// One source range per region, copied straight into staging back to back so the caller does not have to
+		// gather them first. The regions' bufferOffset is ignored, source sizes must keep the offsets texel aligned.
+		void CopyToImage(Image& image, const std::vector<std::pair<const void*, VkDeviceSize>>& sources, const std::vector<VkBufferImageCopy>& regions, uint32_t levelCount, uint32_t layerCount);
+
+		// Submits the uploads recorded so far, returns the token of the batch holding them (which may be
+		// complete already if nothing was pending). Also hands finished asynchronous batches to the graphics
+		// queue, call it once per frame.
+		Token Submit();
+
+		// Same, but the batch is only handed to the graphics queue by a later Submit() or IsComplete() once
+		// its copies have finished. Submit() earlier uploads first if later graphics work depends on them.
+		Token SubmitAsync();
+
+		// Blocks until the batch has completed, submitting it first if it is still being recorded.
+		void Wait(Token token);
+		bool IsComplete(Token token);
+
+	private:
+
+		struct Batch;
+
+		struct Staging
+		{
+			VkBuffer Buffer;
+			VkDeviceSize Offset;
+			unsigned char* Mapped;
+		};
+
+		Batch& Begin();
+		// Reserves size bytes of staging memory for the current batch, the caller fills Mapped.
+		Staging Reserve(VkDeviceSize size);
+		Staging Stage(const void* data, VkDeviceSize size);
+		// Records the copy from staging and the release to the graphics family, regions are relative to staging.
+		void RecordImageCopy(Image& image, const Staging& staging, const std::vector<VkBufferImageCopy>& regions, uint32_t levelCount, uint32_t layerCount);
+		Token SubmitCurrent(bool async);
+		void Acquire(Batch& batch);
+		void AcquireFinished();
+		void Retire(Batch& batch);
+
+		const class Device& device_;
+		const VkDeviceSize segmentSize_;
+		const bool ownershipTransfer_; // Transfer and graphics queues are different families.
+
+		std::mutex mutex_;
+
+		std::unique_ptr<CommandPool> commandPool_;
+		std::unique_ptr<CommandBuffers> commandBuffers_;
+		std::unique_ptr<CommandPool> acquireCommandPool_; // Graphics family, dedicated transfer queue only.
+		std::unique_ptr<CommandBuffers> acquireCommandBuffers_;
+		std::unique_ptr<Buffer> stagingBuffer_;
+		std::unique_ptr<DeviceMemory> stagingMemory_;
+		unsigned char* mapped_{};
+
+		std::vector<Batch> batches_; // One per segment, used round robin.
+		size_t current_{};
+		Token nextToken_{ 1 };
+		Token completedToken_{};
+	};
+
+}
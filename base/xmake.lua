@@ -2,6 +2,11 @@ target("base")
     set_kind("static")
 
     add_includedirs("./", {public = true})
+
+    -- Utilities/Pixels.cpp uses SSSE3 shuffles for RGB -> RGBA expansion.
+    if is_arch("x86_64", "x64", "i386", "x86") then
+        add_vectorexts("ssse3")
+    end
     
     add_files("Assets/*.cpp")
     add_files("Utilities/*.cpp")
@@ -1,6 +1,7 @@
 #version 450
 
 #define SHADOW_MAP_CASCADE_COUNT 4
+#define TEXTURE_IMAGE_COUNT 4
 #define ambient 0.3
 
 layout(location = 0) in vec3 worldFragPos;
@@ -10,8 +11,8 @@ layout(location = 3) in vec3 viewPos;
 
 layout(location = 0) out vec4 outColor;
 
-layout(binding = 1) uniform sampler2D[] tex;
-layout(binding = 2) uniform sampler2DArray shadowMap;
+layout(binding = 1) uniform sampler2DArray tex[TEXTURE_IMAGE_COUNT];
+layout(binding = 2) uniform sampler2D shadowMaps[SHADOW_MAP_CASCADE_COUNT]; // one per cascade, sizes may differ
 
 layout(binding = 3) uniform shadowUBO{
     vec4 splitDepth;
@@ -20,11 +21,31 @@ layout(binding = 3) uniform shadowUBO{
     vec3 lightDir;
 } sUbo;
 
+struct TextureSlot {
+    vec4 uvTransform;
+    uint image;
+    uint layer;
+};
+
+layout(std430, binding = 4) readonly buffer TextureSlots {
+    TextureSlot slots[];
+} textureSlots;
+
 layout(push_constant) uniform PushConsts{
-    layout(offset = 12) int modelID;
     layout(offset = 16) int colorCascades;
 } consts;
 
+// Material path, see Material in csm/src/material.h.
+#define MATERIAL_FLAT 0
+#define MATERIAL_TEXTURED 1
+#define MATERIAL_ALPHA_MASKED 2
+
+layout(constant_id = 0) const int MATERIAL = MATERIAL_FLAT;
+layout(constant_id = 1) const int COLOR_SLOT = 0;
+layout(constant_id = 2) const int MASK_SLOT = 0;
+layout(constant_id = 3) const int CASCADE_COUNT = SHADOW_MAP_CASCADE_COUNT; // at most SHADOW_MAP_CASCADE_COUNT
+layout(constant_id = 4) const int PCF_RANGE = 1;
+
 
 const mat4 biasMat = mat4( 
 	0.5, 0.0, 0.0, 0.0,
@@ -34,12 +55,36 @@ const mat4 biasMat = mat4(
 );
 
 
+// Scene textures are packed into array images and atlases, the slot says where each one lives.
+// UVs are clamped like the clamp-to-edge sampler so atlas neighbours never bleed in.
+vec4 SampleTexture(int slot, vec2 uv){
+    TextureSlot s = textureSlots.slots[slot];
+    return texture(tex[s.image], vec3(clamp(uv, 0.0, 1.0) * s.uvTransform.xy + s.uvTransform.zw, float(s.layer)));
+}
+
+// cascadedID varies across fragments, the maps are only indexed with the (dynamically uniform) loop counter.
+float SampleShadowMap(int cascadedID, vec2 uv){
+    for(int i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++){
+        if(i == cascadedID)
+            return textureLod(shadowMaps[i], uv, 0.0).r;
+    }
+    return 1.0;
+}
+
+vec2 ShadowMapSize(int cascadedID){
+    for(int i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++){
+        if(i == cascadedID)
+            return vec2(textureSize(shadowMaps[i], 0));
+    }
+    return vec2(1.0);
+}
+
 float Shadow(vec4 shadowCoord, vec2 offset, int cascadedID){
     float shadow = 1.0;
     float bias = 0.0005;
 
     if(shadowCoord.z > -1.0 && shadowCoord.z < 1.0){
-        float dist = texture(shadowMap, vec3(shadowCoord.xy + offset, cascadedID)).r;
+        float dist = SampleShadowMap(cascadedID, shadowCoord.xy + offset);
         if(shadowCoord.w > 0 && dist < shadowCoord.z - bias){
             shadow = ambient;
         }
@@ -47,16 +92,16 @@ float Shadow(vec4 shadowCoord, vec2 offset, int cascadedID){
     return shadow;
 }
 
-// 3x3 PCF
+// (2 * PCF_RANGE + 1)^2 PCF
 float PCF(vec4 shadowCoord, int cascadedID){
-    vec2 texDim = textureSize(shadowMap, 0).xy;
+    vec2 texDim = ShadowMapSize(cascadedID);
     float scale = 0.5;
     float dx = scale * 1.0 / float(texDim.x);
     float dy = scale * 1.0 / float(texDim.y);
 
     float shadowFactor = 0.0f;
     int count = 0;
-    int range = 1;
+    int range = PCF_RANGE;
     for(int x = -range; x <= range; x++){
         for(int y = -range; y <= range; y++){
             shadowFactor += Shadow(shadowCoord, vec2(x * dx, y * dy), cascadedID);
@@ -67,19 +112,13 @@ float PCF(vec4 shadowCoord, int cascadedID){
 }
 
 void main(){
-    vec4 color;
-    switch(consts.modelID){
-        case 1:
-            color = vec4(0.8, 0.7, 0.6, 1.0);    
-            break;
-        case 3:
-            color = texture(tex[2], uv);
-            break;
-        case 4:
-            float alpha = texture(tex[1], uv).r;
-            if(alpha < 0.5) discard;
-            color = texture(tex[0], uv);
-            break;
+    vec4 color = vec4(0.8, 0.7, 0.6, 1.0);
+    if(MATERIAL == MATERIAL_ALPHA_MASKED){
+        float alpha = SampleTexture(MASK_SLOT, uv).r;
+        if(alpha < 0.5) discard;
+    }
+    if(MATERIAL != MATERIAL_FLAT){
+        color = SampleTexture(COLOR_SLOT, uv);
     }
 
     int cascadedID = 0;
@@ -89,7 +128,7 @@ void main(){
             cascadedID = i + 1;
     }*/
     
-    for(int i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++){
+    for(int i = 0; i < CASCADE_COUNT; i++){
         float distance = length(worldFragPos - sUbo.splitSphereBound[i].xyz);
         if(distance < sUbo.splitSphereBound[i].w){
             cascadedID = i;
@@ -10,7 +10,7 @@ layout(location = 3) out vec3 viewPos;
 
 layout(push_constant) uniform PushConsts{
     layout(offset = 0) vec3 offset;
-    layout(offset = 12) int modelID;
+    layout(offset = 12) float scale;
 } consts;
 
 
@@ -23,17 +23,10 @@ layout(binding = 0) uniform UniformBufferObject{
 
 void main(){
     mat4 model = ubo.model;
-    
-    if(consts.modelID == 1){
-        for(int i = 0; i < 3; i++){
-            model[i][i] *= 300;
-        }
-    }
-    if(consts.modelID == 2){
-        for(int i = 0; i < 3; i++){
-            model[i][i] *= 2;
-        }
+    for(int i = 0; i < 3; i++){
+        model[i][i] *= consts.scale;
     }
+
     vec3 pos = aPos + consts.offset;
     worldFragPos = vec3(model * vec4(pos, 1.0));
     viewPos = vec3(ubo.view * model * vec4(pos, 1.0));
@@ -1,15 +1,38 @@
 #version 450
+#define TEXTURE_IMAGE_COUNT 4
+
 layout(location = 0) in vec2 uv;
 
-layout(binding = 2) uniform sampler2D[] tex;
+layout(binding = 2) uniform sampler2DArray tex[TEXTURE_IMAGE_COUNT];
+
+struct TextureSlot {
+    vec4 uvTransform;
+    uint image;
+    uint layer;
+};
+
+layout(std430, binding = 3) readonly buffer TextureSlots {
+    TextureSlot slots[];
+} textureSlots;
+
+// Material path, see Material in csm/src/material.h.
+#define MATERIAL_FLAT 0
+#define MATERIAL_TEXTURED 1
+#define MATERIAL_ALPHA_MASKED 2
+
+layout(constant_id = 0) const int MATERIAL = MATERIAL_FLAT;
+layout(constant_id = 2) const int MASK_SLOT = 0;
 
-layout(push_constant) uniform PushConsts{
-    layout(offset = 12) int modelID;
-} consts;
+// Scene textures are packed into array images and atlases, the slot says where each one lives.
+// UVs are clamped like the clamp-to-edge sampler so atlas neighbours never bleed in.
+vec4 SampleTexture(int slot, vec2 uv){
+    TextureSlot s = textureSlots.slots[slot];
+    return texture(tex[s.image], vec3(clamp(uv, 0.0, 1.0) * s.uvTransform.xy + s.uvTransform.zw, float(s.layer)));
+}
 
 void main(){
-    if(consts.modelID == 4){
-        float alpha = texture(tex[1], uv).r;
+    if(MATERIAL == MATERIAL_ALPHA_MASKED){
+        float alpha = SampleTexture(MASK_SLOT, uv).r;
         if(alpha < 0.5) discard;
     }
 }
\ No newline at end of file
@@ -9,7 +9,7 @@ layout(location = 0) out vec2 uv;
 
 layout(push_constant) uniform PushConsts {
 	vec3 position;
-    int modelID;
+    float scale;
 	int cascadeIndex;
 } pushConsts;
 
@@ -23,15 +23,8 @@ layout(binding = 1) uniform UniformBufferObject{
 
 void main(){
     mat4 model = ubo.model;
-    if(pushConsts.modelID == 1){
-        for(int i = 0; i < 3; i++){
-            model[i][i] *= 300;
-        }
-    }
-    if(pushConsts.modelID == 2){
-        for(int i = 0; i < 3; i++){
-            model[i][i] *= 2;
-        }
+    for(int i = 0; i < 3; i++){
+        model[i][i] *= pushConsts.scale;
     }
 	uv = aUV;
     vec3 pos = aPos + pushConsts.position;
@@ -1,16 +1,15 @@
 #include "depthFrameBuffer.h"
+#include "Vulkan/HostAllocator.h"
 
 #include <array>
 
-DepthFrameBuffer::DepthFrameBuffer(int id, const DepthRenderPass& renderPass, const int32_t dim) :
-	renderPass_(renderPass)
+DepthFrameBuffer::DepthFrameBuffer(const vk::DepthBuffer& shadowMap, const DepthRenderPass& renderPass) :
+	renderPass_(renderPass),
+	extent_(shadowMap.Image().Extent())
 {
-	imageView_.reset(new vk::ImageView(renderPass.Device(), renderPass.DepthBuffer().Image().Handle(), renderPass.DepthBuffer().Format(), 
-		VK_IMAGE_ASPECT_DEPTH_BIT, 1, id, VK_IMAGE_VIEW_TYPE_2D_ARRAY));
-
 	std::array<VkImageView, 1> attachments =
 	{
-		imageView_->Handle()
+		shadowMap.ImageView().Handle()
 	};
 
 	VkFramebufferCreateInfo framebufferInfo = {};
@@ -18,17 +17,17 @@ DepthFrameBuffer::DepthFrameBuffer(int id, const DepthRenderPass& renderPass, co
 	framebufferInfo.renderPass = renderPass.Handle();
 	framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
 	framebufferInfo.pAttachments = attachments.data();
-	framebufferInfo.width = dim;
-	framebufferInfo.height = dim;
+	framebufferInfo.width = extent_.width;
+	framebufferInfo.height = extent_.height;
 	framebufferInfo.layers = 1;
 
-	vk::Check(vkCreateFramebuffer(imageView_->Device().Handle(), &framebufferInfo, nullptr, &framebuffer_),
+	vk::Check(vkCreateFramebuffer(renderPass.Device().Handle(), &framebufferInfo, renderPass.Device().HostAllocator().Callbacks(VK_OBJECT_TYPE_FRAMEBUFFER), &framebuffer_),
 		"create framebuffer");
 }
 
 DepthFrameBuffer::DepthFrameBuffer(DepthFrameBuffer&& other) noexcept :
-	imageView_(std::move(other.imageView_)),
 	renderPass_(other.renderPass_),
+	extent_(other.extent_),
 	framebuffer_(other.framebuffer_)
 {
 	other.framebuffer_ = nullptr;
@@ -38,9 +37,8 @@ DepthFrameBuffer::~DepthFrameBuffer()
 {
 	if (framebuffer_ != nullptr)
 	{
-		vkDestroyFramebuffer(imageView_->Device().Handle(), framebuffer_, nullptr);
+		vkDestroyFramebuffer(renderPass_.Device().Handle(), framebuffer_, renderPass_.Device().HostAllocator().Callbacks(VK_OBJECT_TYPE_FRAMEBUFFER));
 		framebuffer_ = nullptr;
 	}
 }
 
-
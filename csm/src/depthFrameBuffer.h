@@ -15,16 +15,17 @@ public:
 	DepthFrameBuffer& operator = (const DepthFrameBuffer&) = delete;
 	DepthFrameBuffer& operator = (DepthFrameBuffer&&) = delete;
 
-	explicit DepthFrameBuffer(int id, const DepthRenderPass& renderPass, const int32_t dim);
+	// Renders into the whole of a single layer shadow map, whose format must be the render pass's.
+	DepthFrameBuffer(const vk::DepthBuffer& shadowMap, const DepthRenderPass& renderPass);
 	DepthFrameBuffer(DepthFrameBuffer&& other) noexcept;
 	~DepthFrameBuffer();
 
-	const vk::ImageView& ImageView() const { return *imageView_; }
+	VkExtent2D Extent() const { return extent_; }
 	const DepthRenderPass& RenderPass() const { return renderPass_; }
 
 private:
-	std::unique_ptr< vk::ImageView> imageView_;
 	const DepthRenderPass& renderPass_;
+	const VkExtent2D extent_;
 
 	VULKAN_HANDLE(VkFramebuffer, framebuffer_);
 };
\ No newline at end of file
@@ -2,185 +2,146 @@
 #include "Assets/Vertex.h"
 #include "Vulkan/ShaderModule.h"
 #include "Vulkan/DescriptorSets.h"
+#include "Vulkan/PipelineBuilder.h"
+#include "Vulkan/ShaderReflection.h"
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+	const char* const VertexShader = "../shaders/shadowMap.vert";
+	const char* const FragmentShader = "../shaders/shadowMap.frag";
+}
 
 DepthPipeline::DepthPipeline(
 	const vk::Device& device,
-	const std::vector<Assets::UniformBuffer>& uniformBuffers,
-	const Assets::UniformBuffer& lightUBO,
-	const vk::DepthBuffer& depthBuffer,
-	const Assets::Scene& scene) :
-	device_(device)
+	const VkDescriptorBufferInfo& uniformBufferInfo,
+	const VkDescriptorBufferInfo& lightInfo,
+	const std::vector<VkFormat>& formats,
+	const Assets::Scene& scene,
+	const std::vector<Material>& materials) :
+	device_(device),
+	formats_(formats),
+	materialCount_(materials.size())
 {
-	const auto bindingDescription = Assets::Vertex::GetBindingDescription();
-	const auto attributeDescriptions = Assets::Vertex::GetAttributeDescriptions();
-
-	VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
-	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexInputInfo.vertexBindingDescriptionCount = 1;
-	vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-	vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-	VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
-	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-	inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-	VkPipelineViewportStateCreateInfo viewportState = {};
-	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-	viewportState.viewportCount = 1;
-	viewportState.scissorCount = 1;
-
-	std::vector<VkDynamicState> dynamicStates = {
-			VK_DYNAMIC_STATE_VIEWPORT,
-			VK_DYNAMIC_STATE_SCISSOR
-	};
-
-	VkPipelineDynamicStateCreateInfo dynamicState{};
-	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-	dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-	dynamicState.pDynamicStates = dynamicStates.data();
-
-	VkPipelineRasterizationStateCreateInfo rasterizer = {};
-	rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-	rasterizer.depthClampEnable = VK_FALSE;
-	rasterizer.rasterizerDiscardEnable = VK_FALSE;
-	rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-	rasterizer.lineWidth = 1.0f;
-	rasterizer.cullMode = VK_CULL_MODE_NONE;
-	rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-	rasterizer.depthBiasEnable = VK_FALSE;
-	rasterizer.depthBiasConstantFactor = 0.0f; // Optional
-	rasterizer.depthBiasClamp = 0.0f; // Optional
-	rasterizer.depthBiasSlopeFactor = 0.0f; // Optional
-
-	VkPipelineMultisampleStateCreateInfo multisampling = {};
-	multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-	multisampling.sampleShadingEnable = VK_FALSE;
-	multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-	multisampling.minSampleShading = 1.0f; // Optional
-	multisampling.pSampleMask = nullptr; // Optional
-	multisampling.alphaToCoverageEnable = VK_FALSE; // Optional
-	multisampling.alphaToOneEnable = VK_FALSE; // Optional
-
-	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
-	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-	depthStencil.depthTestEnable = VK_TRUE;
-	depthStencil.depthWriteEnable = VK_TRUE;
-	depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
-	depthStencil.depthBoundsTestEnable = VK_FALSE;
-	depthStencil.stencilTestEnable = VK_FALSE;
-	depthStencil.back.compareOp = VK_COMPARE_OP_ALWAYS;
-
-	VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
-	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-	colorBlendAttachment.blendEnable = VK_FALSE;
-
-	VkPipelineColorBlendStateCreateInfo colorBlending = {};
-	colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-	colorBlending.logicOpEnable = VK_FALSE;
-	colorBlending.attachmentCount = 0;
-	colorBlending.pAttachments = &colorBlendAttachment;
-
-	// Create descriptor pool/sets.
-	std::vector<vk::DescriptorBinding> descriptorBindings =
+	if (scene.TextureSlots().empty() || scene.TextureImageViews().size() > TEXTURE_IMAGE_COUNT)
 	{
-		{0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT},
-		{1, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT},
-		{2, static_cast<uint32_t>(scene.TextureSamplers().size()), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT}
-	};
+		throw std::runtime_error("scene must be loaded with texture packing into at most " + std::to_string(TEXTURE_IMAGE_COUNT) + " images");
+	}
 
-	descriptorSetManager_.reset(new vk::DescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
+	// Derive the descriptor bindings and push constants from the shaders.
+	vk::ShaderReflection reflection;
+	reflection.AddStage(VK_SHADER_STAGE_VERTEX_BIT, vk::ShaderModule::ReadFile(VertexShader));
+	reflection.AddStage(VK_SHADER_STAGE_FRAGMENT_BIT, vk::ShaderModule::ReadFile(FragmentShader));
+	reflection.CheckPushConstantSize(sizeof(pushBlock));
 
-	auto& descriptorSets = descriptorSetManager_->DescriptorSets();
+	reflection.SetDynamic(0);
+	reflection.SetDynamic(1);
 
-	for (uint32_t i = 0; i != uniformBuffers.size(); ++i)
-	{
-		// Uniform buffer
-		VkDescriptorBufferInfo uniformBufferInfo = {};
-		uniformBufferInfo.buffer = uniformBuffers[i].Buffer().Handle();
-		uniformBufferInfo.range = VK_WHOLE_SIZE;
+	// Create the descriptor set, the light and camera uniform buffers are bound with dynamic offsets.
+	descriptorSetManager_.reset(new vk::DescriptorSetManager(device, reflection, 1));
 
-		VkDescriptorBufferInfo lightUniformBufferInfo = {};
-		lightUniformBufferInfo.buffer = lightUBO.Buffer().Handle();
-		lightUniformBufferInfo.range = lightUBO.BufferSize();
+	auto& descriptorSets = descriptorSetManager_->DescriptorSets();
 
-		// Image and texture samplers
-		std::vector<VkDescriptorImageInfo> imageInfos(scene.TextureSamplers().size());
+	// Image and texture samplers, unused array elements repeat the first image.
+	std::vector<VkDescriptorImageInfo> imageInfos(TEXTURE_IMAGE_COUNT);
 
-		for (size_t t = 0; t != imageInfos.size(); ++t)
-		{
-			auto& imageInfo = imageInfos[t];
-			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageInfo.imageView = scene.TextureImageViews()[t];
-			imageInfo.sampler = scene.TextureSamplers()[t];
-		}
-		const std::vector<VkWriteDescriptorSet> descriptorWrites =
-		{
-			descriptorSets.Bind(i, 0, lightUniformBufferInfo),
-			descriptorSets.Bind(i, 1, uniformBufferInfo),
-			descriptorSets.Bind(i, 2, *imageInfos.data(), static_cast<uint32_t>(imageInfos.size()))
-		};
+	for (size_t t = 0; t != imageInfos.size(); ++t)
+	{
+		const size_t image = t < scene.TextureImageViews().size() ? t : 0;
 
-		descriptorSets.UpdateDescriptors(i, descriptorWrites);
+		auto& imageInfo = imageInfos[t];
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageInfo.imageView = scene.TextureImageViews()[image];
+		imageInfo.sampler = scene.TextureSamplers()[image];
 	}
 
-	VkPushConstantRange pushConstantRange{};
-	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-	pushConstantRange.size = sizeof(pushBlock);
+	VkDescriptorBufferInfo textureSlotBufferInfo = {};
+	textureSlotBufferInfo.buffer = scene.TextureSlotBuffer().Handle();
+	textureSlotBufferInfo.range = VK_WHOLE_SIZE;
 
-	// Create pipeline layout and render pass.
-	pipelineLayout_.reset(new vk::PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout(), pushConstantRange));
-	renderPass_.reset(new DepthRenderPass(device, depthBuffer));
+	const std::vector<VkWriteDescriptorSet> descriptorWrites =
+	{
+		descriptorSets.Bind(0, 0, lightInfo),
+		descriptorSets.Bind(0, 1, uniformBufferInfo),
+		descriptorSets.Bind(0, 2, *imageInfos.data(), static_cast<uint32_t>(imageInfos.size())),
+		descriptorSets.Bind(0, 3, textureSlotBufferInfo)
+	};
 
-	// Load shaders.
-	auto vert_code = vk::ShaderModule::ReadFile("../shaders/shadowMap.vert", shaderc_glsl_vertex_shader);
-	auto frag_code = vk::ShaderModule::ReadFile("../shaders/shadowMap.frag", shaderc_glsl_fragment_shader);
+	descriptorSets.UpdateDescriptors(0, descriptorWrites);
 
-	const vk::ShaderModule vertShader(device, vert_code);
-	const vk::ShaderModule fragShader(device, frag_code);
+	// Create pipeline layout and one render pass per shadow map format, cascades may differ.
+	pipelineLayout_.reset(new vk::PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout(), reflection));
 
-	VkPipelineShaderStageCreateInfo shaderStages[] =
+	for (const auto format : formats_)
 	{
-		vertShader.CreateShaderStage(VK_SHADER_STAGE_VERTEX_BIT),
-		fragShader.CreateShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT)
-	};
+		renderPasses_.emplace_back(new DepthRenderPass(device, format));
+	}
 
-	// Create graphic pipeline
-	VkGraphicsPipelineCreateInfo pipelineInfo = {};
-	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	pipelineInfo.stageCount = 2;
-	pipelineInfo.pStages = shaderStages;
-	pipelineInfo.pVertexInputState = &vertexInputInfo;
-	pipelineInfo.pInputAssemblyState = &inputAssembly;
-	pipelineInfo.pViewportState = &viewportState;
-	pipelineInfo.pRasterizationState = &rasterizer;
-	pipelineInfo.pMultisampleState = &multisampling;
-	pipelineInfo.pDepthStencilState = &depthStencil;
-	pipelineInfo.pColorBlendState = &colorBlending;
-	pipelineInfo.pDynamicState = &dynamicState;
-	pipelineInfo.layout = pipelineLayout_->Handle();
-	pipelineInfo.renderPass = renderPass_->Handle();
-	pipelineInfo.subpass = 0;
-
-	vk::Check(vkCreateGraphicsPipelines(device.Handle(), nullptr, 1, &pipelineInfo, nullptr, &pipeline_),
-		"create graphics pipeline");
+	pipelines_ = CreatePipelines(materials);
 }
 
-DepthPipeline::~DepthPipeline()
+std::vector<std::shared_ptr<vk::Pipeline>> DepthPipeline::CreatePipelines(const std::vector<Material>& materials) const
 {
-	if (pipeline_ != nullptr) {
-		vkDestroyPipeline(Device().Handle(), pipeline_, nullptr);
-		pipeline_ = nullptr;
+	// Create one graphic pipeline per format and material. Only the alpha mask affects depth, so every other
+	// material specializes to the same constants and shares one pipeline.
+	vk::PipelineState state;
+	state.VertexBindings = { Assets::Vertex::GetBindingDescription() };
+	state.VertexAttributes = Assets::Vertex::GetAttributeDescriptions();
+	state.DepthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+	state.ColorAttachmentCount = 0;
+
+	const auto vertCode = vk::ShaderModule::ReadFile(VertexShader);
+	const auto fragCode = vk::ShaderModule::ReadFile(FragmentShader);
+
+	std::vector<std::shared_ptr<vk::Pipeline>> pipelines;
+
+	for (const auto& renderPass : renderPasses_)
+	{
+		for (const auto& material : materials)
+		{
+			Material shadowMaterial;
+
+			if (material.path == Material::AlphaMasked)
+			{
+				shadowMaterial.path = Material::AlphaMasked;
+				shadowMaterial.maskSlot = material.maskSlot;
+			}
+
+			vk::PipelineBuilder builder(device_, state);
+			builder.AddStage(VK_SHADER_STAGE_VERTEX_BIT, vertCode);
+			builder.AddStage(VK_SHADER_STAGE_FRAGMENT_BIT, fragCode, shadowMaterial.Constants());
+
+			pipelines.push_back(builder.Build(*pipelineLayout_, *renderPass, "shadow map"));
+		}
 	}
 
+	return pipelines;
+}
 
+DepthPipeline::~DepthPipeline()
+{
+	pipelines_.clear();
+	renderPasses_.clear();
 	pipelineLayout_.reset();
 	descriptorSetManager_.reset();
 }
 
-VkDescriptorSet DepthPipeline::DescriptorSet(uint32_t index) const
+VkDescriptorSet DepthPipeline::DescriptorSet() const
+{
+	return descriptorSetManager_->DescriptorSets().Handle(0);
+}
+
+size_t DepthPipeline::FormatIndex(const VkFormat format) const
 {
-	return descriptorSetManager_->DescriptorSets().Handle(index);
+	const auto it = std::find(formats_.begin(), formats_.end(), format);
+
+	if (it == formats_.end())
+	{
+		throw std::invalid_argument("no shadow map render pass for this depth format");
+	}
+
+	return it - formats_.begin();
 }
\ No newline at end of file
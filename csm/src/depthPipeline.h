@@ -2,17 +2,19 @@
 #include "Vulkan/VkConfig.h"
 #include "Vulkan/Device.h"
 #include "Vulkan/DescriptorSetManager.h"
+#include "Vulkan/Pipeline.h"
 #include "Vulkan/PipelineLayout.h"
 #include "Vulkan/RenderPass.h"
 #include "Vulkan/Buffer.h"
-#include "Assets/UniformBuffer.h"
 #include "Assets/Scene.h"
 #include "depthRenderPass.h"
+#include "material.h"
 #include <memory>
 #include <array>
+#include <vector>
 
 #define SHADOW_MAP_CASCADE_COUNT 4
-#define SHADOWMAP_DIM 4096
+#define TEXTURE_IMAGE_COUNT 4
 
 class DepthPipeline final {
 public:
@@ -20,29 +22,42 @@ public:
 
 	struct PushBlock {
 		glm::vec3 position;
-		int32_t modelID;
+		float scale;
 		int32_t cascadedID;
 	}pushBlock;
 
 	DepthPipeline(
 		const vk::Device& device,
-		const std::vector<Assets::UniformBuffer>& uniformBuffers,
-		const Assets::UniformBuffer& lightUBO,
-		const vk::DepthBuffer& depthBuffer,
-		const Assets::Scene& scene);
+		const VkDescriptorBufferInfo& uniformBufferInfo,
+		const VkDescriptorBufferInfo& lightInfo,
+		const std::vector<VkFormat>& formats,
+		const Assets::Scene& scene,
+		const std::vector<Material>& materials);
 	~DepthPipeline();
 
-	VkDescriptorSet DescriptorSet(uint32_t index) const;
+	// Variant specialized for materials[material], rendering into shadow maps of the given format.
+	VkPipeline Handle(VkFormat format, size_t material) const { return pipelines_[FormatIndex(format) * materialCount_ + material]->Handle(); }
+	// Binding 0 (light) and 1 (camera) take dynamic offsets, in that order.
+	VkDescriptorSet DescriptorSet() const;
 	const vk::PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
 	const vk::Device& Device() const { return device_; }
-	const DepthRenderPass& RenderPass() const { return *renderPass_; }
+	const DepthRenderPass& RenderPass(VkFormat format) const { return *renderPasses_[FormatIndex(format)]; }
+
+	// Compiles the shaders and creates one pipeline per format and material, safe to call from any thread.
+	std::vector<std::shared_ptr<vk::Pipeline>> CreatePipelines(const std::vector<Material>& materials) const;
+	// Installs pipelines from CreatePipelines(), returns the ones they replace.
+	std::vector<std::shared_ptr<vk::Pipeline>> ReplacePipelines(std::vector<std::shared_ptr<vk::Pipeline>> pipelines) { pipelines_.swap(pipelines); return pipelines; }
 
 private:
+	size_t FormatIndex(VkFormat format) const;
+
 	const vk::Device& device_;
+	const std::vector<VkFormat> formats_;
+	const size_t materialCount_;
 
-	VULKAN_HANDLE(VkPipeline, pipeline_)
+	std::vector<std::shared_ptr<vk::Pipeline>> pipelines_;
 
 	std::unique_ptr<vk::DescriptorSetManager> descriptorSetManager_;
 	std::unique_ptr<vk::PipelineLayout> pipelineLayout_;
-	std::unique_ptr<DepthRenderPass> renderPass_;
+	std::vector<std::unique_ptr<DepthRenderPass>> renderPasses_; // One per format.
 };
\ No newline at end of file
@@ -1,13 +1,15 @@
 #include "depthRenderPass.h"
+#include "Vulkan/HostAllocator.h"
+#include "Vulkan/PipelineBuilder.h"
 #include <array>
 
 DepthRenderPass::DepthRenderPass(
-	const vk::Device& device, const vk::DepthBuffer& depthBuffer) :
+	const vk::Device& device, const VkFormat format) :
 	device_(device),
-	depthBuffer_(depthBuffer)
+	format_(format)
 {
 	VkAttachmentDescription depthAttachment = {};
-	depthAttachment.format = depthBuffer.Format();
+	depthAttachment.format = format;
 	depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
 	depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
 	depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
@@ -55,7 +57,9 @@ DepthRenderPass::DepthRenderPass(
 	renderPassInfo.dependencyCount = 2;
 	renderPassInfo.pDependencies = dependencies.data();
 
-	vk::Check(vkCreateRenderPass(Device().Handle(), &renderPassInfo, nullptr, &renderPass_),
+	hash_ = vk::PipelineBuilder::HashOf(renderPassInfo);
+
+	vk::Check(vkCreateRenderPass(Device().Handle(), &renderPassInfo, Device().HostAllocator().Callbacks(VK_OBJECT_TYPE_RENDER_PASS), &renderPass_),
 		"create render pass");
 }
 
@@ -63,7 +67,7 @@ DepthRenderPass::~DepthRenderPass()
 {
 	if (renderPass_ != nullptr)
 	{
-		vkDestroyRenderPass(Device().Handle(), renderPass_, nullptr);
+		vkDestroyRenderPass(Device().Handle(), renderPass_, Device().HostAllocator().Callbacks(VK_OBJECT_TYPE_RENDER_PASS));
 		renderPass_ = nullptr;
 	}
 }
\ No newline at end of file
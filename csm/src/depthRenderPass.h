@@ -11,16 +11,22 @@ public:
 
 	VULKAN_NON_COPIABLE(DepthRenderPass)
 
-	DepthRenderPass(const vk::Device& device, const vk::DepthBuffer& depthBuffer);
+	// Renders into shadow maps of the given depth format.
+	DepthRenderPass(const vk::Device& device, VkFormat format);
 	~DepthRenderPass();
 
 	const vk::Device& Device() const { return device_; }
-	const vk::DepthBuffer& DepthBuffer() const { return depthBuffer_; }
+	VkFormat Format() const { return format_; }
+
+	// Hash of the render pass description, see PipelineBuilder::HashOf().
+	uint64_t Hash() const { return hash_; }
 
 private:
 
 	const vk::Device& device_;
-	const vk::DepthBuffer& depthBuffer_;
+	const VkFormat format_;
+
+	uint64_t hash_{};
 
 	VULKAN_HANDLE(VkRenderPass, renderPass_)
 };
\ No newline at end of file
@@ -1,15 +1,21 @@
 #include "Vulkan/Enumerate.h"
 #include "Vulkan/Strings.h"
 #include "Vulkan/SwapChain.h"
+#include "Vulkan/ShaderModule.h"
 #include "Vulkan/Version.h"
 #include "Utilities/Console.h"
 #include <algorithm>
 #include <cstdlib>
 #include <iostream>
+#include <iterator>
 #include <stdexcept>
 
 #include "renderer.h"
 
+#ifndef VULKAN_RUNTIME_SHADERS
+#include "EmbeddedShaders.h"
+#endif
+
 namespace
 {
 	void PrintVulkanSdkInformation();
@@ -24,6 +30,10 @@ int main(int argc, const char* argv[]) noexcept
 {
 	try
 	{
+#ifndef VULKAN_RUNTIME_SHADERS
+		vk::ShaderModule::RegisterEmbedded(EmbeddedShaders, std::size(EmbeddedShaders));
+#endif
+
 		const vk::WindowConfig windowConfig
 		{
 			"Vulkan Window",		// title
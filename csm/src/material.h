@@ -0,0 +1,25 @@
+#pragma once
+#include "Vulkan/SpecializationConstants.h"
+#include <cstdint>
+
+// Shading path of a scene model. Scene and shadow pipelines build one variant per material from these values,
+// the constant ids match the layout(constant_id) declarations in scene.frag and shadowMap.frag.
+struct Material {
+	enum Path : int32_t {
+		Flat = 0,
+		Textured = 1,
+		AlphaMasked = 2
+	};
+
+	Path path = Flat;
+	int32_t colorSlot = 0; // texture slot sampled by Textured and AlphaMasked
+	int32_t maskSlot = 0; // texture slot whose red channel AlphaMasked tests against 0.5
+
+	vk::SpecializationConstants Constants() const {
+		vk::SpecializationConstants constants;
+		constants.Set(0, static_cast<int32_t>(path));
+		constants.Set(1, colorSlot);
+		constants.Set(2, maskSlot);
+		return constants;
+	}
+};
@@ -4,20 +4,34 @@
 #include "Assets/Texture.h"
 #include "Assets/UserInterface.h"
 #include "Utilities/Glm.h"
+#include "Utilities/ThreadPool.h"
 #include "Vulkan/Buffer.h"
 #include "Vulkan/BufferUtil.h"
+#include "Vulkan/DeletionQueue.h"
 #include "Vulkan/GraphicsPipeline.h"
 #include "Vulkan/Image.h"
 #include "Vulkan/ImageMemoryBarrier.h"
 #include "Vulkan/ImageView.h"
 #include "Vulkan/PipelineLayout.h"
+#include "Vulkan/ShaderReloader.h"
 #include "Vulkan/SingleTimeCommands.h"
 #include "Vulkan/SwapChain.h"
 #include "Vulkan/Window.h"
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <numeric>
+#include <stdexcept>
+#include <string>
 
+namespace
+{
+    // Offered per cascade, ShadowCascade indexes into them.
+    const uint32_t ShadowMapResolutions[] = { 512, 1024, 2048, 4096 };
+    const VkFormat ShadowMapFormats[] = { VK_FORMAT_D16_UNORM, VK_FORMAT_D32_SFLOAT };
+    const std::vector<std::string> ShadowMapResolutionNames = { "512", "1024", "2048", "4096" };
+    const std::vector<std::string> ShadowMapFormatNames = { "D16", "D32" };
+}
 
 Renderer::Renderer(const vk::WindowConfig& windowConfig, const VkPresentModeKHR presentMode, const bool enableValidationLayers)
     : vk::Application(windowConfig, presentMode, enableValidationLayers)
@@ -26,14 +40,28 @@ Renderer::Renderer(const vk::WindowConfig& windowConfig, const VkPresentModeKHR
 
 Renderer::~Renderer()
 {
+    depthFrameBuffers_.clear();
     depthPipeline_.reset();
     scenePipeline_.reset();
+    shadowMaps_.clear();
     DeleteSwapChain();
     ui_.reset();
     scene_.reset();
     camera_.reset();
 }
 
+void Renderer::SetPhysicalDevice(
+    VkPhysicalDevice physicalDevice,
+    std::vector<const char*>& requiredExtensions,
+    VkPhysicalDeviceFeatures& deviceFeatures,
+    void* nextDeviceFeatures)
+{
+    // The packed scene textures are selected per fragment from a sampler array.
+    deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+
+    Application::SetPhysicalDevice(physicalDevice, requiredExtensions, deviceFeatures, nextDeviceFeatures);
+}
+
 void Renderer::OnDeviceSet()
 {
     Application::OnDeviceSet();
@@ -83,23 +111,53 @@ Assets::UniformBufferObject Renderer::GetUniformBufferObject(const VkExtent2D ex
 
 void Renderer::LoadScene()
 {
-    Assets::Model leaves = Assets::Model::LoadModel("../models/tree/MapleTreeLeaves.obj");
-    Assets::Model stem = Assets::Model::LoadModel("../models/tree/MapleTreeStem.obj");
-    Assets::Model floor = Assets::Model::LoadModel("../models/floor.obj");
-    Assets::Model box = Assets::Model::LoadModel("../models/box.obj");
+    struct SceneModel {
+        const char* path;
+        Material material;
+        float scale;
+    };
+
+    // Floor and box are flat shaded, the stem samples the bark and the leaves are alpha tested against their mask.
+    const SceneModel sceneModels[] = {
+        { "../models/floor.obj", { Material::Flat }, 300.0f },
+        { "../models/box.obj", { Material::Flat }, 2.0f },
+        { "../models/tree/MapleTreeStem.obj", { Material::Textured, 2 }, 1.0f },
+        { "../models/tree/MapleTreeLeaves.obj", { Material::AlphaMasked, 0, 1 }, 1.0f } };
+
+    // Moved into the scene, which releases them once uploaded.
+    std::vector<Assets::Model> models;
+    materials_.clear();
+    modelScales_.clear();
+
+    for (const auto& sceneModel : sceneModels) {
+        models.push_back(Assets::Model::LoadModel(sceneModel.path));
+        materials_.push_back(sceneModel.material);
+        modelScales_.push_back(sceneModel.scale);
+    }
 
-    std::vector<Assets::Model> models { floor, box, stem, leaves };
     std::vector<Assets::Texture> textures;
     textures.push_back(Assets::Texture::LoadTexture("../models/tree/maple_leaf.png", vk::SamplerConfig()));
     textures.push_back(Assets::Texture::LoadTexture("../models/tree/maple_leaf_Mask.png", vk::SamplerConfig()));
     textures.push_back(Assets::Texture::LoadTexture("../models/tree/maple_bark.png", vk::SamplerConfig()));
 
-    scene_.reset(new Assets::Scene(CommandPool(), std::move(models), std::move(textures)));
+    scene_.reset(new Assets::Scene(CommandPool(), std::move(models), std::move(textures), Assets::TexturePacking()));
+
+    // Draw ranges, materials and scales are all indexed by model when recording.
+    if (scene_->DrawRanges().size() != materials_.size()) {
+        throw std::runtime_error("scene has " + std::to_string(scene_->DrawRanges().size()) + " draw ranges but " +
+            std::to_string(materials_.size()) + " materials and model scales");
+    }
 }
 
 void Renderer::Render(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 {
     UpdateUi();
+
+    if (shadowCascadesChanged_) {
+        RecreateShadowMaps();
+        shadowCascadesChanged_ = false;
+    }
+
     UpdateLight();
     UpdateCascades();
 
@@ -110,43 +168,46 @@ void Renderer::Render(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 
         VkRenderPassBeginInfo renderPassInfo = {};
         renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassInfo.renderPass = depthPipeline_->RenderPass().Handle();
         renderPassInfo.renderArea.offset = { 0, 0 };
-        renderPassInfo.renderArea.extent = VkExtent2D { static_cast<int32_t>(SHADOWMAP_DIM), static_cast<int32_t>(SHADOWMAP_DIM) };
         renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
         renderPassInfo.pClearValues = clearValues.data();
 
-        VkViewport viewport {};
-        viewport.x = 0.0f;
-        viewport.y = 0.0f;
-        viewport.width = static_cast<uint32_t>(SHADOWMAP_DIM);
-        viewport.height = static_cast<uint32_t>(SHADOWMAP_DIM);
-        viewport.minDepth = 0.0f;
-        viewport.maxDepth = 1.0f;
-        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        for (int32_t i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++) {
+            // Each cascade has its own resolution and depth format.
+            const auto& frameBuffer = *depthFrameBuffers_[i];
+            const VkFormat format = frameBuffer.RenderPass().Format();
 
-        VkRect2D scissor {};
-        scissor.offset = { 0, 0 };
-        scissor.extent = VkExtent2D { static_cast<int32_t>(SHADOWMAP_DIM), static_cast<int32_t>(SHADOWMAP_DIM) };
-        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+            renderPassInfo.renderPass = frameBuffer.RenderPass().Handle();
+            renderPassInfo.framebuffer = frameBuffer.Handle();
+            renderPassInfo.renderArea.extent = frameBuffer.Extent();
+
+            VkViewport viewport {};
+            viewport.x = 0.0f;
+            viewport.y = 0.0f;
+            viewport.width = static_cast<float>(frameBuffer.Extent().width);
+            viewport.height = static_cast<float>(frameBuffer.Extent().height);
+            viewport.minDepth = 0.0f;
+            viewport.maxDepth = 1.0f;
+            vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+            VkRect2D scissor {};
+            scissor.offset = { 0, 0 };
+            scissor.extent = frameBuffer.Extent();
+            vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-        for (int32_t i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++) {
-            renderPassInfo.framebuffer = depthFrameBuffer_[i].Handle();
             vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
             {
                 const auto& scene = GetScene();
-                VkDescriptorSet descriptorSets[] = { depthPipeline_->DescriptorSet(imageIndex) };
+                VkDescriptorSet descriptorSets[] = { depthPipeline_->DescriptorSet() };
+                uint32_t dynamicOffsets[] = { lightUniformOffset_, UniformBufferOffset() };
                 VkBuffer vertexBuffers[] = { scene.VertexBuffer().Handle() };
                 const VkBuffer indexBuffer = scene.IndexBuffer().Handle();
                 VkDeviceSize offsets[] = { 0 };
 
-                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, depthPipeline_->Handle());
-                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, depthPipeline_->PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, depthPipeline_->PipelineLayout().Handle(), 0, 1, descriptorSets, 2, dynamicOffsets);
                 vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
                 vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
 
-                uint32_t vertexOffset = 0;
-                uint32_t indexOffset = 0;
                 uint32_t modelCount = 0;
                 glm::vec3 position[3] = {
                     glm::vec3(30.f, 0.f, -30.f),
@@ -155,28 +216,24 @@ void Renderer::Render(VkCommandBuffer commandBuffer, uint32_t imageIndex)
                 };
 
                 depthPipeline_->pushBlock.cascadedID = i;
-                for (const auto& model : scene.Models()) {
-                    const auto vertexCount = static_cast<uint32_t>(model.NumberOfVertices());
-                    const auto indexCount = static_cast<uint32_t>(model.NumberOfIndices());
+                for (const auto& range : scene.DrawRanges()) {
+                    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, depthPipeline_->Handle(format, modelCount));
+                    depthPipeline_->pushBlock.scale = modelScales_[modelCount];
 
                     modelCount++;
-                    depthPipeline_->pushBlock.modelID = modelCount;
                     if (modelCount > 2) {
                         for (int i = 0; i < 3; i++) {
                             depthPipeline_->pushBlock.position = position[i];
-                            vkCmdPushConstants(commandBuffer, depthPipeline_->PipelineLayout().Handle(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                            vkCmdPushConstants(commandBuffer, depthPipeline_->PipelineLayout().Handle(), depthPipeline_->PipelineLayout().PushConstantStages(),
                                 0, sizeof(DepthPipeline::pushBlock), &depthPipeline_->pushBlock);
-                            vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexOffset, vertexOffset, 0);
+                            vkCmdDrawIndexed(commandBuffer, range.IndexCount, 1, range.FirstIndex, range.VertexOffset, 0);
                         }
                     } else {
                         depthPipeline_->pushBlock.position = glm::vec3(0.f);
-                        vkCmdPushConstants(commandBuffer, depthPipeline_->PipelineLayout().Handle(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                        vkCmdPushConstants(commandBuffer, depthPipeline_->PipelineLayout().Handle(), depthPipeline_->PipelineLayout().PushConstantStages(),
                             0, sizeof(DepthPipeline::pushBlock), &depthPipeline_->pushBlock);
-                        vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexOffset, vertexOffset, 0);
+                        vkCmdDrawIndexed(commandBuffer, range.IndexCount, 1, range.FirstIndex, range.VertexOffset, 0);
                     }
-
-                    vertexOffset += vertexCount;
-                    indexOffset += indexCount;
                 }
             }
             vkCmdEndRenderPass(commandBuffer);
@@ -215,18 +272,16 @@ void Renderer::Render(VkCommandBuffer commandBuffer, uint32_t imageIndex)
             vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
             const auto& scene = GetScene();
-            VkDescriptorSet descriptorSets[] = { scenePipeline_->DescriptorSet(imageIndex) };
+            VkDescriptorSet descriptorSets[] = { scenePipeline_->DescriptorSet() };
+            uint32_t dynamicOffsets[] = { UniformBufferOffset(), shadowUniformOffset_ };
             VkBuffer vertexBuffers[] = { scene.VertexBuffer().Handle() };
             const VkBuffer indexBuffer = scene.IndexBuffer().Handle();
             VkDeviceSize offsets[] = { 0 };
 
-            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, scenePipeline_->Handle());
-            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, scenePipeline_->PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, scenePipeline_->PipelineLayout().Handle(), 0, 1, descriptorSets, 2, dynamicOffsets);
             vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
             vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
 
-            uint32_t vertexOffset = 0;
-            uint32_t indexOffset = 0;
             uint32_t modelCount = 0;
             glm::vec3 position[3] = {
                 glm::vec3(30.f, 0.f, -30.f),
@@ -235,28 +290,24 @@ void Renderer::Render(VkCommandBuffer commandBuffer, uint32_t imageIndex)
             };
 
             scenePipeline_->pushBlock.colorCascades = colorCascades;
-            for (const auto& model : scene.Models()) {
-                const auto vertexCount = static_cast<uint32_t>(model.NumberOfVertices());
-                const auto indexCount = static_cast<uint32_t>(model.NumberOfIndices());
+            for (const auto& range : scene.DrawRanges()) {
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, scenePipeline_->Handle(modelCount));
+                scenePipeline_->pushBlock.scale = modelScales_[modelCount];
 
                 modelCount++;
-                scenePipeline_->pushBlock.modelID = modelCount;
                 if (modelCount > 2) {
                     for (int i = 0; i < 3; i++) {
                         scenePipeline_->pushBlock.position = position[i];
-                        vkCmdPushConstants(commandBuffer, scenePipeline_->PipelineLayout().Handle(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                        vkCmdPushConstants(commandBuffer, scenePipeline_->PipelineLayout().Handle(), scenePipeline_->PipelineLayout().PushConstantStages(),
                             0, sizeof(ScenePipeline::pushBlock), &scenePipeline_->pushBlock);
-                        vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexOffset, vertexOffset, 0);
+                        vkCmdDrawIndexed(commandBuffer, range.IndexCount, 1, range.FirstIndex, range.VertexOffset, 0);
                     }
                 } else {
                     scenePipeline_->pushBlock.position = glm::vec3(0.f);
-                    vkCmdPushConstants(commandBuffer, scenePipeline_->PipelineLayout().Handle(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                    vkCmdPushConstants(commandBuffer, scenePipeline_->PipelineLayout().Handle(), scenePipeline_->PipelineLayout().PushConstantStages(),
                         0, sizeof(ScenePipeline::pushBlock), &scenePipeline_->pushBlock);
-                    vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexOffset, vertexOffset, 0);
+                    vkCmdDrawIndexed(commandBuffer, range.IndexCount, 1, range.FirstIndex, range.VertexOffset, 0);
                 }
-
-                vertexOffset += vertexCount;
-                indexOffset += indexCount;
             }
 
             UI().Draw(commandBuffer);
@@ -278,23 +329,88 @@ void Renderer::Prepare()
     float zNear = 0.5f;
     float zFar = 200.f;
     camera_.reset(new Assets::Camera(viewPos, target, worldUp, fov, aspect, zNear, zFar));
-    ui_.reset(new Assets::UserInterface(CommandPool(), GraphicsPipeline().RenderPass()));
 
     UpdateLight();
 
-    cascadedDepthBuffer_.reset(new vk::DepthBuffer(CommandPool(), VkExtent2D { static_cast<int32_t>(SHADOWMAP_DIM), static_cast<int32_t>(SHADOWMAP_DIM) }, static_cast<int32_t>(SHADOW_MAP_CASCADE_COUNT), true));
-    lightUniformBuffer_.reset(new Assets::UniformBuffer(Device(), lightUBO_));
-    shadowUniformBuffer_.reset(new Assets::UniformBuffer(Device(), shadowUBO_));
-    depthPipeline_.reset(new DepthPipeline(Device(), UniformBuffers(), GetLightUniformBuffer(), GetCascadedDepthBuffer(), GetScene()));
-    scenePipeline_.reset(new ScenePipeline(Device(), UniformBuffers(), GetScene(), GraphicsPipeline().RenderPass(), GetCascadedDepthBuffer(), GetShadowUniformBuffer()));
+    CreateShadowMaps();
 
-    for (int32_t i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++) {
-        depthFrameBuffer_.emplace_back(i, depthPipeline_->RenderPass(), SHADOWMAP_DIM);
+    // Both pipelines compile their shaders and driver state as separate tasks. The UI uploads through the
+    // command pool, so it is built on this thread meanwhile; the results are joined before first use.
+    {
+        Utilities::ThreadPool threadPool;
+
+        auto depthPipeline = threadPool.Submit([this]() {
+            return std::unique_ptr<DepthPipeline>(new DepthPipeline(Device(), UniformBufferInfo(), GetLightUniformBufferInfo(), GetShadowMapFormats(), GetScene(), materials_)); });
+        auto scenePipeline = threadPool.Submit([this]() {
+            return std::unique_ptr<ScenePipeline>(new ScenePipeline(Device(), UniformBufferInfo(), GetScene(), GraphicsPipeline().RenderPass(), shadowMaps_, GetShadowUniformBufferInfo(), materials_)); });
+
+        ui_.reset(new Assets::UserInterface(CommandPool(), GraphicsPipeline().RenderPass()));
+
+        depthPipeline_ = depthPipeline.get();
+        scenePipeline_ = scenePipeline.get();
     }
 
+    // Edited shaders are rebuilt in the background and swapped in between frames.
+    using Pipelines = std::vector<std::shared_ptr<vk::Pipeline>>;
+
+    ShaderReloader().Watch<Pipelines>({ "shadowMap.vert", "shadowMap.frag" },
+        [this]() { return depthPipeline_->CreatePipelines(materials_); },
+        [this](Pipelines pipelines) { return depthPipeline_->ReplacePipelines(std::move(pipelines)); });
+    ShaderReloader().Watch<Pipelines>({ "scene.vert", "scene.frag" },
+        [this]() { return scenePipeline_->CreatePipelines(GraphicsPipeline().RenderPass(), materials_); },
+        [this](Pipelines pipelines) { return scenePipeline_->ReplacePipelines(std::move(pipelines)); });
+
+    CreateDepthFrameBuffers();
+
     UpdateUi();
 }
 
+void Renderer::CreateShadowMaps()
+{
+    for (const auto& cascade : shadowCascades_) {
+        const uint32_t resolution = ShadowMapResolutions[cascade.resolution];
+        shadowMaps_.emplace_back(new vk::DepthBuffer(CommandPool(), VkExtent2D { resolution, resolution }, 1, true, ShadowMapFormats[cascade.format]));
+    }
+}
+
+void Renderer::CreateDepthFrameBuffers()
+{
+    for (const auto& shadowMap : shadowMaps_) {
+        depthFrameBuffers_.emplace_back(new DepthFrameBuffer(*shadowMap, depthPipeline_->RenderPass(shadowMap->Format())));
+    }
+}
+
+void Renderer::RecreateShadowMaps()
+{
+    // A settings change, so a stall is fine: the shader reloader may be rebuilding from the current pipelines on
+    // a worker, and draining it releases the pipelines it retired, which requires an idle device.
+    Device().WaitIdle();
+    ShaderReloader().Drain();
+
+    depthFrameBuffers_.clear();
+    depthPipeline_.reset();
+    scenePipeline_.reset();
+    shadowMaps_.clear();
+
+    // The render passes depend on the formats and the scene descriptors on the maps, both pipelines are rebuilt.
+    CreateShadowMaps();
+    depthPipeline_.reset(new DepthPipeline(Device(), UniformBufferInfo(), GetLightUniformBufferInfo(), GetShadowMapFormats(), GetScene(), materials_));
+    scenePipeline_.reset(new ScenePipeline(Device(), UniformBufferInfo(), GetScene(), GraphicsPipeline().RenderPass(), shadowMaps_, GetShadowUniformBufferInfo(), materials_));
+    CreateDepthFrameBuffers();
+}
+
+std::vector<VkFormat> Renderer::GetShadowMapFormats() const
+{
+    // Distinct, a device lacking one may have substituted another.
+    std::vector<VkFormat> formats;
+    for (const auto& shadowMap : shadowMaps_) {
+        if (std::find(formats.begin(), formats.end(), shadowMap->Format()) == formats.end()) {
+            formats.push_back(shadowMap->Format());
+        }
+    }
+    return formats;
+}
+
 void Renderer::UpdateLight()
 {
     static auto startTime = std::chrono::high_resolution_clock::now();
@@ -371,7 +487,7 @@ void Renderer::UpdateCascades()
         float sphereRadius = std::sqrtf(zDistance * zDistance + (a2 * 0.25f));
 
         // https://learn.microsoft.com/zh-cn/windows/win32/dxtecharts/common-techniques-to-improve-shadow-depth-maps
-        float worldUnitsPerPixel = sphereRadius * 2.f / (float)SHADOWMAP_DIM;
+        float worldUnitsPerPixel = sphereRadius * 2.f / (float)shadowMaps_[i]->Image().Extent().width;
         sphereRadius = std::floor(sphereRadius / worldUnitsPerPixel) * worldUnitsPerPixel;
         glm::vec3 lightDir = normalize(lightPos);
         glm::mat4 shadowView = glm::lookAt(glm::vec3(0.f), -lightDir, glm::vec3(0.0f, 1.0f, 0.0f));
@@ -395,8 +511,8 @@ void Renderer::UpdateCascades()
     }
     shadowUBO_.lightDir = normalize(-lightPos);
 
-    shadowUniformBuffer_->SetValue(shadowUBO_);
-    lightUniformBuffer_->SetValue(lightUBO_);
+    shadowUniformOffset_ = UniformRing().Push(shadowUBO_);
+    lightUniformOffset_ = UniformRing().Push(lightUBO_);
 }
 
 void Renderer::UpdateUi()
@@ -420,7 +536,7 @@ void Renderer::UpdateUi()
     ImGui::NewFrame();
 
     ImGui::SetNextWindowPos(ImVec2(10, 10));
-    ImGui::SetNextWindowSize(ImVec2(200 * scale, 360 * scale), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(200 * scale, 480 * scale), ImGuiCond_Always);
     ImGui::Begin("Cascaded Shadow Map", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove);
     ImGui::PushItemWidth(100.0f * scale);
 
@@ -429,6 +545,19 @@ void Renderer::UpdateUi()
 
     UI().checkbox("Color cascades", &colorCascades);
 
+    if (UI().header("Shadow maps")) {
+        for (int32_t i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++) {
+            const std::string cascade = "Cascade " + std::to_string(i);
+            shadowCascadesChanged_ |= UI().combo((cascade + " size").c_str(), &shadowCascades_[i].resolution, ShadowMapResolutionNames);
+            shadowCascadesChanged_ |= UI().combo((cascade + " depth").c_str(), &shadowCascades_[i].format, ShadowMapFormatNames);
+        }
+    }
+
+    if (UI().header("Memory")) {
+        UI().memoryStatistics(Device().Allocator());
+        UI().hostStatistics(Device().HostAllocator());
+    }
+
     ImGui::PopItemWidth();
     ImGui::End();
     ImGui::Render();
@@ -442,7 +571,12 @@ void Renderer::UpdateUi()
 
         bool updateBuffers = (vertexBufferSize != UI().vertexBufferSize || indexBufferSize != UI().indexBufferSize);
         if (updateBuffers) {
-            vkDeviceWaitIdle(Device().Handle());
+            // Frames in flight may still draw with the old buffers, they are destroyed once those have completed.
+            auto& deletionQueue = Device().DeletionQueue();
+            deletionQueue.Retire(std::move(UI().vertexBuffer));
+            deletionQueue.Retire(std::move(UI().vertexBufferMemory));
+            deletionQueue.Retire(std::move(UI().indexBuffer));
+            deletionQueue.Retire(std::move(UI().indexBufferMemory));
             UI().vertexBuffer.reset(new vk::Buffer(Device(), vertexBufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT));
             UI().indexBuffer.reset(new vk::Buffer(Device(), indexBufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT));
             UI().vertexBufferMemory.reset(new vk::DeviceMemory(UI().vertexBuffer->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)));
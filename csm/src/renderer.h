@@ -6,6 +6,7 @@
 #include "Assets/UserInterface.h"
 #include "Assets/UniformBuffer.h"
 #include "Assets/GltfModel.h"
+#include "Vulkan/UniformRing.h"
 #include "scenePipeline.h"
 #include "depthPipeline.h"
 #include "depthFrameBuffer.h"
@@ -21,15 +22,21 @@ public:
 	Renderer(const vk::WindowConfig& windowConfig, VkPresentModeKHR presentMode, bool enableValidationLayers);
 	~Renderer();
 
+	using vk::Application::SetPhysicalDevice;
+
 protected:
+	void SetPhysicalDevice(
+		VkPhysicalDevice physicalDevice,
+		std::vector<const char*>& requiredExtensions,
+		VkPhysicalDeviceFeatures& deviceFeatures,
+		void* nextDeviceFeatures) override;
 	void OnDeviceSet() override;
 
 	const Assets::Scene& GetScene() const override { return *scene_; }
 	Assets::UniformBufferObject GetUniformBufferObject(VkExtent2D extent) const override;
 	Assets::UserInterface& UI() const { return *ui_; }
-	vk::DepthBuffer& GetCascadedDepthBuffer() const { return *cascadedDepthBuffer_; }
-	const Assets::UniformBuffer& GetLightUniformBuffer() const { return *lightUniformBuffer_; }
-	const Assets::UniformBuffer& GetShadowUniformBuffer() const { return *shadowUniformBuffer_; }
+	VkDescriptorBufferInfo GetLightUniformBufferInfo() { return UniformRing().Descriptor(sizeof(lightUBO_)); }
+	VkDescriptorBufferInfo GetShadowUniformBufferInfo() { return UniformRing().Descriptor(sizeof(shadowUBO_)); }
 
 	void CreateSwapChain() override;
 	void DeleteSwapChain() override;
@@ -43,6 +50,10 @@ protected:
 	void UpdateUi();
 	void UpdateLight();
 	void UpdateCascades();
+	void CreateShadowMaps();
+	void CreateDepthFrameBuffers();
+	void RecreateShadowMaps();
+	std::vector<VkFormat> GetShadowMapFormats() const;
 	void RenderScene();
 
 	const bool& GetMouseLeftDown() const { return mouseStatus_.lDown; }
@@ -58,14 +69,22 @@ private:
 	void LoadScene();
 
 	std::unique_ptr<const Assets::Scene> scene_;
+	std::vector<Material> materials_; // one per scene model
+	std::vector<float> modelScales_; // one per scene model
 	std::unique_ptr<Assets::Camera> camera_;
 	std::unique_ptr<class Assets::UserInterface> ui_;
 	std::unique_ptr<ScenePipeline> scenePipeline_;
 	std::unique_ptr<DepthPipeline> depthPipeline_;
-	std::vector<DepthFrameBuffer> depthFrameBuffer_;
-	std::unique_ptr<vk::DepthBuffer> cascadedDepthBuffer_;
-	std::unique_ptr<Assets::UniformBuffer> lightUniformBuffer_;
-	std::unique_ptr<Assets::UniformBuffer> shadowUniformBuffer_;
+	std::vector<std::unique_ptr<DepthFrameBuffer>> depthFrameBuffers_; // One per cascade.
+	std::vector<std::unique_ptr<vk::DepthBuffer>> shadowMaps_; // One per cascade.
+
+	// Far cascades cover more of the scene per texel, they can do with less resolution and depth precision.
+	struct ShadowCascade {
+		int32_t resolution; // Index into ShadowMapResolutions.
+		int32_t format; // Index into ShadowMapFormats.
+	};
+	std::array<ShadowCascade, SHADOW_MAP_CASCADE_COUNT> shadowCascades_ = { { { 3, 1 }, { 2, 1 }, { 2, 0 }, { 1, 0 } } };
+	bool shadowCascadesChanged_{};
 
 	struct {
 		bool lDown = false, rDown = false;
@@ -84,6 +103,10 @@ private:
 		glm::vec3 lightDir;
 	} shadowUBO_;
 
+	// Of this frame's lightUBO_ and shadowUBO_ in the uniform ring.
+	uint32_t lightUniformOffset_{};
+	uint32_t shadowUniformOffset_{};
+
 	const float cascadeSplitLambda = 0.95f;
 	glm::vec3 lightPos;
 	bool colorCascades;
@@ -1,211 +1,136 @@
 #include "scenePipeline.h"
+#include "depthPipeline.h"
 #include "Assets/Vertex.h"
 #include "Vulkan/ShaderModule.h"
 #include "Vulkan/DescriptorSets.h"
 #include "Vulkan/DepthBuffer.h"
 #include "Vulkan/ImageView.h"
 #include "Vulkan/Sampler.h"
+#include "Vulkan/PipelineBuilder.h"
+#include "Vulkan/ShaderReflection.h"
 #include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+	const char* const VertexShader = "../shaders/scene.vert";
+	const char* const FragmentShader = "../shaders/scene.frag";
+}
 
 ScenePipeline::ScenePipeline(
 	const vk::Device& device,
-	const std::vector<Assets::UniformBuffer>& uniformBuffers,
+	const VkDescriptorBufferInfo& uniformBufferInfo,
 	const Assets::Scene& scene,
 	const vk::RenderPass& renderPass, 
-	const vk::DepthBuffer& depthBuffer,
-	const Assets::UniformBuffer& shadowUBO) :
+	const std::vector<std::unique_ptr<vk::DepthBuffer>>& shadowMaps,
+	const VkDescriptorBufferInfo& shadowInfo,
+	const std::vector<Material>& materials) :
 	device_(device)
 {
-	const auto bindingDescription = Assets::Vertex::GetBindingDescription();
-	const auto attributeDescriptions = Assets::Vertex::GetAttributeDescriptions();
-
-	VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
-	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexInputInfo.vertexBindingDescriptionCount = 1;
-	vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-	vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-	VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
-	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-	inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-	VkPipelineViewportStateCreateInfo viewportState = {};
-	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-	viewportState.viewportCount = 1;
-	viewportState.scissorCount = 1;
-
-	std::vector<VkDynamicState> dynamicStates = {
-			VK_DYNAMIC_STATE_VIEWPORT,
-			VK_DYNAMIC_STATE_SCISSOR
-	};
-
-	VkPipelineDynamicStateCreateInfo dynamicState{};
-	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-	dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-	dynamicState.pDynamicStates = dynamicStates.data();
-
-	VkPipelineRasterizationStateCreateInfo rasterizer = {};
-	rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-	rasterizer.depthClampEnable = VK_FALSE;
-	rasterizer.rasterizerDiscardEnable = VK_FALSE;
-	rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-	rasterizer.lineWidth = 1.0f;
-	rasterizer.cullMode = VK_CULL_MODE_NONE;
-	rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-	rasterizer.depthBiasEnable = VK_FALSE;
-	rasterizer.depthBiasConstantFactor = 0.0f; // Optional
-	rasterizer.depthBiasClamp = 0.0f; // Optional
-	rasterizer.depthBiasSlopeFactor = 0.0f; // Optional
-
-	VkPipelineMultisampleStateCreateInfo multisampling = {};
-	multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-	multisampling.sampleShadingEnable = VK_FALSE;
-	multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-	multisampling.minSampleShading = 1.0f; // Optional
-	multisampling.pSampleMask = nullptr; // Optional
-	multisampling.alphaToCoverageEnable = VK_FALSE; // Optional
-	multisampling.alphaToOneEnable = VK_FALSE; // Optional
-
-	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
-	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-	depthStencil.depthTestEnable = VK_TRUE;
-	depthStencil.depthWriteEnable = VK_TRUE;
-	depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-	depthStencil.depthBoundsTestEnable = VK_FALSE;
-	depthStencil.minDepthBounds = 0.0f; // Optional
-	depthStencil.maxDepthBounds = 1.0f; // Optional
-	depthStencil.stencilTestEnable = VK_FALSE;
-	depthStencil.front = {}; // Optional
-	depthStencil.back = {}; // Optional
-
-	VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
-	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-	colorBlendAttachment.blendEnable = VK_TRUE;
-	colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA; 
-	colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA; 
-	colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD; 
-	colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE; 
-	colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO; 
-	colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD; 
-
-	VkPipelineColorBlendStateCreateInfo colorBlending = {};
-	colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-	colorBlending.logicOpEnable = VK_FALSE;
-	colorBlending.logicOp = VK_LOGIC_OP_COPY; // Optional
-	colorBlending.attachmentCount = 1;
-	colorBlending.pAttachments = &colorBlendAttachment;
-	colorBlending.blendConstants[0] = 0.0f; // Optional
-	colorBlending.blendConstants[1] = 0.0f; // Optional
-	colorBlending.blendConstants[2] = 0.0f; // Optional
-	colorBlending.blendConstants[3] = 0.0f; // Optional
-
-	// Create descriptor pool/sets.
-	std::vector<vk::DescriptorBinding> descriptorBindings =
+	if (scene.TextureSlots().empty() || scene.TextureImageViews().size() > TEXTURE_IMAGE_COUNT)
 	{
-		{0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT},
-		{1, static_cast<uint32_t>(scene.TextureSamplers().size()), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT},
-		{2, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT},
-		{3, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT}
-	};
+		throw std::runtime_error("scene must be loaded with texture packing into at most " + std::to_string(TEXTURE_IMAGE_COUNT) + " images");
+	}
 
-	descriptorSetManager_.reset(new vk::DescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
+	// Derive the descriptor bindings and push constants from the shaders.
+	vk::ShaderReflection reflection;
+	reflection.AddStage(VK_SHADER_STAGE_VERTEX_BIT, vk::ShaderModule::ReadFile(VertexShader));
+	reflection.AddStage(VK_SHADER_STAGE_FRAGMENT_BIT, vk::ShaderModule::ReadFile(FragmentShader));
+	reflection.CheckPushConstantSize(sizeof(PushBlock));
+
+	reflection.SetDynamic(0);
+	reflection.SetDynamic(3);
+
+	// Create the descriptor set, the camera and shadow uniform buffers are bound with dynamic offsets.
+	descriptorSetManager_.reset(new vk::DescriptorSetManager(device, reflection, 1));
 
 	auto& descriptorSets = descriptorSetManager_->DescriptorSets();
 
-	for (uint32_t i = 0; i != uniformBuffers.size(); ++i)
+	// Image and texture samplers, unused array elements repeat the first image.
+	std::vector<VkDescriptorImageInfo> imageInfos(TEXTURE_IMAGE_COUNT);
+
+	for (size_t t = 0; t != imageInfos.size(); ++t)
 	{
-		// Uniform buffer
-		VkDescriptorBufferInfo uniformBufferInfo = {};
-		uniformBufferInfo.buffer = uniformBuffers[i].Buffer().Handle();
-		uniformBufferInfo.range = VK_WHOLE_SIZE;
-
-		VkDescriptorBufferInfo shadowUniformBufferInfo = {};
-		shadowUniformBufferInfo.buffer = shadowUBO.Buffer().Handle();
-		shadowUniformBufferInfo.range = shadowUBO.BufferSize();
-
-		// Image and texture samplers
-		std::vector<VkDescriptorImageInfo> imageInfos(scene.TextureSamplers().size());
-
-		for (size_t t = 0; t != imageInfos.size(); ++t)
-		{
-			auto& imageInfo = imageInfos[t];
-			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageInfo.imageView = scene.TextureImageViews()[t];
-			imageInfo.sampler = scene.TextureSamplers()[t];
-		}
-
-		VkDescriptorImageInfo depthImageInfo{};
-		depthImageInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
-		depthImageInfo.imageView = depthBuffer.ImageView().Handle();
-		depthImageInfo.sampler = depthBuffer.Sampler().Handle();
-
-		const std::vector<VkWriteDescriptorSet> descriptorWrites =
-		{
-			descriptorSets.Bind(i, 0, uniformBufferInfo),
-			descriptorSets.Bind(i, 1, *imageInfos.data(), static_cast<uint32_t>(imageInfos.size())),
-			descriptorSets.Bind(i, 2, depthImageInfo),
-			descriptorSets.Bind(i, 3, shadowUniformBufferInfo)
-		};
-
-		descriptorSets.UpdateDescriptors(i, descriptorWrites);
-	}
+		const size_t image = t < scene.TextureImageViews().size() ? t : 0;
 
-	VkPushConstantRange pushConstantRange{};
-	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-	pushConstantRange.size = sizeof(PushBlock);
+		auto& imageInfo = imageInfos[t];
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageInfo.imageView = scene.TextureImageViews()[image];
+		imageInfo.sampler = scene.TextureSamplers()[image];
+	}
 
-	// Create pipeline layout and render pass.
-	pipelineLayout_.reset(new vk::PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout(), pushConstantRange));
+	VkDescriptorBufferInfo textureSlotBufferInfo = {};
+	textureSlotBufferInfo.buffer = scene.TextureSlotBuffer().Handle();
+	textureSlotBufferInfo.range = VK_WHOLE_SIZE;
 
-	// Load shaders.
-	auto vert_code = vk::ShaderModule::ReadFile("../shaders/scene.vert", shaderc_glsl_vertex_shader);
-	auto frag_code = vk::ShaderModule::ReadFile("../shaders/scene.frag", shaderc_glsl_fragment_shader);
+	// Cascades may differ in resolution and format, so each has an image of its own.
+	std::vector<VkDescriptorImageInfo> shadowMapInfos(SHADOW_MAP_CASCADE_COUNT);
 
-	const vk::ShaderModule vertShader(device, vert_code);
-	const vk::ShaderModule fragShader(device, frag_code);
+	for (size_t i = 0; i != shadowMapInfos.size(); ++i)
+	{
+		auto& imageInfo = shadowMapInfos[i];
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		imageInfo.imageView = shadowMaps[i]->ImageView().Handle();
+		imageInfo.sampler = shadowMaps[i]->Sampler().Handle();
+	}
 
-	VkPipelineShaderStageCreateInfo shaderStages[] =
+	const std::vector<VkWriteDescriptorSet> descriptorWrites =
 	{
-		vertShader.CreateShaderStage(VK_SHADER_STAGE_VERTEX_BIT),
-		fragShader.CreateShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT)
+		descriptorSets.Bind(0, 0, uniformBufferInfo),
+		descriptorSets.Bind(0, 1, *imageInfos.data(), static_cast<uint32_t>(imageInfos.size())),
+		descriptorSets.Bind(0, 2, *shadowMapInfos.data(), static_cast<uint32_t>(shadowMapInfos.size())),
+		descriptorSets.Bind(0, 3, shadowInfo),
+		descriptorSets.Bind(0, 4, textureSlotBufferInfo)
 	};
 
-	// Create graphic pipeline
-	VkGraphicsPipelineCreateInfo pipelineInfo = {};
-	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	pipelineInfo.stageCount = 2;
-	pipelineInfo.pStages = shaderStages;
-	pipelineInfo.pVertexInputState = &vertexInputInfo;
-	pipelineInfo.pInputAssemblyState = &inputAssembly;
-	pipelineInfo.pViewportState = &viewportState;
-	pipelineInfo.pRasterizationState = &rasterizer;
-	pipelineInfo.pMultisampleState = &multisampling;
-	pipelineInfo.pDepthStencilState = &depthStencil;
-	pipelineInfo.pColorBlendState = &colorBlending;
-	pipelineInfo.pDynamicState = &dynamicState;
-	pipelineInfo.layout = pipelineLayout_->Handle();
-	pipelineInfo.renderPass = renderPass.Handle();
-	pipelineInfo.subpass = 0;
-
-	vk::Check(vkCreateGraphicsPipelines(device.Handle(), nullptr, 1, &pipelineInfo, nullptr, &pipeline_),
-		"create graphics pipeline");
+	descriptorSets.UpdateDescriptors(0, descriptorWrites);
+
+	// Create pipeline layout and render pass.
+	pipelineLayout_.reset(new vk::PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout(), reflection));
+
+	pipelines_ = CreatePipelines(renderPass, materials);
 }
 
-ScenePipeline::~ScenePipeline()
+std::vector<std::shared_ptr<vk::Pipeline>> ScenePipeline::CreatePipelines(const vk::RenderPass& renderPass, const std::vector<Material>& materials) const
 {
-	if (pipeline_ != nullptr) {
-		vkDestroyPipeline(Device().Handle(), pipeline_, nullptr);
-		pipeline_ = nullptr;
+	// Create one graphic pipeline per material, materials with equal constants share a pipeline.
+	vk::PipelineState state;
+	state.VertexBindings = { Assets::Vertex::GetBindingDescription() };
+	state.VertexAttributes = Assets::Vertex::GetAttributeDescriptions();
+	state.ColorBlend.blendEnable = VK_TRUE;
+	state.ColorBlend.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+	state.ColorBlend.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+
+	const auto vertCode = vk::ShaderModule::ReadFile(VertexShader);
+	const auto fragCode = vk::ShaderModule::ReadFile(FragmentShader);
+
+	std::vector<std::shared_ptr<vk::Pipeline>> pipelines;
+
+	for (const auto& material : materials)
+	{
+		auto constants = material.Constants();
+		constants.Set(3, static_cast<int32_t>(SHADOW_MAP_CASCADE_COUNT));
+		constants.Set(4, static_cast<int32_t>(SHADOW_PCF_RANGE));
+
+		vk::PipelineBuilder builder(device_, state);
+		builder.AddStage(VK_SHADER_STAGE_VERTEX_BIT, vertCode);
+		builder.AddStage(VK_SHADER_STAGE_FRAGMENT_BIT, fragCode, constants);
+
+		pipelines.push_back(builder.Build(*pipelineLayout_, renderPass, "scene"));
 	}
 
+	return pipelines;
+}
 
+ScenePipeline::~ScenePipeline()
+{
+	pipelines_.clear();
 	pipelineLayout_.reset();
 	descriptorSetManager_.reset();
 }
 
-VkDescriptorSet ScenePipeline::DescriptorSet(uint32_t index) const
+VkDescriptorSet ScenePipeline::DescriptorSet() const
 {
-	return descriptorSetManager_->DescriptorSets().Handle(index);
+	return descriptorSetManager_->DescriptorSets().Handle(0);
 }
\ No newline at end of file
@@ -2,11 +2,15 @@
 #include "Vulkan/VkConfig.h"
 #include "Vulkan/Device.h"
 #include "Vulkan/DescriptorSetManager.h"
+#include "Vulkan/Pipeline.h"
 #include "Vulkan/PipelineLayout.h"
 #include "Vulkan/RenderPass.h"
-#include "Assets/UniformBuffer.h"
 #include "Assets/Scene.h"
+#include "material.h"
 #include <memory>
+#include <vector>
+
+#define SHADOW_PCF_RANGE 1
 
 class ScenePipeline final {
 public:
@@ -14,27 +18,36 @@ public:
 
 	struct PushBlock {
 		glm::vec3 position;
-		int32_t modelID;
+		float scale;
 		int32_t colorCascades;
 	}pushBlock;
 
 	ScenePipeline(
 		const vk::Device& device,
-		const std::vector<Assets::UniformBuffer>& uniformBuffers,
+		const VkDescriptorBufferInfo& uniformBufferInfo,
 		const Assets::Scene& scene,
 		const vk::RenderPass& renderPass,
-		const vk::DepthBuffer& depthBuffer,
-		const Assets::UniformBuffer& shadowUBO);
+		const std::vector<std::unique_ptr<vk::DepthBuffer>>& shadowMaps, // One per cascade.
+		const VkDescriptorBufferInfo& shadowInfo,
+		const std::vector<Material>& materials);
 	~ScenePipeline();
 
-	VkDescriptorSet DescriptorSet(uint32_t index) const;
+	// Variant specialized for materials[material].
+	VkPipeline Handle(size_t material) const { return pipelines_[material]->Handle(); }
+	// Binding 0 (camera) and 3 (shadow) take dynamic offsets, in that order.
+	VkDescriptorSet DescriptorSet() const;
 	const vk::PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
 	const vk::Device& Device() const { return device_; }
 
+	// Compiles the shaders and creates one pipeline per material, safe to call from any thread.
+	std::vector<std::shared_ptr<vk::Pipeline>> CreatePipelines(const vk::RenderPass& renderPass, const std::vector<Material>& materials) const;
+	// Installs pipelines from CreatePipelines(), returns the ones they replace.
+	std::vector<std::shared_ptr<vk::Pipeline>> ReplacePipelines(std::vector<std::shared_ptr<vk::Pipeline>> pipelines) { pipelines_.swap(pipelines); return pipelines; }
+
 private:
 	const vk::Device& device_;
 
-	VULKAN_HANDLE(VkPipeline, pipeline_)
+	std::vector<std::shared_ptr<vk::Pipeline>> pipelines_;
 
 	std::unique_ptr<vk::DescriptorSetManager> descriptorSetManager_;
 	std::unique_ptr<vk::PipelineLayout> pipelineLayout_;
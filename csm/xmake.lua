@@ -3,5 +3,9 @@ target("csm")
     add_files("src/*.cpp")
     add_headerfiles("src/*.h")
     add_deps("base")
+    if not has_config("runtime_shaders") then
+        add_rules("embed_spirv")
+        add_files("shaders/*.vert", "shaders/*.frag")
+    end
     set_rundir("src/.")
 target_end()
\ No newline at end of file
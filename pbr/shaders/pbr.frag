@@ -12,6 +12,7 @@ layout(binding = 0) uniform UniformBufferObject{
 	vec3 cameraPos;
 }ubo;
 
+// 0: albedo, 1: emission, 2: normal, 3: ORM (r = occlusion, g = roughness, b = metallic)
 layout(binding = 1) uniform sampler2D[] texSampler;
 layout(binding = 2) uniform samplerCube irradianceMap;
 layout(binding = 3) uniform samplerCube prefilteredMap;
@@ -31,7 +32,7 @@ vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness){
 
 vec3 getNormalFromMap()
 {
-	vec3 tangentNormal = texture(texSampler[3], fragTexCoord).rgb * 2.0 - 1.0;
+	vec3 tangentNormal = texture(texSampler[2], fragTexCoord).rgb * 2.0 - 1.0;
 
 	vec3 Q1  = dFdx(worldPos);
     vec3 Q2  = dFdy(worldPos);
@@ -69,9 +70,10 @@ void main()
 {
 	vec3 albedo = pow(texture(texSampler[0], fragTexCoord).rgb, vec3(2.2));
 	vec3 emission = texture(texSampler[1], fragTexCoord).rgb;
-	float metallic = texture(texSampler[2], fragTexCoord).r;
-	float ao = texture(texSampler[4], fragTexCoord).r;
-	float roughness = texture(texSampler[5], fragTexCoord).r;
+	vec3 orm = texture(texSampler[3], fragTexCoord).rgb;
+	float ao = orm.r;
+	float roughness = orm.g;
+	float metallic = orm.b;
 
 	vec3 V = normalize(ubo.cameraPos - worldPos);
 	vec3 N = getNormalFromMap();
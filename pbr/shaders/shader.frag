@@ -26,10 +26,11 @@ void main(){
 
 	vec3 albedo = texture(texSampler[0], fragTexCoord).rgb;
 	vec3 emission = texture(texSampler[1], fragTexCoord).rgb;
-	float metalness = texture(texSampler[2], fragTexCoord).r;
-	vec3 normal = texture(texSampler[3], fragTexCoord).rgb;
-	float ao = texture(texSampler[4], fragTexCoord).r;
-	float roughness = texture(texSampler[5], fragTexCoord).r;
+	vec3 normal = texture(texSampler[2], fragTexCoord).rgb;
+	vec3 orm = texture(texSampler[3], fragTexCoord).rgb;
+	float ao = orm.r;
+	float roughness = orm.g;
+	float metalness = orm.b;
 
 	vec3 V = normalize(ubo.cameraPos - fragPos);
 	vec3 N = normalize(normal);
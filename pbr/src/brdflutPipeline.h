@@ -6,6 +6,7 @@
 #include "Vulkan/DescriptorPool.h"
 #include "Vulkan/DescriptorSets.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/Pipeline.h"
 #include "Vulkan/PipelineLayout.h"
 #include "Vulkan/RenderPass.h"
 #include "Vulkan/ShaderModule.h"
@@ -30,6 +31,7 @@ public:
 		VkFormat format);
 	~BrdfLutPipeline();
 
+	VkPipeline Handle() const { return pipeline_->Handle(); }
 	VkDescriptorSet DescriptorSet(uint32_t index) const;
 	const vk::PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
 	const BrdfLutRenderPass& RenderPass() const { return *renderPass_; }
@@ -38,7 +40,7 @@ public:
 private:
 	const vk::Device& device_;
 
-	VULKAN_HANDLE(VkPipeline, pipeline_)
+	std::shared_ptr<vk::Pipeline> pipeline_;
 
 	std::unique_ptr<BrdfLutRenderPass> renderPass_;
 	std::unique_ptr<vk::DescriptorSetManager> descriptorSetManager_;
@@ -1,4 +1,6 @@
 #include "brdflutRenderPass.h"
+#include "Vulkan/HostAllocator.h"
+#include "Vulkan/PipelineBuilder.h"
 #include <array>
 
 BrdfLutRenderPass::BrdfLutRenderPass(
@@ -54,7 +56,9 @@ BrdfLutRenderPass::BrdfLutRenderPass(
 	renderPassInfo.dependencyCount = 2;
 	renderPassInfo.pDependencies = dependencies.data();
 
-	vk::Check(vkCreateRenderPass(Device().Handle(), &renderPassInfo, nullptr, &renderPass_),
+	hash_ = vk::PipelineBuilder::HashOf(renderPassInfo);
+
+	vk::Check(vkCreateRenderPass(Device().Handle(), &renderPassInfo, Device().HostAllocator().Callbacks(VK_OBJECT_TYPE_RENDER_PASS), &renderPass_),
 		"create render pass");
 }
 
@@ -62,7 +66,7 @@ BrdfLutRenderPass::~BrdfLutRenderPass()
 {
 	if (renderPass_ != nullptr)
 	{
-		vkDestroyRenderPass(Device().Handle(), renderPass_, nullptr);
+		vkDestroyRenderPass(Device().Handle(), renderPass_, Device().HostAllocator().Callbacks(VK_OBJECT_TYPE_RENDER_PASS));
 		renderPass_ = nullptr;
 	}
 }
\ No newline at end of file
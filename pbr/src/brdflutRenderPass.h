@@ -15,9 +15,14 @@ public:
 
 	const vk::Device& Device() const { return device_; }
 
+	// Hash of the render pass description, see PipelineBuilder::HashOf().
+	uint64_t Hash() const { return hash_; }
+
 private:
 
 	const vk::Device& device_;
 
+	uint64_t hash_{};
+
 	VULKAN_HANDLE(VkRenderPass, renderPass_)
 };
\ No newline at end of file
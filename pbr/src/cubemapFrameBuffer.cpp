@@ -1,4 +1,5 @@
 #include "cubemapFrameBuffer.h"
+#include "Vulkan/HostAllocator.h"
 
 #include <array>
 
@@ -20,7 +21,7 @@ CubemapFrameBuffer::CubemapFrameBuffer(const vk::ImageView& imageView, const Cub
 	framebufferInfo.height = dim;
 	framebufferInfo.layers = 1;
 
-	vk::Check(vkCreateFramebuffer(imageView_.Device().Handle(), &framebufferInfo, nullptr, &framebuffer_),
+	vk::Check(vkCreateFramebuffer(imageView_.Device().Handle(), &framebufferInfo, imageView_.Device().HostAllocator().Callbacks(VK_OBJECT_TYPE_FRAMEBUFFER), &framebuffer_),
 		"create framebuffer");
 }
 
@@ -36,7 +37,7 @@ CubemapFrameBuffer::~CubemapFrameBuffer()
 {
 	if (framebuffer_ != nullptr)
 	{
-		vkDestroyFramebuffer(imageView_.Device().Handle(), framebuffer_, nullptr);
+		vkDestroyFramebuffer(imageView_.Device().Handle(), framebuffer_, imageView_.Device().HostAllocator().Callbacks(VK_OBJECT_TYPE_FRAMEBUFFER));
 		framebuffer_ = nullptr;
 	}
 }
@@ -1,4 +1,6 @@
 #include "cubemapPipeline.h"
+#include "Vulkan/PipelineBuilder.h"
+#include "Vulkan/ShaderReflection.h"
 #include <iostream>
 
 
@@ -10,72 +12,18 @@ CubeMapPipeline::CubeMapPipeline(
 	const uint32_t target) 
 	: device_(device)
 {
-	const auto bindingDescription = Assets::Vertex::GetBindingDescription();
-	const auto attributeDescriptions = std::vector<VkVertexInputAttributeDescription>{ {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0} };
-
-	VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
-	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexInputInfo.vertexBindingDescriptionCount = 1;
-	vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-	vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-	VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
-	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-	inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-	VkPipelineViewportStateCreateInfo viewportState = {};
-	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-	viewportState.viewportCount = 1;
-	viewportState.scissorCount = 1;
-
-	VkPipelineRasterizationStateCreateInfo rasterizer = {};
-	rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-	rasterizer.depthClampEnable = VK_FALSE;
-	rasterizer.rasterizerDiscardEnable = VK_FALSE;
-	rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-	rasterizer.lineWidth = 1.0f;
-	rasterizer.cullMode = VK_CULL_MODE_NONE;
-	rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-	rasterizer.depthBiasEnable = VK_FALSE;
-
-	VkPipelineMultisampleStateCreateInfo multisampling = {};
-	multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-	multisampling.sampleShadingEnable = VK_FALSE;
-	multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
-	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-	depthStencil.depthTestEnable = VK_TRUE;
-	depthStencil.depthWriteEnable = VK_FALSE;
-	depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
-	depthStencil.depthBoundsTestEnable = VK_FALSE;
-	depthStencil.stencilTestEnable = VK_FALSE;
-
-	VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
-	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-	colorBlendAttachment.blendEnable = VK_FALSE;
-
-	VkPipelineColorBlendStateCreateInfo colorBlending = {};
-	colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-	colorBlending.logicOpEnable = VK_FALSE;
-	colorBlending.attachmentCount = 1;
-	colorBlending.pAttachments = &colorBlendAttachment;
-
-	std::vector<VkDynamicState> dynamicStateEnables = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
-	VkPipelineDynamicStateCreateInfo dynamicStateCI{};
-	dynamicStateCI.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-	dynamicStateCI.pDynamicStates = dynamicStateEnables.data();
-	dynamicStateCI.dynamicStateCount = static_cast<uint32_t>(dynamicStateEnables.size());
+	const auto vertCode = vk::ShaderModule::ReadFile("../shaders/filtercube.vert");
+	const auto fragCode = vk::ShaderModule::ReadFile(target == 0 ? "../shaders/irradiancecube.frag" : "../shaders/prefiltercube.frag");
 
-	// Create descriptor pool/sets.
-	std::vector<vk::DescriptorBinding> descriptorBindings =
-	{
-		{0, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT}
-	};
+	// Derive the descriptor bindings and push constants from the shaders, the texture array is sized by the scene.
+	vk::ShaderReflection reflection;
+	reflection.AddStage(VK_SHADER_STAGE_VERTEX_BIT, vertCode);
+	reflection.AddStage(VK_SHADER_STAGE_FRAGMENT_BIT, fragCode);
+	reflection.SetDescriptorCount(0, static_cast<uint32_t>(scene.TextureSamplers().size()));
+	reflection.CheckPushConstantSize(target == 0 ? sizeof(PushBlockIrradiance) : sizeof(PushBlockPrefilterEnv));
 
-	descriptorSetManager_.reset(new vk::DescriptorSetManager(device, descriptorBindings, 2));
+	// Create descriptor pool/sets.
+	descriptorSetManager_.reset(new vk::DescriptorSetManager(device, reflection, 2));
 
 	auto& descriptorSets = descriptorSetManager_->DescriptorSets();
 
@@ -98,72 +46,27 @@ CubeMapPipeline::CubeMapPipeline(
 
 	descriptorSets.UpdateDescriptors(0, descriptorWrites);
 
-	VkPushConstantRange pushConstantRange{};
-	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-
-	switch (target) {
-	case 0:
-		pushConstantRange.size = sizeof(PushBlockIrradiance);
-		break;
-	case 1:
-		pushConstantRange.size = sizeof(PushBlockPrefilterEnv);
-		break;
-	};
-
 	// Create pipeline layout and render pass.
-	pipelineLayout_.reset(new class vk::PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout(), pushConstantRange));
+	pipelineLayout_.reset(new class vk::PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout(), reflection));
 	renderPass_.reset(new CubeMapRenderPass(Device(), format));
 
-	// Load shaders.
-	auto vert_code = vk::ShaderModule::ReadFile("../shaders/filtercube.vert", shaderc_glsl_vertex_shader);
-	std::vector<uint32_t> frag_code;
-	switch (target)
-	{
-	case 0:
-		frag_code = vk::ShaderModule::ReadFile("../shaders/irradiancecube.frag", shaderc_glsl_fragment_shader);
-		break;
-	case 1:
-		frag_code = vk::ShaderModule::ReadFile("../shaders/prefiltercube.frag", shaderc_glsl_fragment_shader);
-		break;
-	}
+	// Create graphic pipeline, identical requests share one pipeline.
+	vk::PipelineState state;
+	state.VertexBindings = { Assets::Vertex::GetBindingDescription() };
+	state.VertexAttributes = { {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0} };
+	state.DepthWriteEnable = false;
+	state.DepthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
 
-	const vk::ShaderModule vertShader(device, vert_code);
-	const vk::ShaderModule fragShader(device, frag_code);
+	vk::PipelineBuilder builder(device, state);
+	builder.AddStage(VK_SHADER_STAGE_VERTEX_BIT, vertCode);
+	builder.AddStage(VK_SHADER_STAGE_FRAGMENT_BIT, fragCode);
 
-	VkPipelineShaderStageCreateInfo shaderStages[] =
-	{
-		vertShader.CreateShaderStage(VK_SHADER_STAGE_VERTEX_BIT),
-		fragShader.CreateShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT)
-	};
-
-	// Create graphic pipeline
-	VkGraphicsPipelineCreateInfo pipelineInfo = {};
-	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	pipelineInfo.stageCount = 2;
-	pipelineInfo.pStages = shaderStages;
-	pipelineInfo.pVertexInputState = &vertexInputInfo;
-	pipelineInfo.pInputAssemblyState = &inputAssembly;
-	pipelineInfo.pViewportState = &viewportState;
-	pipelineInfo.pRasterizationState = &rasterizer;
-	pipelineInfo.pMultisampleState = &multisampling;
-	pipelineInfo.pDepthStencilState = &depthStencil;
-	pipelineInfo.pColorBlendState = &colorBlending;
-	pipelineInfo.pDynamicState = &dynamicStateCI;
-	pipelineInfo.layout = pipelineLayout_->Handle();
-	pipelineInfo.renderPass = renderPass_->Handle();
-	pipelineInfo.subpass = 0;
-
-	vk::Check(vkCreateGraphicsPipelines(device.Handle(), nullptr, 1, &pipelineInfo, nullptr, &pipeline_),
-		"create graphics pipeline");
+	pipeline_ = builder.Build(*pipelineLayout_, *renderPass_, "cubemap");
 }
 
 CubeMapPipeline::~CubeMapPipeline()
 {
-	if (pipeline_ != nullptr) {
-		vkDestroyPipeline(Device().Handle(), pipeline_, nullptr);
-		pipeline_ = nullptr;
-	}
-
+	pipeline_.reset();
 	pipelineLayout_.reset();
 	descriptorSetManager_.reset();
 }
@@ -6,6 +6,7 @@
 #include "Vulkan/DescriptorPool.h"
 #include "Vulkan/DescriptorSets.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/Pipeline.h"
 #include "Vulkan/PipelineLayout.h"
 #include "Vulkan/RenderPass.h"
 #include "Vulkan/ShaderModule.h"
@@ -44,6 +45,7 @@ public:
 		const uint32_t target);
 	~CubeMapPipeline();
 
+	VkPipeline Handle() const { return pipeline_->Handle(); }
 	VkDescriptorSet DescriptorSet(uint32_t index) const;
 	const vk::PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
 	const CubeMapRenderPass& RenderPass() const { return *renderPass_; }
@@ -51,7 +53,7 @@ public:
 
 private:
 
-	VULKAN_HANDLE(VkPipeline, pipeline_)
+	std::shared_ptr<vk::Pipeline> pipeline_;
 
 	const vk::Device& device_;
 
@@ -1,4 +1,6 @@
 #include "cubemapRenderPass.h"
+#include "Vulkan/HostAllocator.h"
+#include "Vulkan/PipelineBuilder.h"
 #include <array>
 
 CubeMapRenderPass::CubeMapRenderPass(const vk::Device& device, VkFormat format) : device_(device)
@@ -52,7 +54,9 @@ CubeMapRenderPass::CubeMapRenderPass(const vk::Device& device, VkFormat format)
 	renderPassInfo.dependencyCount = 2;
 	renderPassInfo.pDependencies = dependencies.data();
 
-	vk::Check(vkCreateRenderPass(device.Handle(), &renderPassInfo, nullptr, &renderPass_),
+	hash_ = vk::PipelineBuilder::HashOf(renderPassInfo);
+
+	vk::Check(vkCreateRenderPass(device.Handle(), &renderPassInfo, device.HostAllocator().Callbacks(VK_OBJECT_TYPE_RENDER_PASS), &renderPass_),
 		"create render pass");
 }
 
@@ -60,7 +64,7 @@ CubeMapRenderPass::~CubeMapRenderPass()
 {
 	if (renderPass_ != nullptr)
 	{
-		vkDestroyRenderPass(Device().Handle(), renderPass_, nullptr);
+		vkDestroyRenderPass(Device().Handle(), renderPass_, Device().HostAllocator().Callbacks(VK_OBJECT_TYPE_RENDER_PASS));
 		renderPass_ = nullptr;
 	}
 }
\ No newline at end of file
@@ -1,206 +1,107 @@
 #include "pbrPipeline.h"
+#include "Vulkan/DeletionQueue.h"
+#include "Vulkan/PipelineBuilder.h"
 #include <iostream>
 
+namespace
+{
+	const char* const VertexShader = "../shaders/pbr.vert";
+	const char* const FragmentShader = "../shaders/pbr.frag";
+}
+
 PbrPipeline::PbrPipeline(
 	const vk::Device& device,
-	const std::vector<Assets::UniformBuffer>& uniformBuffers,
-	const Assets::UniformBuffer& shaderValueUBO,
+	const VkDescriptorBufferInfo& uniformBufferInfo,
+	const VkDescriptorBufferInfo& shaderValuesInfo,
 	const Assets::Scene& scene,
 	const vk::RenderPass& renderPass,
 	const Assets::TextureCubeImage& irradianceMap,
 	const Assets::TextureCubeImage& prefilterMap,
 	const Assets::TextureImage& brdfLut) :
-	device_(device)
+	device_(device),
+	uniformBufferInfo_(uniformBufferInfo),
+	shaderValuesInfo_(shaderValuesInfo),
+	irradianceMapInfo_{ irradianceMap.Sampler().Handle(), irradianceMap.ImageView().Handle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+	prefilteredMapInfo_{ prefilterMap.Sampler().Handle(), prefilterMap.ImageView().Handle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+	brdflutMapInfo_{ brdfLut.Sampler().Handle(), brdfLut.ImageView().Handle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }
 {
-	const auto bindingDescription = Assets::Vertex::GetBindingDescription();
-	const auto attributeDescriptions = Assets::Vertex::GetAttributeDescriptions();
-
-	VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
-	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexInputInfo.vertexBindingDescriptionCount = 1;
-	vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-	vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-	VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
-	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-	inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-	VkPipelineViewportStateCreateInfo viewportState = {};
-	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-	viewportState.viewportCount = 1;
-	viewportState.scissorCount = 1;
-
-	std::vector<VkDynamicState> dynamicStates = {
-			VK_DYNAMIC_STATE_VIEWPORT,
-			VK_DYNAMIC_STATE_SCISSOR
-	};
-
-	VkPipelineDynamicStateCreateInfo dynamicState{};
-	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-	dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-	dynamicState.pDynamicStates = dynamicStates.data();
-
-	VkPipelineRasterizationStateCreateInfo rasterizer = {};
-	rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-	rasterizer.depthClampEnable = VK_FALSE;
-	rasterizer.rasterizerDiscardEnable = VK_FALSE;
-	rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-	rasterizer.lineWidth = 1.0f;
-	rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-	rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-	rasterizer.depthBiasEnable = VK_FALSE;
-	rasterizer.depthBiasConstantFactor = 0.0f; // Optional
-	rasterizer.depthBiasClamp = 0.0f; // Optional
-	rasterizer.depthBiasSlopeFactor = 0.0f; // Optional
-
-	VkPipelineMultisampleStateCreateInfo multisampling = {};
-	multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-	multisampling.sampleShadingEnable = VK_FALSE;
-	multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-	multisampling.minSampleShading = 1.0f; // Optional
-	multisampling.pSampleMask = nullptr; // Optional
-	multisampling.alphaToCoverageEnable = VK_FALSE; // Optional
-	multisampling.alphaToOneEnable = VK_FALSE; // Optional
-
-	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
-	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-	depthStencil.depthTestEnable = VK_TRUE;
-	depthStencil.depthWriteEnable = VK_TRUE;
-	depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-	depthStencil.depthBoundsTestEnable = VK_FALSE;
-	depthStencil.minDepthBounds = 0.0f; // Optional
-	depthStencil.maxDepthBounds = 1.0f; // Optional
-	depthStencil.stencilTestEnable = VK_FALSE;
-	depthStencil.front = {}; // Optional
-	depthStencil.back = {}; // Optional
-
-	VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
-	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-	colorBlendAttachment.blendEnable = VK_FALSE;
-	colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE; // Optional
-	colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO; // Optional
-	colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD; // Optional
-	colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE; // Optional
-	colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO; // Optional
-	colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD; // Optional
-
-	VkPipelineColorBlendStateCreateInfo colorBlending = {};
-	colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-	colorBlending.logicOpEnable = VK_FALSE;
-	colorBlending.logicOp = VK_LOGIC_OP_COPY; // Optional
-	colorBlending.attachmentCount = 1;
-	colorBlending.pAttachments = &colorBlendAttachment;
-	colorBlending.blendConstants[0] = 0.0f; // Optional
-	colorBlending.blendConstants[1] = 0.0f; // Optional
-	colorBlending.blendConstants[2] = 0.0f; // Optional
-	colorBlending.blendConstants[3] = 0.0f; // Optional
-
-	// Create descriptor pool/sets.
-	std::vector<vk::DescriptorBinding> descriptorBindings =
-	{
-		{0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT},									// uniform buffer : mvp + cameraPos
-		{1, static_cast<uint32_t>(scene.TextureSamplers().size()), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT},	// model textures
-		{2, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT},	// irradianceMap
-		{3, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT},	// prefilteredMap
-		{4, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT},	// brdfLutMap
-		{5, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT}
-	};
-
-	descriptorSetManager_.reset(new vk::DescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
-
-	auto& descriptorSets = descriptorSetManager_->DescriptorSets();
+	// Derive the descriptor bindings and push constants from the shaders, the texture array is sized by the scene.
+	reflection_.AddStage(VK_SHADER_STAGE_VERTEX_BIT, vk::ShaderModule::ReadFile(VertexShader));
+	reflection_.AddStage(VK_SHADER_STAGE_FRAGMENT_BIT, vk::ShaderModule::ReadFile(FragmentShader));
+	reflection_.SetDescriptorCount(1, static_cast<uint32_t>(scene.TextureSamplers().size()));
+	reflection_.SetDynamic(0);
+	reflection_.SetDynamic(5);
 
-	for (uint32_t i = 0; i != uniformBuffers.size(); ++i)
-	{
-		// Uniform buffer
-		VkDescriptorBufferInfo uniformBufferInfo = {};
-		uniformBufferInfo.buffer = uniformBuffers[i].Buffer().Handle();
-		uniformBufferInfo.range = VK_WHOLE_SIZE;
-
-		VkDescriptorBufferInfo valueUniformBufferInfo{};
-		valueUniformBufferInfo.buffer = shaderValueUBO.Buffer().Handle();
-		valueUniformBufferInfo.range = VK_WHOLE_SIZE;
-
-		// Image and texture samplers
-		std::vector<VkDescriptorImageInfo> imageInfos(scene.TextureSamplers().size());
-
-		for (size_t t = 0; t != imageInfos.size(); ++t)
-		{
-			auto& imageInfo = imageInfos[t];
-			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageInfo.imageView = scene.TextureImageViews()[t];
-			imageInfo.sampler = scene.TextureSamplers()[t];
-		}
-
-		VkDescriptorImageInfo irradianceMapInfo{ irradianceMap.Sampler().Handle(), irradianceMap.ImageView().Handle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-		VkDescriptorImageInfo prefilteredMapInfo{ prefilterMap.Sampler().Handle(), prefilterMap.ImageView().Handle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-		VkDescriptorImageInfo brdflutMapInfo{ brdfLut.Sampler().Handle(), brdfLut.ImageView().Handle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-
-		const std::vector<VkWriteDescriptorSet> descriptorWrites =
-		{
-			descriptorSets.Bind(i, 0, uniformBufferInfo),
-			descriptorSets.Bind(i, 1, *imageInfos.data(), static_cast<uint32_t>(imageInfos.size())),
-			descriptorSets.Bind(i, 2, irradianceMapInfo),
-			descriptorSets.Bind(i, 3, prefilteredMapInfo),
-			descriptorSets.Bind(i, 4, brdflutMapInfo),
-			descriptorSets.Bind(i, 5, valueUniformBufferInfo)
-		};
-
-		descriptorSets.UpdateDescriptors(i, descriptorWrites);
-	}
+	descriptorSetManager_ = CreateDescriptorSets(scene);
 
 	// Create pipeline layout and render pass.
-	pipelineLayout_.reset(new vk::PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout()));
+	pipelineLayout_.reset(new vk::PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout(), reflection_));
 
-	// Load shaders.
-	auto vert_code = vk::ShaderModule::ReadFile("../shaders/pbr.vert", shaderc_glsl_vertex_shader);
-	auto frag_code = vk::ShaderModule::ReadFile("../shaders/pbr.frag", shaderc_glsl_fragment_shader);
+	pipeline_ = CreatePipeline(renderPass);
+}
 
-	const vk::ShaderModule vertShader(device, vert_code);
-	const vk::ShaderModule fragShader(device, frag_code);
+std::shared_ptr<vk::Pipeline> PbrPipeline::CreatePipeline(const vk::RenderPass& renderPass) const
+{
+	// Create graphic pipeline, identical requests share one pipeline.
+	vk::PipelineState state;
+	state.VertexBindings = { Assets::Vertex::GetBindingDescription() };
+	state.VertexAttributes = Assets::Vertex::GetAttributeDescriptions();
+	state.CullMode = VK_CULL_MODE_BACK_BIT;
 
-	VkPipelineShaderStageCreateInfo shaderStages[] =
-	{
-		vertShader.CreateShaderStage(VK_SHADER_STAGE_VERTEX_BIT),
-		fragShader.CreateShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT)
-	};
+	vk::PipelineBuilder builder(device_, state);
+	builder.AddStage(VK_SHADER_STAGE_VERTEX_BIT, vk::ShaderModule::ReadFile(VertexShader));
+	builder.AddStage(VK_SHADER_STAGE_FRAGMENT_BIT, vk::ShaderModule::ReadFile(FragmentShader));
 
-	// Create graphic pipeline
-	VkGraphicsPipelineCreateInfo pipelineInfo = {};
-	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	pipelineInfo.stageCount = 2;
-	pipelineInfo.pStages = shaderStages;
-	pipelineInfo.pVertexInputState = &vertexInputInfo;
-	pipelineInfo.pInputAssemblyState = &inputAssembly;
-	pipelineInfo.pViewportState = &viewportState;
-	pipelineInfo.pRasterizationState = &rasterizer;
-	pipelineInfo.pMultisampleState = &multisampling;
-	pipelineInfo.pDepthStencilState = &depthStencil;
-	pipelineInfo.pColorBlendState = &colorBlending;
-	pipelineInfo.pDynamicState = &dynamicState;
-	pipelineInfo.layout = pipelineLayout_->Handle();
-	pipelineInfo.renderPass = renderPass.Handle();
-	pipelineInfo.subpass = 0;
-
-	vk::Check(vkCreateGraphicsPipelines(device.Handle(), nullptr, 1, &pipelineInfo, nullptr, &pipeline_),
-		"create graphics pipeline");
+	return builder.Build(*pipelineLayout_, renderPass, "pbr");
 }
 
 PbrPipeline::~PbrPipeline()
 {
-	if (pipeline_ != nullptr) {
-		vkDestroyPipeline(Device().Handle(), pipeline_, nullptr);
-		pipeline_ = nullptr;
-	}
-
-
+	pipeline_.reset();
 	pipelineLayout_.reset();
 	descriptorSetManager_.reset();
 }
 
-VkDescriptorSet PbrPipeline::DescriptorSet(uint32_t index) const
+VkDescriptorSet PbrPipeline::DescriptorSet() const
 {
-	return descriptorSetManager_->DescriptorSets().Handle(index);
-}
\ No newline at end of file
+	return descriptorSetManager_->DescriptorSets().Handle(0);
+}
+
+void PbrPipeline::UpdateSceneTextures(const Assets::Scene& scene)
+{
+	device_.DeletionQueue().Retire(std::move(descriptorSetManager_));
+	descriptorSetManager_ = CreateDescriptorSets(scene);
+}
+
+std::unique_ptr<vk::DescriptorSetManager> PbrPipeline::CreateDescriptorSets(const Assets::Scene& scene) const
+{
+	// Create the descriptor set, both uniform buffers live in the uniform ring and are bound with dynamic offsets.
+	std::unique_ptr<vk::DescriptorSetManager> descriptorSetManager(new vk::DescriptorSetManager(device_, reflection_, 1));
+
+	auto& descriptorSets = descriptorSetManager->DescriptorSets();
+
+	// Image and texture samplers
+	std::vector<VkDescriptorImageInfo> imageInfos(scene.TextureSamplers().size());
+
+	for (size_t t = 0; t != imageInfos.size(); ++t)
+	{
+		auto& imageInfo = imageInfos[t];
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageInfo.imageView = scene.TextureImageViews()[t];
+		imageInfo.sampler = scene.TextureSamplers()[t];
+	}
+
+	const std::vector<VkWriteDescriptorSet> descriptorWrites =
+	{
+		descriptorSets.Bind(0, 0, uniformBufferInfo_),
+		descriptorSets.Bind(0, 1, *imageInfos.data(), static_cast<uint32_t>(imageInfos.size())),
+		descriptorSets.Bind(0, 2, irradianceMapInfo_),
+		descriptorSets.Bind(0, 3, prefilteredMapInfo_),
+		descriptorSets.Bind(0, 4, brdflutMapInfo_),
+		descriptorSets.Bind(0, 5, shaderValuesInfo_)
+	};
+
+	descriptorSets.UpdateDescriptors(0, descriptorWrites);
+
+	return descriptorSetManager;
+}
@@ -6,15 +6,16 @@
 #include "Vulkan/DescriptorPool.h"
 #include "Vulkan/DescriptorSets.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/Pipeline.h"
 #include "Vulkan/PipelineLayout.h"
 #include "Vulkan/RenderPass.h"
 #include "Vulkan/ShaderModule.h"
+#include "Vulkan/ShaderReflection.h"
 #include "Vulkan/SwapChain.h"
 #include "Vulkan/Sampler.h"
 #include "Vulkan/ImageView.h"
 #include "Assets/Scene.h"
 #include "Assets/Vertex.h"
-#include "Assets/UniformBuffer.h"
 #include "Assets/TextureImage.h"
 #include <memory>
 #include <vector>
@@ -27,8 +28,8 @@ public:
 
 	PbrPipeline(
 		const vk::Device& device,
-		const std::vector<Assets::UniformBuffer>& uniformBuffers,
-		const Assets::UniformBuffer& shaderValueUBO,
+		const VkDescriptorBufferInfo& uniformBufferInfo,
+		const VkDescriptorBufferInfo& shaderValuesInfo,
 		const Assets::Scene& scene,
 		const vk::RenderPass& renderPass,
 		const Assets::TextureCubeImage& irradianceMap,
@@ -36,14 +37,32 @@ public:
 		const Assets::TextureImage& brdfLut);
 	~PbrPipeline();
 
-	VkDescriptorSet DescriptorSet(uint32_t index) const;
+	VkPipeline Handle() const { return pipeline_->Handle(); }
+	VkDescriptorSet DescriptorSet() const;
+	// Points the texture array at the current scene image views. Frames in flight may still read the current
+	// descriptor set, so a new one is written and the old one retired through the device DeletionQueue.
+	void UpdateSceneTextures(const Assets::Scene& scene);
 	const vk::PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
 	const vk::Device& Device() const { return device_; }
 
+	// Compiles the shaders and creates the pipeline, safe to call from any thread.
+	std::shared_ptr<vk::Pipeline> CreatePipeline(const vk::RenderPass& renderPass) const;
+	// Installs a pipeline from CreatePipeline(), returns the one it replaces.
+	std::shared_ptr<vk::Pipeline> ReplacePipeline(std::shared_ptr<vk::Pipeline> pipeline) { pipeline_.swap(pipeline); return pipeline; }
+
 private:
+	std::unique_ptr<vk::DescriptorSetManager> CreateDescriptorSets(const Assets::Scene& scene) const;
+
 	const vk::Device& device_;
 
-	VULKAN_HANDLE(VkPipeline, pipeline_)
+	vk::ShaderReflection reflection_;
+	const VkDescriptorBufferInfo uniformBufferInfo_;
+	const VkDescriptorBufferInfo shaderValuesInfo_;
+	const VkDescriptorImageInfo irradianceMapInfo_;
+	const VkDescriptorImageInfo prefilteredMapInfo_;
+	const VkDescriptorImageInfo brdflutMapInfo_;
+
+	std::shared_ptr<vk::Pipeline> pipeline_;
 
 	std::unique_ptr<vk::DescriptorSetManager> descriptorSetManager_;
 	std::unique_ptr<vk::PipelineLayout> pipelineLayout_;
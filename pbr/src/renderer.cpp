@@ -1,23 +1,44 @@
 #include "renderer.h"
 #include "Assets/Model.h"
 #include "Assets/Scene.h"
+#include "Assets/StreamingTextureImage.h"
 #include "Assets/Texture.h"
 #include "Assets/UserInterface.h"
 #include "Utilities/Glm.h"
+#include "Utilities/ThreadPool.h"
 #include "Vulkan/Buffer.h"
 #include "Vulkan/BufferUtil.h"
+#include "Vulkan/DeletionQueue.h"
+#include "Vulkan/HostAllocator.h"
 #include "Vulkan/Image.h"
 #include "Vulkan/ImageMemoryBarrier.h"
 #include "Vulkan/ImageView.h"
+#include "Vulkan/MemoryAliasPool.h"
 #include "Vulkan/PipelineLayout.h"
+#include "Vulkan/ShaderReloader.h"
 #include "Vulkan/SingleTimeCommands.h"
 #include "Vulkan/SwapChain.h"
 #include "Vulkan/GraphicsPipeline.h"
 #include "Vulkan/Window.h"
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <numeric>
 
+namespace
+{
+	const uint32_t IrradianceDim = 64;
+	const VkFormat IrradianceFormat = VK_FORMAT_R32G32B32A32_SFLOAT;
+	const uint32_t PrefilteredDim = 512;
+	const VkFormat PrefilteredFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+	const int32_t BrdfLutDim = 512;
+	const VkFormat BrdfLutFormat = VK_FORMAT_R16G16_SFLOAT;
+
+	int32_t MipLevels(const uint32_t dim)
+	{
+		return static_cast<int32_t>(floor(log2(dim))) + 1;
+	}
+}
 
 Renderer::Renderer(const vk::WindowConfig& windowConfig, const VkPresentModeKHR presentMode, const bool enableValidationLayers) :
 	vk::Application(windowConfig, presentMode, enableValidationLayers)
@@ -27,15 +48,16 @@ Renderer::Renderer(const vk::WindowConfig& windowConfig, const VkPresentModeKHR
 Renderer::~Renderer()
 {
 	brdflutPipeline_.reset();
-	cubemapPipeline_.reset();
+	prefilterPipeline_.reset();
+	irradiancePipeline_.reset();
 	skyboxPipeline_.reset();
 	pbrPipeline_.reset();
 	DeleteSwapChain();
 	ui_.reset();
 	scene_.reset();
+	textureStreamer_.reset();
 	skybox_.reset();
 	camera_.reset();
-	shaderValuesUBO_.reset();
 }
 
 void Renderer::OnDeviceSet()
@@ -90,26 +112,30 @@ Assets::UniformBufferObject Renderer::GetUniformBufferObject(const VkExtent2D ex
 
 void Renderer::LoadScene()
 {
-	Assets::Model helmet = Assets::Model::LoadModel("../models/helmet/helmet.obj");
-	std::vector<Assets::Model> models{ helmet };
+	// Moved into the scene, which releases them once uploaded.
+	std::vector<Assets::Model> models;
+	models.push_back(Assets::Model::LoadModel("../models/helmet/helmet.obj"));
 	std::vector<Assets::Texture> textures;
 	textures.push_back(Assets::Texture::LoadTexture("../models/helmet/helmet_diffuse.tga", vk::SamplerConfig()));
 	textures.push_back(Assets::Texture::LoadTexture("../models/helmet/helmet_emission.tga", vk::SamplerConfig()));
-	textures.push_back(Assets::Texture::LoadTexture("../models/helmet/helmet_metalness.tga", vk::SamplerConfig()));
 	textures.push_back(Assets::Texture::LoadTexture("../models/helmet/helmet_normal.tga", vk::SamplerConfig()));
-	textures.push_back(Assets::Texture::LoadTexture("../models/helmet/helmet_occlusion.tga", vk::SamplerConfig()));
-	textures.push_back(Assets::Texture::LoadTexture("../models/helmet/helmet_roughness.tga", vk::SamplerConfig()));
+	textures.push_back(Assets::Texture::PackOcclusionRoughnessMetalness(
+		Assets::Texture::LoadTexture("../models/helmet/helmet_occlusion.tga", vk::SamplerConfig()),
+		Assets::Texture::LoadTexture("../models/helmet/helmet_roughness.tga", vk::SamplerConfig()),
+		Assets::Texture::LoadTexture("../models/helmet/helmet_metalness.tga", vk::SamplerConfig())));
 	
 	/*std::vector<Assets::GltfModel> gltfModels;
 	gltfModels.emplace_back(Device());
 	gltfModels.back().LoadGLTFModel("./models/DamagedHelmet.gltf", 1.0f);
 
 	scene_.reset(new Assets::Scene(CommandPool(), std::move(gltfModels)));*/
-	scene_.reset(new Assets::Scene(CommandPool(), std::move(models), std::move(textures)));
+	// Stream the helmet textures: only the mip tails are uploaded before the first frame.
+	textureStreamer_.reset(new Assets::TextureStreamer(static_cast<VkDeviceSize>(textureBudgetMb_ * 1024 * 1024)));
+	scene_.reset(new Assets::Scene(CommandPool(), std::move(models), std::move(textures), textureStreamer_.get()));
 
 	textures.clear();
-	Assets::Model box = Assets::Model::LoadModel("../models/box.obj");
-	std::vector<Assets::Model> skybox { box };
+	std::vector<Assets::Model> skybox;
+	skybox.push_back(Assets::Model::LoadModel("../models/box.obj"));
 	textures.push_back(Assets::Texture::LoadTexture("../textures/blue_photo_studio_4k.hdr", vk::SamplerConfig()));
 
 	skybox_.reset(new Assets::Scene(CommandPool(), std::move(skybox), std::move(textures)));
@@ -119,6 +145,7 @@ void Renderer::Render(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 {
 	UpdateUi();
 	UpdateUBO();
+	UpdateTextureStreaming();
 
 	std::array<VkClearValue, 2> clearValues = {};
 	clearValues[0].color = { {0.0f, 0.0f, 0.0f, 1.0f} };
@@ -137,7 +164,8 @@ void Renderer::Render(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 	{
 		const auto& scene = GetScene();
 
-		VkDescriptorSet descriptorSets[] = { pbrPipeline_->DescriptorSet(imageIndex) };
+		VkDescriptorSet descriptorSets[] = { pbrPipeline_->DescriptorSet() };
+		uint32_t dynamicOffsets[] = { UniformBufferOffset(), shaderValuesOffset_ };
 		VkBuffer vertexBuffers[] = { scene.VertexBuffer().Handle() };
 		const VkBuffer indexBuffer = scene.IndexBuffer().Handle();
 		VkDeviceSize offsets[] = { 0 };
@@ -157,48 +185,31 @@ void Renderer::Render(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
 		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pbrPipeline_->Handle());
-		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pbrPipeline_->PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pbrPipeline_->PipelineLayout().Handle(), 0, 1, descriptorSets, 2, dynamicOffsets);
 		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
 		vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
 
-		uint32_t vertexOffset = 0;
-		uint32_t indexOffset = 0;
-
-		for (const auto& model : scene.Models())
+		for (const auto& range : scene.DrawRanges())
 		{
-			const auto vertexCount = static_cast<uint32_t>(model.NumberOfVertices());
-			const auto indexCount = static_cast<uint32_t>(model.NumberOfIndices());
-
-			vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexOffset, vertexOffset, 0);
-
-			vertexOffset += vertexCount;
-			indexOffset += indexCount;
+			vkCmdDrawIndexed(commandBuffer, range.IndexCount, 1, range.FirstIndex, range.VertexOffset, 0);
 		}
 
 		{
 			const auto& scene = GetSkybox();
 
-			VkDescriptorSet descriptorSets[] = { skyboxPipeline_->DescriptorSet(imageIndex) };
+			VkDescriptorSet descriptorSets[] = { skyboxPipeline_->DescriptorSet() };
+			uint32_t dynamicOffsets[] = { UniformBufferOffset() };
 			VkBuffer vertexBuffers[] = { scene.VertexBuffer().Handle() };
 			const VkBuffer indexBuffer = scene.IndexBuffer().Handle();
 
 			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, skyboxPipeline_->Handle());
-			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, skyboxPipeline_->PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, skyboxPipeline_->PipelineLayout().Handle(), 0, 1, descriptorSets, 1, dynamicOffsets);
 			vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
 			vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
 
-			uint32_t vertexOffset = 0;
-			uint32_t indexOffset = 0;
-
-			for (const auto& model : scene.Models())
+			for (const auto& range : scene.DrawRanges())
 			{
-				const auto vertexCount = static_cast<uint32_t>(model.NumberOfVertices());
-				const auto indexCount = static_cast<uint32_t>(model.NumberOfIndices());
-
-				vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexOffset, vertexOffset, 0);
-
-				vertexOffset += vertexCount;
-				indexOffset += indexCount;
+				vkCmdDrawIndexed(commandBuffer, range.IndexCount, 1, range.FirstIndex, range.VertexOffset, 0);
 			}
 
 			UI().Draw(commandBuffer);
@@ -219,17 +230,54 @@ void Renderer::Prepare() {
 	float zNear = 0.1f;
 	float zFar = 256.0f;
 	camera_.reset(new Assets::Camera(viewPos, target, worldUp, fov, aspect, zNear, zFar));
-	shaderValuesUBO_.reset(new Assets::UniformBuffer(Device()));
+
+	// The offline render targets are allocated first, so the pipelines sampling them can be built before they are rendered.
+	irradianceMap_.reset(new Assets::TextureCubeImage(CommandPool(), IrradianceDim, IrradianceFormat, MipLevels(IrradianceDim)));
+	prefilterMap_.reset(new Assets::TextureCubeImage(CommandPool(), PrefilteredDim, PrefilteredFormat, MipLevels(PrefilteredDim)));
+	brdfLut_.reset(new Assets::TextureImage(Device(), BrdfLutDim, BrdfLutFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT));
+	shaderValuesParams_.prefilteredCubeMipLevels = MipLevels(PrefilteredDim);
+
+	// Every pipeline compiles its shaders and driver state as its own task. The UI uploads through the
+	// command pool, so it is built on this thread meanwhile; all results are joined before first use.
+	{
+		Utilities::ThreadPool threadPool;
+
+		auto irradiancePipeline = threadPool.Submit([this]() {
+			return std::unique_ptr<CubeMapPipeline>(new CubeMapPipeline(Device(), GetSkybox(), IrradianceFormat, 0)); });
+		auto prefilterPipeline = threadPool.Submit([this]() {
+			return std::unique_ptr<CubeMapPipeline>(new CubeMapPipeline(Device(), GetSkybox(), PrefilteredFormat, 1)); });
+		auto brdflutPipeline = threadPool.Submit([this]() {
+			return std::unique_ptr<BrdfLutPipeline>(new BrdfLutPipeline(Device(), BrdfLutFormat)); });
+		auto pbrPipeline = threadPool.Submit([this]() {
+			return std::unique_ptr<PbrPipeline>(new PbrPipeline(Device(), UniformBufferInfo(), GetShaderValuesInfo(), GetScene(), GraphicsPipeline().RenderPass(),
+				GetIrradianceMap(), GetPrefilteredMap(), GetBrdfLutMap())); });
+		auto skyboxPipeline = threadPool.Submit([this]() {
+			return std::unique_ptr<SkyBoxPipeline>(new SkyBoxPipeline(Device(), UniformBufferInfo(), GetSkybox(), GraphicsPipeline().RenderPass(), GetPrefilteredMap())); });
+
+		ui_.reset(new Assets::UserInterface(CommandPool(), GraphicsPipeline().RenderPass()));
+
+		irradiancePipeline_ = irradiancePipeline.get();
+		prefilterPipeline_ = prefilterPipeline.get();
+		brdflutPipeline_ = brdflutPipeline.get();
+		pbrPipeline_ = pbrPipeline.get();
+		skyboxPipeline_ = skyboxPipeline.get();
+	}
+
+	// Edited shaders are rebuilt in the background and swapped in between frames. The bake pipelines only
+	// run once, so they are not watched.
+	using Pipeline = std::shared_ptr<vk::Pipeline>;
+
+	ShaderReloader().Watch<Pipeline>({ "pbr.vert", "pbr.frag" },
+		[this]() { return pbrPipeline_->CreatePipeline(GraphicsPipeline().RenderPass()); },
+		[this](Pipeline pipeline) { return pbrPipeline_->ReplacePipeline(std::move(pipeline)); });
+	ShaderReloader().Watch<Pipeline>({ "skybox.vert", "skybox.frag" },
+		[this]() { return skyboxPipeline_->CreatePipeline(GraphicsPipeline().RenderPass()); },
+		[this](Pipeline pipeline) { return skyboxPipeline_->ReplacePipeline(std::move(pipeline)); });
 
 	// cubemap
 	GenerateCubemaps();
 	GenratateBRDFLUT();
 
-	pbrPipeline_.reset(new PbrPipeline(Device(), UniformBuffers(), GetShaderValuesUBO(), GetScene(), GraphicsPipeline().RenderPass(),
-		GetIrradianceMap(), GetPrefilteredMap(), GetBrdfLutMap()));
-	skyboxPipeline_.reset(new SkyBoxPipeline(Device(), UniformBuffers(), GetSkybox(), GraphicsPipeline().RenderPass(), GetPrefilteredMap()));
-
-	ui_.reset(new Assets::UserInterface(CommandPool(), GraphicsPipeline().RenderPass()));
 	UpdateUi();
 
 }
@@ -237,41 +285,32 @@ void Renderer::Prepare() {
 void Renderer::GenerateCubemaps() {
 	enum Target { IRRADIANCE = 0, PREFILTEREDENV = 1 };
 	for (uint32_t target = 0; target < PREFILTEREDENV + 1; target++) {
-		uint32_t dim;
-		VkFormat format;
-
 		auto tStart = std::chrono::high_resolution_clock::now();
 
-		switch (target) {
-		case IRRADIANCE:
-			format = VK_FORMAT_R32G32B32A32_SFLOAT;
-			dim = 64;
-			break;
-		case PREFILTEREDENV:
-			format = VK_FORMAT_R16G16B16A16_SFLOAT;
-			dim = 512;
-			break;
-		}
+		// The target maps and their pipelines were created by Prepare().
+		const uint32_t dim = target == IRRADIANCE ? IrradianceDim : PrefilteredDim;
+		const VkFormat format = target == IRRADIANCE ? IrradianceFormat : PrefilteredFormat;
+		const int32_t numMips = MipLevels(dim);
 
-		const int32_t numMips = static_cast<uint32_t>(floor(log2(dim))) + 1;
-
-		std::unique_ptr<Assets::TextureCubeImage> cubeTex = std::make_unique<Assets::TextureCubeImage>(CommandPool(), dim, format, numMips);
+		Assets::TextureCubeImage* cubeTex = target == IRRADIANCE ? irradianceMap_.get() : prefilterMap_.get();
+		CubeMapPipeline* cubemapPipeline = target == IRRADIANCE ? irradiancePipeline_.get() : prefilterPipeline_.get();
 		struct Offscreen {
 			std::unique_ptr<vk::Image> image;
 			std::unique_ptr<vk::ImageView> view;
-			std::unique_ptr<vk::DeviceMemory> memory;
+			std::unique_ptr<vk::AliasedMemory> memory;
 			std::unique_ptr<CubemapFrameBuffer> framebuffer;
 		} offscreen;
 
-		// Create offscreen framebuffer
-		cubemapPipeline_.reset(new CubeMapPipeline(Device(), GetSkybox(), format, target));
-
+		// Create offscreen framebuffer, the targets of both passes share the same memory.
 		offscreen.image.reset(new vk::Image(Device(), VkExtent2D{ dim, dim }, format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, 1, 1));
-		offscreen.memory.reset(new vk::DeviceMemory(offscreen.image->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+		offscreen.memory = Device().MemoryAliasPool().Acquire(*offscreen.image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vk::MemoryCategory::RenderTarget);
 		offscreen.view.reset( new vk::ImageView(Device(), offscreen.image->Handle(), offscreen.image->Format(), VK_IMAGE_ASPECT_COLOR_BIT));
-		offscreen.framebuffer.reset( new CubemapFrameBuffer(*(offscreen.view), cubemapPipeline_->RenderPass(), dim));
+		offscreen.framebuffer.reset( new CubemapFrameBuffer(*(offscreen.view), cubemapPipeline->RenderPass(), dim));
 
-		offscreen.image->TransitionImageLayout(CommandPool(), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1, 1);
+		// Every face of every mip level is rendered and copied in a single submission.
+		vk::SingleTimeCommands commands(CommandPool());
+
+		offscreen.image->TransitionImageLayout(commands.CommandBuffer(), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1, 1);
 	
 		// render cubemap
 		VkClearValue clearValues[1];
@@ -279,7 +318,7 @@ void Renderer::GenerateCubemaps() {
 
 		VkRenderPassBeginInfo renderPassBeginInfo{};
 		renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassBeginInfo.renderPass = cubemapPipeline_->RenderPass().Handle();
+		renderPassBeginInfo.renderPass = cubemapPipeline->RenderPass().Handle();
 		renderPassBeginInfo.framebuffer = offscreen.framebuffer->Handle();
 		renderPassBeginInfo.renderArea.extent.width = dim;
 		renderPassBeginInfo.renderArea.extent.height = dim;
@@ -311,11 +350,11 @@ void Renderer::GenerateCubemaps() {
 		subresourceRange.levelCount = numMips;
 		subresourceRange.layerCount = 6;
 
-		cubeTex->Image().TransitionImageLayout(CommandPool(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, numMips, 6);
+		cubeTex->Image().TransitionImageLayout(commands.CommandBuffer(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, numMips, 6);
 	
 		for (uint32_t m = 0; m < numMips; m++) {
 			for (uint32_t f = 0; f < 6; f++) {
-				vk::SingleTimeCommands::Submit(CommandPool(), [&](VkCommandBuffer commandBuffer) 
+				commands.Record([&](VkCommandBuffer commandBuffer)
 					{
 						viewport.width = static_cast<float>(dim * std::pow(0.5f, m));
 						viewport.height = static_cast<float>(dim * std::pow(0.5f, m));
@@ -327,15 +366,15 @@ void Renderer::GenerateCubemaps() {
 							switch (target)
 							{
 							case IRRADIANCE:
-								cubemapPipeline_->pushBlockIrradiance.mvp = glm::perspective((float)(M_PI / 2.0), 1.0f, 0.1f, 512.0f) * matrices[f];
-								vkCmdPushConstants(commandBuffer, cubemapPipeline_->PipelineLayout().Handle(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0,
-									sizeof(CubeMapPipeline::PushBlockIrradiance), &cubemapPipeline_->pushBlockIrradiance);
+								cubemapPipeline->pushBlockIrradiance.mvp = glm::perspective((float)(M_PI / 2.0), 1.0f, 0.1f, 512.0f) * matrices[f];
+								vkCmdPushConstants(commandBuffer, cubemapPipeline->PipelineLayout().Handle(), cubemapPipeline->PipelineLayout().PushConstantStages(), 0,
+									sizeof(CubeMapPipeline::PushBlockIrradiance), &cubemapPipeline->pushBlockIrradiance);
 								break;
 							case PREFILTEREDENV:
-								cubemapPipeline_->pushBlockPrefilterEnv.mvp = glm::perspective((float)(M_PI / 2.0), 1.0f, 0.1f, 512.0f) * matrices[f];
-								cubemapPipeline_->pushBlockPrefilterEnv.roughness = (float)m / (float)(numMips - 1);
-								vkCmdPushConstants(commandBuffer, cubemapPipeline_->PipelineLayout().Handle(), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0,
-									sizeof(CubeMapPipeline::PushBlockPrefilterEnv), &cubemapPipeline_->pushBlockPrefilterEnv);
+								cubemapPipeline->pushBlockPrefilterEnv.mvp = glm::perspective((float)(M_PI / 2.0), 1.0f, 0.1f, 512.0f) * matrices[f];
+								cubemapPipeline->pushBlockPrefilterEnv.roughness = (float)m / (float)(numMips - 1);
+								vkCmdPushConstants(commandBuffer, cubemapPipeline->PipelineLayout().Handle(), cubemapPipeline->PipelineLayout().PushConstantStages(), 0,
+									sizeof(CubeMapPipeline::PushBlockPrefilterEnv), &cubemapPipeline->pushBlockPrefilterEnv);
 								break;
 							}
 
@@ -343,25 +382,16 @@ void Renderer::GenerateCubemaps() {
 							VkBuffer vertexBuffers[] = { scene.VertexBuffer().Handle() };
 							const VkBuffer indexBuffer = scene.IndexBuffer().Handle();
 							VkDeviceSize offsets[] = { 0 };
-							VkDescriptorSet descriptorSets[] = { cubemapPipeline_->DescriptorSet(0) };
+							VkDescriptorSet descriptorSets[] = { cubemapPipeline->DescriptorSet(0) };
 							
-							vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, cubemapPipeline_->Handle());
-							vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, cubemapPipeline_->PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
+							vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, cubemapPipeline->Handle());
+							vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, cubemapPipeline->PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
 							vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
 							vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
 
-							uint32_t vertexOffset = 0;
-							uint32_t indexOffset = 0;
-
-							for (const auto& model : scene.Models())
+							for (const auto& range : scene.DrawRanges())
 							{
-								const auto vertexCount = static_cast<uint32_t>(model.NumberOfVertices());
-								const auto indexCount = static_cast<uint32_t>(model.NumberOfIndices());
-
-								vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexOffset, vertexOffset, 0);
-
-								vertexOffset += vertexCount;
-								indexOffset += indexCount;
+								vkCmdDrawIndexed(commandBuffer, range.IndexCount, 1, range.FirstIndex, range.VertexOffset, 0);
 							}
 						}
 						vkCmdEndRenderPass(commandBuffer);
@@ -416,23 +446,13 @@ void Renderer::GenerateCubemaps() {
 					});
 			}
 		}
-		cubeTex->Image().TransitionImageLayout(CommandPool(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, numMips, 6);
-
-		switch (target)
-		{
-		case IRRADIANCE:
-			irradianceMap_ = std::move(cubeTex);
-			break;
-		case PREFILTEREDENV:
-			prefilterMap_ = std::move(cubeTex);
-			shaderValuesParams_.prefilteredCubeMipLevels = numMips;
-			break;
-		}
+		cubeTex->Image().TransitionImageLayout(commands.CommandBuffer(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, numMips, 6);
+		commands.SubmitAsync().Wait();
 
 		offscreen.framebuffer.reset();
+		offscreen.view.reset();
 		offscreen.image.reset();
 		offscreen.memory.reset();
-		offscreen.view.reset();
 
 		auto tEnd = std::chrono::high_resolution_clock::now();
 		auto tDiff = std::chrono::duration<double, std::milli>(tEnd - tStart).count();
@@ -447,16 +467,16 @@ void Renderer::GenerateCubemaps() {
 			break;
 		}
 	}
+
+	// Nothing else bakes into it afterwards.
+	Device().MemoryAliasPool().Trim();
 }
 
 void Renderer::GenratateBRDFLUT() {
 	auto tStart = std::chrono::high_resolution_clock::now();
 
-	const VkFormat format = VK_FORMAT_R16G16_SFLOAT;
-	const int32_t dim = 512;
-
-	brdfLut_.reset(new Assets::TextureImage(Device(), dim, format, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT));
-	brdflutPipeline_.reset(new BrdfLutPipeline(Device(), format));
+	// The target image and its pipeline were created by Prepare().
+	const int32_t dim = BrdfLutDim;
 
 	std::array<VkImageView, 1> attachments =
 	{
@@ -473,7 +493,7 @@ void Renderer::GenratateBRDFLUT() {
 	framebufferCI.layers = 1;
 
 	VkFramebuffer framebuffer;
-	vk::Check(vkCreateFramebuffer(Device().Handle(), &framebufferCI, nullptr, &framebuffer), "create brdflut's framebuffer");
+	vk::Check(vkCreateFramebuffer(Device().Handle(), &framebufferCI, Device().HostAllocator().Callbacks(VK_OBJECT_TYPE_FRAMEBUFFER), &framebuffer), "create brdflut's framebuffer");
 
 	// Render
 	VkClearValue clearValues[1];
@@ -510,7 +530,7 @@ void Renderer::GenratateBRDFLUT() {
 
 		});
 
-	vkDestroyFramebuffer(Device().Handle(), framebuffer, nullptr);
+	vkDestroyFramebuffer(Device().Handle(), framebuffer, Device().HostAllocator().Callbacks(VK_OBJECT_TYPE_FRAMEBUFFER));
 	
 	auto tEnd = std::chrono::high_resolution_clock::now();
 	auto tDiff = std::chrono::duration<double, std::milli>(tEnd - tStart).count();
@@ -544,6 +564,13 @@ void Renderer::UpdateUi() {
 	UI().text("my vulkan pbr shader");
 	//UI().text("%.1d fps (%.2f ms)", lastFPS, (1000.0f / lastFPS));
 
+	if (UI().header("Texture streaming")) {
+		UI().text("resident %.1f MB", textureStreamer_->ResidentBytes() / (1024.0f * 1024.0f));
+		if (UI().slider("Budget (MB)", &textureBudgetMb_, 16.0f, 1024.0f)) {
+			textureStreamer_->SetBudget(static_cast<VkDeviceSize>(textureBudgetMb_ * 1024 * 1024));
+		}
+	}
+
 	if (UI().header("Debug view")) {
 		const std::vector<std::string> debugNamesInputs = {
 			"none", "Base color", "Normal", "Occlusion", "Emissive", "Metallic", "Roughness"
@@ -561,6 +588,11 @@ void Renderer::UpdateUi() {
 		}
 	}
 
+	if (UI().header("Memory")) {
+		UI().memoryStatistics(Device().Allocator());
+		UI().hostStatistics(Device().HostAllocator());
+	}
+
 	ImGui::PopItemWidth();
 	ImGui::End();
 	ImGui::Render();
@@ -574,7 +606,12 @@ void Renderer::UpdateUi() {
 
 		bool updateBuffers = (vertexBufferSize != UI().vertexBufferSize || indexBufferSize != UI().indexBufferSize);
 		if (updateBuffers) {
-			vkDeviceWaitIdle(Device().Handle());
+			// Frames in flight may still draw with the old buffers, they are destroyed once those have completed.
+			auto& deletionQueue = Device().DeletionQueue();
+			deletionQueue.Retire(std::move(UI().vertexBuffer));
+			deletionQueue.Retire(std::move(UI().vertexBufferMemory));
+			deletionQueue.Retire(std::move(UI().indexBuffer));
+			deletionQueue.Retire(std::move(UI().indexBufferMemory));
 			UI().vertexBuffer.reset(new vk::Buffer(Device(), vertexBufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT));
 			UI().indexBuffer.reset(new vk::Buffer(Device(), indexBufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT));
 			UI().vertexBufferMemory.reset(new vk::DeviceMemory(UI().vertexBuffer->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)));
@@ -600,7 +637,7 @@ void Renderer::UpdateUi() {
 
 void Renderer::UpdateUBO()
 {
-	shaderValuesUBO_->SetValue(shaderValuesParams_);
+	shaderValuesOffset_ = UniformRing().Push(shaderValuesParams_);
 }
 
 void Renderer::OnKey(int key, int scancode, int action, int mods)
@@ -653,4 +690,31 @@ void Renderer::OnMouseButton(int button, int action, int mods)
 			mouseStatus_.rDown = false; break;
 		}
 	}
-}
\ No newline at end of file
+}
+
+void Renderer::UpdateTextureStreaming()
+{
+	// Estimate how much of each texture the helmet needs from its distance to the camera.
+	const float viewportHeight = static_cast<float>(SwapChain().Extent().height);
+	const float fovY = glm::radians(camera_->getFov());
+
+	for (const auto& range : scene_->DrawRanges())
+	{
+		const glm::vec4 sphere = range.Bounds;
+		const float distance = std::max(glm::length(camera_->getViewPos() - glm::vec3(sphere)) - sphere.w, camera_->getNear());
+		const float worldUnitsPerUv = range.WorldUnitsPerUv;
+
+		for (const auto& texture : scene_->StreamingTextures())
+		{
+			const uint32_t size = std::max(texture->Width(), texture->Height());
+			textureStreamer_->Request(*texture, Assets::TextureStreamer::DesiredLevel(distance, worldUnitsPerUv, size, viewportHeight, fovY));
+		}
+	}
+
+	// Recreated images have new views, point the descriptors at them.
+	if (textureStreamer_->Update(CommandPool()))
+	{
+		scene_->UpdateTextureImageViews();
+		pbrPipeline_->UpdateSceneTextures(GetScene());
+	}
+}
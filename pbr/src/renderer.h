@@ -5,6 +5,8 @@
 #include "Assets/UserInterface.h"
 #include "Assets/UniformBuffer.h"
 #include "Assets/GltfModel.h"
+#include "Assets/TextureStreamer.h"
+#include "Vulkan/UniformRing.h"
 #include "skyboxPipeline.h"
 #include "pbrPipeline.h"
 #include "cubemapPipeline.h"
@@ -30,7 +32,7 @@ protected:
 	const Assets::TextureCubeImage& GetIrradianceMap() const { return *irradianceMap_; }
 	const Assets::TextureCubeImage& GetPrefilteredMap() const { return *prefilterMap_; }
 	const Assets::TextureImage& GetBrdfLutMap() const { return *brdfLut_; }
-	const Assets::UniformBuffer& GetShaderValuesUBO() const { return *shaderValuesUBO_; }
+	VkDescriptorBufferInfo GetShaderValuesInfo() { return UniformRing().Descriptor(sizeof(Assets::pbrValule)); }
 	Assets::UniformBufferObject GetUniformBufferObject(VkExtent2D extent) const override;
 	Assets::UserInterface& UI() const { return *ui_; }
 
@@ -47,6 +49,7 @@ protected:
 	void GenratateBRDFLUT();
 	void UpdateUi();
 	void UpdateUBO();
+	void UpdateTextureStreaming();
 
 	const bool& GetMouseLeftDown() const { return mouseStatus_.lDown; }
 	const bool& GetMouseRightDown() const { return mouseStatus_.rDown; }
@@ -60,17 +63,18 @@ protected:
 private:
 	void LoadScene();
 
-	std::unique_ptr<const Assets::Scene> scene_;
+	std::unique_ptr<Assets::TextureStreamer> textureStreamer_;
+	std::unique_ptr<Assets::Scene> scene_;
 	std::unique_ptr<const Assets::Scene> skybox_;
-	std::unique_ptr<const SkyBoxPipeline> skyboxPipeline_;
-	std::unique_ptr<const PbrPipeline> pbrPipeline_;
-	std::unique_ptr<CubeMapPipeline> cubemapPipeline_;
+	std::unique_ptr<SkyBoxPipeline> skyboxPipeline_;
+	std::unique_ptr<PbrPipeline> pbrPipeline_;
+	std::unique_ptr<CubeMapPipeline> irradiancePipeline_;
+	std::unique_ptr<CubeMapPipeline> prefilterPipeline_;
 	std::unique_ptr<BrdfLutPipeline> brdflutPipeline_;
 	std::unique_ptr<Assets::Camera> camera_;
 	std::unique_ptr<Assets::TextureCubeImage> irradianceMap_;
 	std::unique_ptr<Assets::TextureCubeImage> prefilterMap_;
 	std::unique_ptr<Assets::TextureImage> brdfLut_;
-	std::unique_ptr<Assets::UniformBuffer> shaderValuesUBO_;
 	std::unique_ptr<class Assets::UserInterface> ui_;
 
 	struct {
@@ -81,6 +85,8 @@ private:
 
 	int32_t debugViewInputs = 0;
 	int32_t debugViewEquation = 0;
+	float textureBudgetMb_ = 256.0f;
 
 	Assets::pbrValule shaderValuesParams_;
+	uint32_t shaderValuesOffset_{}; // Of this frame's shaderValuesParams_ in the uniform ring.
 };
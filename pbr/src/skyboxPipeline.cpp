@@ -1,179 +1,74 @@
 #include "skyboxPipeline.h"
+#include "Vulkan/PipelineBuilder.h"
+#include "Vulkan/ShaderReflection.h"
 #include <iostream>
 
+namespace
+{
+	const char* const VertexShader = "../shaders/skybox.vert";
+	const char* const FragmentShader = "../shaders/skybox.frag";
+}
+
 SkyBoxPipeline::SkyBoxPipeline(
 	const vk::Device& device,
-	const std::vector<Assets::UniformBuffer>& uniformBuffers,
+	const VkDescriptorBufferInfo& uniformBufferInfo,
 	const Assets::Scene& scene,
 	const vk::RenderPass& renderPass,
 	const Assets::TextureCubeImage& cubeMap):
 	device_(device)
 {
-	const auto bindingDescription = Assets::Vertex::GetBindingDescription();
-	const auto attributeDescriptions = std::vector<VkVertexInputAttributeDescription>{ {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0} };
-
-	VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
-	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexInputInfo.vertexBindingDescriptionCount = 1;
-	vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-	vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+	// Derive the descriptor bindings from the shaders.
+	vk::ShaderReflection reflection;
+	reflection.AddStage(VK_SHADER_STAGE_VERTEX_BIT, vk::ShaderModule::ReadFile(VertexShader));
+	reflection.AddStage(VK_SHADER_STAGE_FRAGMENT_BIT, vk::ShaderModule::ReadFile(FragmentShader));
 
-	VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
-	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-	inputAssembly.primitiveRestartEnable = VK_FALSE;
+	reflection.SetDynamic(0);
 
-	//VkViewport viewport = {};
-	//viewport.x = 0.0f;
-	//viewport.y = 0.0f;
-	//viewport.width = static_cast<float>(swapChain.Extent().width);
-	//viewport.height = static_cast<float>(swapChain.Extent().height);
-	//viewport.minDepth = 0.0f;
-	//viewport.maxDepth = 1.0f;
-
-	//VkRect2D scissor = {};
-	//scissor.offset = { 0, 0 };
-	//scissor.extent = swapChain.Extent();
-
-	VkPipelineViewportStateCreateInfo viewportState = {};
-	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-	viewportState.viewportCount = 1;
-	viewportState.scissorCount = 1;
-
-	std::vector<VkDynamicState> dynamicStates = {
-			VK_DYNAMIC_STATE_VIEWPORT,
-			VK_DYNAMIC_STATE_SCISSOR
-	};
+	// Create the descriptor set, the uniform buffer offset is given at bind time.
+	descriptorSetManager_.reset(new vk::DescriptorSetManager(device, reflection, 1));
 
-	VkPipelineDynamicStateCreateInfo dynamicState{};
-	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-	dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-	dynamicState.pDynamicStates = dynamicStates.data();
-
-	VkPipelineRasterizationStateCreateInfo rasterizer = {};
-	rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-	rasterizer.depthClampEnable = VK_FALSE;
-	rasterizer.rasterizerDiscardEnable = VK_FALSE;
-	rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-	rasterizer.lineWidth = 1.0f;
-	rasterizer.cullMode = VK_CULL_MODE_NONE;
-	rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-	rasterizer.depthBiasEnable = VK_FALSE;
-
-	VkPipelineMultisampleStateCreateInfo multisampling = {};
-	multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-	multisampling.sampleShadingEnable = VK_FALSE;
-	multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
-	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-	depthStencil.depthTestEnable = VK_TRUE;
-	depthStencil.depthWriteEnable = VK_FALSE;
-	depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
-	depthStencil.depthBoundsTestEnable = VK_FALSE;
-	depthStencil.stencilTestEnable = VK_FALSE;
-
-	VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
-	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-	colorBlendAttachment.blendEnable = VK_FALSE;
+	auto& descriptorSets = descriptorSetManager_->DescriptorSets();
 
-	VkPipelineColorBlendStateCreateInfo colorBlending = {};
-	colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-	colorBlending.logicOpEnable = VK_FALSE;
-	colorBlending.attachmentCount = 1;
-	colorBlending.pAttachments = &colorBlendAttachment;
+	VkDescriptorImageInfo cubeMapInfo{ cubeMap.Sampler().Handle(), cubeMap.ImageView().Handle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
 
-	// Create descriptor pool/sets.
-	std::vector<vk::DescriptorBinding> descriptorBindings =
+	const std::vector<VkWriteDescriptorSet> descriptorWrites =
 	{
-		{0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT},
-		//{1, static_cast<uint32_t>(scene.TextureSamplers().size()), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT}
-		{1, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT}	// cubeMap
+		descriptorSets.Bind(0, 0, uniformBufferInfo),
+		descriptorSets.Bind(0, 1, cubeMapInfo)
 	};
 
-	descriptorSetManager_.reset(new vk::DescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
-
-	auto& descriptorSets = descriptorSetManager_->DescriptorSets();
-
-	for (uint32_t i = 0; i != uniformBuffers.size(); ++i)
-	{
-		// Uniform buffer
-		VkDescriptorBufferInfo uniformBufferInfo = {};
-		uniformBufferInfo.buffer = uniformBuffers[i].Buffer().Handle();
-		uniformBufferInfo.range = VK_WHOLE_SIZE;
-
-		//// Image and texture samplers
-		//std::vector<VkDescriptorImageInfo> imageInfos(scene.TextureSamplers().size());
-
-		//for (size_t t = 0; t != imageInfos.size(); ++t)
-		//{
-		//	auto& imageInfo = imageInfos[t];
-		//	imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		//	imageInfo.imageView = scene.TextureImageViews()[t];
-		//	imageInfo.sampler = scene.TextureSamplers()[t];
-		//}
-
-		VkDescriptorImageInfo cubeMapInfo{ cubeMap.Sampler().Handle(), cubeMap.ImageView().Handle(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-
-		const std::vector<VkWriteDescriptorSet> descriptorWrites =
-		{
-			descriptorSets.Bind(i, 0, uniformBufferInfo),
-			descriptorSets.Bind(i, 1, cubeMapInfo)
-		};
-
-		descriptorSets.UpdateDescriptors(i, descriptorWrites);
-	}
+	descriptorSets.UpdateDescriptors(0, descriptorWrites);
 
 	// Create pipeline layout and render pass.
-	pipelineLayout_.reset(new class vk::PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout()));
-
-	// Load shaders.
-	auto vert_code = vk::ShaderModule::ReadFile("../shaders/skybox.vert", shaderc_glsl_vertex_shader);
-	auto frag_code = vk::ShaderModule::ReadFile("../shaders/skybox.frag", shaderc_glsl_fragment_shader);
+	pipelineLayout_.reset(new class vk::PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout(), reflection));
 
-	const vk::ShaderModule vertShader(device, vert_code);
-	const vk::ShaderModule fragShader(device, frag_code);
-
-	VkPipelineShaderStageCreateInfo shaderStages[] =
-	{
-		vertShader.CreateShaderStage(VK_SHADER_STAGE_VERTEX_BIT),
-		fragShader.CreateShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT)
-	};
-
-	// Create graphic pipeline
-	VkGraphicsPipelineCreateInfo pipelineInfo = {};
-	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	pipelineInfo.stageCount = 2;
-	pipelineInfo.pStages = shaderStages;
-	pipelineInfo.pVertexInputState = &vertexInputInfo;
-	pipelineInfo.pInputAssemblyState = &inputAssembly;
-	pipelineInfo.pViewportState = &viewportState;
-	pipelineInfo.pRasterizationState = &rasterizer;
-	pipelineInfo.pMultisampleState = &multisampling;
-	pipelineInfo.pDepthStencilState = &depthStencil;
-	pipelineInfo.pColorBlendState = &colorBlending;
-	pipelineInfo.pDynamicState = &dynamicState;
-	pipelineInfo.layout = pipelineLayout_->Handle();
-	pipelineInfo.renderPass = renderPass.Handle();
-	pipelineInfo.subpass = 0;
+	pipeline_ = CreatePipeline(renderPass);
+}
 
-	vk::Check(vkCreateGraphicsPipelines(device.Handle(), nullptr, 1, &pipelineInfo, nullptr, &pipeline_),
-		"create graphics pipeline");
+std::shared_ptr<vk::Pipeline> SkyBoxPipeline::CreatePipeline(const vk::RenderPass& renderPass) const
+{
+	// Create graphic pipeline, identical requests share one pipeline.
+	vk::PipelineState state;
+	state.VertexBindings = { Assets::Vertex::GetBindingDescription() };
+	state.VertexAttributes = { {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0} };
+	state.DepthWriteEnable = false;
+	state.DepthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+
+	vk::PipelineBuilder builder(device_, state);
+	builder.AddStage(VK_SHADER_STAGE_VERTEX_BIT, vk::ShaderModule::ReadFile(VertexShader));
+	builder.AddStage(VK_SHADER_STAGE_FRAGMENT_BIT, vk::ShaderModule::ReadFile(FragmentShader));
+
+	return builder.Build(*pipelineLayout_, renderPass, "skybox");
 }
 
 SkyBoxPipeline::~SkyBoxPipeline()
 {
-	if (pipeline_ != nullptr) {
-		vkDestroyPipeline(Device().Handle(), pipeline_, nullptr);
-		pipeline_ = nullptr;
-	}
-
+	pipeline_.reset();
 	pipelineLayout_.reset();
 	descriptorSetManager_.reset();
 }
 
-VkDescriptorSet SkyBoxPipeline::DescriptorSet(uint32_t index) const
+VkDescriptorSet SkyBoxPipeline::DescriptorSet() const
 {
-	return descriptorSetManager_->DescriptorSets().Handle(index);
+	return descriptorSetManager_->DescriptorSets().Handle(0);
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "Vulkan/DescriptorPool.h"
 #include "Vulkan/DescriptorSets.h"
 #include "Vulkan/Device.h"
+#include "Vulkan/Pipeline.h"
 #include "Vulkan/PipelineLayout.h"
 #include "Vulkan/RenderPass.h"
 #include "Vulkan/ShaderModule.h"
@@ -14,7 +15,6 @@
 #include "Vulkan/ImageView.h"
 #include "Assets/Scene.h"
 #include "Assets/Vertex.h"
-#include "Assets/UniformBuffer.h"
 #include "Assets/TextureImage.h"
 #include <memory>
 #include <vector>
@@ -27,20 +27,26 @@ public:
 	
 	SkyBoxPipeline(
 		const vk::Device& device,
-		const std::vector<Assets::UniformBuffer>& uniformBuffers,
+		const VkDescriptorBufferInfo& uniformBufferInfo,
 		const Assets::Scene& scene,
 		const vk::RenderPass& renderPass,
 		const Assets::TextureCubeImage& cubeMap);
 	~SkyBoxPipeline();
 
-	VkDescriptorSet DescriptorSet(uint32_t index) const;
+	VkPipeline Handle() const { return pipeline_->Handle(); }
+	VkDescriptorSet DescriptorSet() const;
 	const vk::PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
 	const vk::Device& Device() const { return device_; }
 
+	// Compiles the shaders and creates the pipeline, safe to call from any thread.
+	std::shared_ptr<vk::Pipeline> CreatePipeline(const vk::RenderPass& renderPass) const;
+	// Installs a pipeline from CreatePipeline(), returns the one it replaces.
+	std::shared_ptr<vk::Pipeline> ReplacePipeline(std::shared_ptr<vk::Pipeline> pipeline) { pipeline_.swap(pipeline); return pipeline; }
+
 private:
 	const vk::Device& device_;
 
-	VULKAN_HANDLE(VkPipeline, pipeline_)
+	std::shared_ptr<vk::Pipeline> pipeline_;
 
 	std::unique_ptr<vk::DescriptorSetManager> descriptorSetManager_;
 	std::unique_ptr<vk::PipelineLayout> pipelineLayout_;
@@ -0,0 +1,67 @@
+-- Compiles GLSL stages to SPIR-V at build time and embeds them as constexpr uint32_t arrays.
+-- Targets using it can include "EmbeddedShaders.h", which lists every stage as a vk::EmbeddedShader
+-- keyed by file name, and hand it to vk::ShaderModule::RegisterEmbedded().
+rule("embed_spirv")
+    set_extensions(".vert", ".frag", ".comp", ".geom", ".tesc", ".tese")
+
+    on_load(function (target)
+        local headerdir = path.join(target:autogendir(), "rules", "embed_spirv")
+        if not os.isdir(headerdir) then
+            os.mkdir(headerdir)
+        end
+        target:add("includedirs", headerdir)
+    end)
+
+    before_build(function (target)
+        local headerdir = path.join(target:autogendir(), "rules", "embed_spirv")
+        local sourcebatch = target:sourcebatches()["embed_spirv"]
+        local sourcefiles = sourcebatch and sourcebatch.sourcefiles or {}
+
+        local lines = {
+            "// Generated by the embed_spirv rule, do not edit.",
+            "#pragma once",
+            "",
+            "#include \"Vulkan/ShaderModule.h\""}
+        local entries = {}
+
+        for _, sourcefile in ipairs(sourcefiles) do
+            local filename = path.filename(sourcefile)
+            local name = filename:gsub("%.", "_") .. "_spv"
+            table.insert(lines, format("#include \"%s.h\"", filename))
+            table.insert(entries, format("\t{ \"%s\", %s, sizeof(%s) / sizeof(uint32_t) },", filename, name, name))
+        end
+
+        table.insert(lines, "")
+        table.insert(lines, "inline constexpr vk::EmbeddedShader EmbeddedShaders[] =")
+        table.insert(lines, "{")
+        table.join2(lines, entries)
+        table.insert(lines, "};")
+
+        -- Only touch the header when the shader list changes, so sources including it are not rebuilt.
+        local headerfile = path.join(headerdir, "EmbeddedShaders.h")
+        local content = table.concat(lines, "\n") .. "\n"
+        if not os.isfile(headerfile) or io.readfile(headerfile) ~= content then
+            io.writefile(headerfile, content)
+        end
+    end)
+
+    before_buildcmd_file(function (target, batchcmds, sourcefile, opt)
+        import("lib.detect.find_tool")
+
+        local glslc = find_tool("glslc", {paths = {"$(env VULKAN_SDK)/bin", "$(env VULKAN_SDK)/Bin"}})
+        assert(glslc, "glslc not found, install the Vulkan SDK or configure with --runtime_shaders=y")
+
+        local headerdir = path.join(target:autogendir(), "rules", "embed_spirv")
+        local filename = path.filename(sourcefile)
+        local spvfile = path.join(headerdir, filename .. ".spv")
+        local headerfile = path.join(headerdir, filename .. ".h")
+
+        batchcmds:show_progress(opt.progress, "${color.build.object}compiling.spirv %s", sourcefile)
+        batchcmds:vrunv(glslc.program, {"-o", spvfile, sourcefile})
+        batchcmds:vrunv(os.programfile(), {"lua", path.join(os.scriptdir(), "spirv2h.lua"), spvfile, headerfile, filename:gsub("%.", "_") .. "_spv"})
+
+        batchcmds:add_depfiles(sourcefile)
+        batchcmds:set_depmtime(os.mtime(headerfile))
+        batchcmds:set_depcache(target:dependfile(headerfile))
+    end)
+rule_end()
@@ -0,0 +1,28 @@
+-- Writes a SPIR-V module as a header holding a constexpr uint32_t array.
+-- usage: xmake lua spirv2h.lua <input.spv> <output.h> <array name>
+function main(input, output, name)
+    local data = io.readfile(input, {encoding = "binary"})
+    assert(#data > 0 and #data % 4 == 0, input .. " is not a SPIR-V module")
+
+    local words = {}
+    for i = 1, #data, 4 do
+        local b0, b1, b2, b3 = data:byte(i, i + 3)
+        table.insert(words, format("0x%02x%02x%02x%02x", b3, b2, b1, b0))
+    end
+
+    local lines = {
+        "// Generated from " .. path.filename(input) .. " by the embed_spirv rule, do not edit.",
+        "#pragma once",
+        "",
+        "#include <cstdint>",
+        "",
+        "constexpr uint32_t " .. name .. "[] =",
+        "{"}
+
+    for i = 1, #words, 8 do
+        table.insert(lines, "\t" .. table.concat(words, ", ", i, math.min(i + 7, #words)) .. ",")
+    end
+
+    table.insert(lines, "};")
+    io.writefile(output, table.concat(lines, "\n") .. "\n")
+end
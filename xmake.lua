@@ -7,8 +7,24 @@ add_rules("mode.release", "mode.debug")
 
 add_includedirs("3rdParty/include")
 
-add_requires("shaderc", "vulkansdk", "glfw", "tinygltf", "glm", "imgui")
-add_packages("shaderc", "vulkansdk", "glfw", "tinygltf", "glm", "imgui", {public = true})
+-- Shaders are compiled to SPIR-V at build time and embedded; this development mode compiles them
+-- from ../shaders at run time with shaderc instead.
+option("runtime_shaders")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Compile GLSL shaders at run time with shaderc")
+option_end()
+
+add_requires("vulkansdk", "glfw", "tinygltf", "glm", "imgui")
+add_packages("vulkansdk", "glfw", "tinygltf", "glm", "imgui", {public = true})
+
+if has_config("runtime_shaders") then
+    add_defines("VULKAN_RUNTIME_SHADERS")
+    add_requires("shaderc")
+    add_packages("shaderc", {public = true})
+end
+
+includes("rules/embed_spirv.lua")
 
 includes("base");
 add_subdirs("pbr");